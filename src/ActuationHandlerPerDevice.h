@@ -16,11 +16,14 @@
 #ifndef ACTUATIONHANDLERPERDEVICE_H
 #define ACTUATIONHANDLERPERDEVICE_H
 
+#include "AsyncActuationHandlerPerDevice.h"
+
+#include <functional>
 #include <string>
 
 namespace wolkabout
 {
-class ActuationHandlerPerDevice
+class ActuationHandlerPerDevice : public AsyncActuationHandlerPerDevice
 {
 public:
     /**
@@ -34,6 +37,16 @@ public:
     virtual void handleActuation(const std::string& deviceKey, const std::string& reference,
                                  const std::string& value) = 0;
 
+    /**
+     * @brief Invokes handleActuation and completes immediately
+     */
+    void handleActuation(const std::string& deviceKey, const std::string& reference, const std::string& value,
+                         std::function<void()> onComplete) override
+    {
+        handleActuation(deviceKey, reference, value);
+        onComplete();
+    }
+
     virtual ~ActuationHandlerPerDevice() = default;
 };
 }    // namespace wolkabout
@@ -16,13 +16,17 @@
 #ifndef ACTUATORSTATUSPROVIDERPERDEVICE_H
 #define ACTUATORSTATUSPROVIDERPERDEVICE_H
 
+#include "AsyncActuatorStatusProviderPerDevice.h"
 #include "core/model/ActuatorStatus.h"
 
+#include <functional>
+#include <map>
 #include <string>
+#include <vector>
 
 namespace wolkabout
 {
-class ActuatorStatusProviderPerDevice
+class ActuatorStatusProviderPerDevice : public AsyncActuatorStatusProviderPerDevice
 {
 public:
     /**
@@ -35,6 +39,66 @@ public:
      */
     virtual ActuatorStatus getActuatorStatus(const std::string& deviceKey, const std::string& reference) = 0;
 
+    /**
+     * @brief Bulk actuator status provider callback<br>
+     *        Override if statuses of several actuators can be read at once cheaper than one by one<br>
+     *        Default implementation invokes getActuatorStatus for each reference<br>
+     *        Must be implemented as thread safe
+     * @param deviceKey Device key
+     * @param references Actuator references
+     * @return ActuatorStatus of each requested actuator, by actuator reference
+     */
+    virtual std::map<std::string, ActuatorStatus> getActuatorStatuses(const std::string& deviceKey,
+                                                                      const std::vector<std::string>& references)
+    {
+        std::map<std::string, ActuatorStatus> statuses;
+        for (const auto& reference : references)
+        {
+            statuses.emplace(reference, getActuatorStatus(deviceKey, reference));
+        }
+
+        return statuses;
+    }
+
+    /**
+     * @brief Bulk actuator status provider callback for multiple devices<br>
+     *        Override if statuses of several devices can be read at once cheaper than device by device<br>
+     *        Default implementation invokes getActuatorStatuses for each device<br>
+     *        Must be implemented as thread safe
+     * @param references Actuator references, by device key
+     * @return ActuatorStatus of each requested actuator, by device key and actuator reference
+     */
+    virtual std::map<std::string, std::map<std::string, ActuatorStatus>> getActuatorStatuses(
+      const std::map<std::string, std::vector<std::string>>& references)
+    {
+        std::map<std::string, std::map<std::string, ActuatorStatus>> statuses;
+        for (const auto& kvp : references)
+        {
+            statuses.emplace(kvp.first, getActuatorStatuses(kvp.first, kvp.second));
+        }
+
+        return statuses;
+    }
+
+    /**
+     * @brief Invokes getActuatorStatus and completes immediately
+     */
+    void getActuatorStatus(const std::string& deviceKey, const std::string& reference,
+                           std::function<void(const ActuatorStatus&)> onStatus) override
+    {
+        onStatus(getActuatorStatus(deviceKey, reference));
+    }
+
+    /**
+     * @brief Invokes getActuatorStatuses and completes immediately
+     */
+    void getActuatorStatuses(
+      const std::map<std::string, std::vector<std::string>>& references,
+      std::function<void(const std::map<std::string, std::map<std::string, ActuatorStatus>>&)> onStatuses) override
+    {
+        onStatuses(getActuatorStatuses(references));
+    }
+
     virtual ~ActuatorStatusProviderPerDevice() = default;
 };
 }    // namespace wolkabout
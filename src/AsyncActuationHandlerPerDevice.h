@@ -0,0 +1,44 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ASYNCACTUATIONHANDLERPERDEVICE_H
+#define ASYNCACTUATIONHANDLERPERDEVICE_H
+
+#include <functional>
+#include <string>
+
+namespace wolkabout
+{
+class AsyncActuationHandlerPerDevice
+{
+public:
+    /**
+     * @brief Asynchronous actuation handler callback<br>
+     *        Implement if actuation completes later, so Wolk can handle other commands in the meantime,
+     *        otherwise implement wolkabout::ActuationHandlerPerDevice<br>
+     *        Must be implemented as thread safe
+     * @param deviceKey Device key
+     * @param reference Actuator reference
+     * @param value Desired actuator value
+     * @param onComplete Must be invoked once, from any thread, when actuation is done
+     */
+    virtual void handleActuation(const std::string& deviceKey, const std::string& reference, const std::string& value,
+                                 std::function<void()> onComplete) = 0;
+
+    virtual ~AsyncActuationHandlerPerDevice() = default;
+};
+}    // namespace wolkabout
+
+#endif    // ASYNCACTUATIONHANDLERPERDEVICE_H
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ASYNCACTUATORSTATUSPROVIDERPERDEVICE_H
+#define ASYNCACTUATORSTATUSPROVIDERPERDEVICE_H
+
+#include "core/model/ActuatorStatus.h"
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wolkabout
+{
+class AsyncActuatorStatusProviderPerDevice
+{
+public:
+    /**
+     * @brief Asynchronous actuator status provider callback<br>
+     *        Implement if status is read from slow device I/O, so Wolk can handle other commands in the meantime,
+     *        otherwise implement wolkabout::ActuatorStatusProviderPerDevice<br>
+     *        Must be implemented as thread safe
+     * @param deviceKey Device key
+     * @param reference Actuator reference
+     * @param onStatus Must be invoked once, from any thread, with ActuatorStatus of requested actuator
+     */
+    virtual void getActuatorStatus(const std::string& deviceKey, const std::string& reference,
+                                   std::function<void(const ActuatorStatus&)> onStatus) = 0;
+
+    /**
+     * @brief Asynchronous bulk actuator status provider callback for multiple devices<br>
+     *        Override if statuses of several devices can be read at once cheaper than one by one<br>
+     *        Default implementation requests each status with getActuatorStatus and completes
+     *        once all of them are provided<br>
+     *        Must be implemented as thread safe
+     * @param references Actuator references, by device key
+     * @param onStatuses Must be invoked once, from any thread, with ActuatorStatus of each requested actuator,
+     *        by device key and actuator reference
+     */
+    virtual void getActuatorStatuses(
+      const std::map<std::string, std::vector<std::string>>& references,
+      std::function<void(const std::map<std::string, std::map<std::string, ActuatorStatus>>&)> onStatuses)
+    {
+        struct PendingStatuses
+        {
+            std::mutex lock;
+            std::size_t remaining;
+            std::map<std::string, std::map<std::string, ActuatorStatus>> statuses;
+        };
+
+        auto pending = std::make_shared<PendingStatuses>();
+        pending->remaining = 0;
+        for (const auto& kvp : references)
+        {
+            pending->remaining += kvp.second.size();
+        }
+
+        if (pending->remaining == 0)
+        {
+            onStatuses({});
+            return;
+        }
+
+        for (const auto& kvp : references)
+        {
+            const auto& deviceKey = kvp.first;
+            for (const auto& reference : kvp.second)
+            {
+                getActuatorStatus(deviceKey, reference, [=](const ActuatorStatus& status) {
+                    std::unique_lock<std::mutex> lock{pending->lock};
+                    pending->statuses[deviceKey].emplace(reference, status);
+
+                    if (--pending->remaining != 0)
+                    {
+                        return;
+                    }
+
+                    const auto statuses = std::move(pending->statuses);
+                    lock.unlock();
+
+                    onStatuses(statuses);
+                });
+            }
+        }
+    }
+
+    virtual ~AsyncActuatorStatusProviderPerDevice() = default;
+};
+}    // namespace wolkabout
+
+#endif    // ASYNCACTUATORSTATUSPROVIDERPERDEVICE_H
@@ -0,0 +1,46 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ASYNCCONFIGURATIONHANDLERPERDEVICE_H
+#define ASYNCCONFIGURATIONHANDLERPERDEVICE_H
+
+#include "core/model/ConfigurationItem.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace wolkabout
+{
+class AsyncConfigurationHandlerPerDevice
+{
+public:
+    /**
+     * @brief Asynchronous configuration handler callback<br>
+     *        Implement if configuration is applied later, so Wolk can handle other commands in the meantime,
+     *        otherwise implement wolkabout::ConfigurationHandlerPerDevice<br>
+     *        Must be implemented as thread safe
+     * @param deviceKey Device key
+     * @param configuration as vector of wolkabout::ConfigurationItem
+     * @param onComplete Must be invoked once, from any thread, when configuration is applied
+     */
+    virtual void handleConfiguration(const std::string& deviceKey, const std::vector<ConfigurationItem>& configuration,
+                                     std::function<void()> onComplete) = 0;
+
+    virtual ~AsyncConfigurationHandlerPerDevice() = default;
+};
+}    // namespace wolkabout
+
+#endif    // ASYNCCONFIGURATIONHANDLERPERDEVICE_H
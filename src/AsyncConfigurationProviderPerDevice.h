@@ -0,0 +1,45 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ASYNCCONFIGURATIONPROVIDERPERDEVICE_H
+#define ASYNCCONFIGURATIONPROVIDERPERDEVICE_H
+
+#include "core/model/ConfigurationItem.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace wolkabout
+{
+class AsyncConfigurationProviderPerDevice
+{
+public:
+    /**
+     * @brief Asynchronous device configuration provider callback<br>
+     *        Implement if configuration is read from slow device I/O, so Wolk can handle other commands
+     *        in the meantime, otherwise implement wolkabout::ConfigurationProviderPerDevice<br>
+     *        Must be implemented as thread safe
+     * @param deviceKey Device key
+     * @param onConfiguration Must be invoked once, from any thread, with device configuration
+     */
+    virtual void getConfiguration(const std::string& deviceKey,
+                                  std::function<void(const std::vector<ConfigurationItem>&)> onConfiguration) = 0;
+
+    virtual ~AsyncConfigurationProviderPerDevice() = default;
+};
+}    // namespace wolkabout
+
+#endif    // ASYNCCONFIGURATIONPROVIDERPERDEVICE_H
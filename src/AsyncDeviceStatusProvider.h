@@ -0,0 +1,43 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef ASYNCDEVICESTATUSPROVIDER_H
+#define ASYNCDEVICESTATUSPROVIDER_H
+
+#include "core/model/DeviceStatus.h"
+
+#include <functional>
+#include <string>
+
+namespace wolkabout
+{
+class AsyncDeviceStatusProvider
+{
+public:
+    /**
+     * @brief Asynchronous device status provider callback<br>
+     *        Implement if status is read from slow device I/O, so Wolk can handle other commands in the meantime,
+     *        otherwise implement wolkabout::DeviceStatusProvider<br>
+     *        Must be implemented as thread safe
+     * @param deviceKey Device key
+     * @param onStatus Must be invoked once, from any thread, with DeviceStatus of specified device
+     */
+    virtual void getDeviceStatus(const std::string& deviceKey, std::function<void(DeviceStatus::Status)> onStatus) = 0;
+
+    virtual ~AsyncDeviceStatusProvider() = default;
+};
+}    // namespace wolkabout
+
+#endif    // ASYNCDEVICESTATUSPROVIDER_H
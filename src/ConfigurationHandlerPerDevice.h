@@ -16,14 +16,16 @@
 #ifndef CONFIGURATIONHANDLERPERDEVICE_H
 #define CONFIGURATIONHANDLERPERDEVICE_H
 
+#include "AsyncConfigurationHandlerPerDevice.h"
 #include "core/model/ConfigurationItem.h"
 
+#include <functional>
 #include <string>
 #include <vector>
 
 namespace wolkabout
 {
-class ConfigurationHandlerPerDevice
+class ConfigurationHandlerPerDevice : public AsyncConfigurationHandlerPerDevice
 {
 public:
     /**
@@ -38,6 +40,16 @@ public:
     virtual void handleConfiguration(const std::string& deviceKey,
                                      const std::vector<ConfigurationItem>& configuration) = 0;
 
+    /**
+     * @brief Invokes handleConfiguration and completes immediately
+     */
+    void handleConfiguration(const std::string& deviceKey, const std::vector<ConfigurationItem>& configuration,
+                             std::function<void()> onComplete) override
+    {
+        handleConfiguration(deviceKey, configuration);
+        onComplete();
+    }
+
     virtual ~ConfigurationHandlerPerDevice() = default;
 };
 }    // namespace wolkabout
@@ -16,14 +16,16 @@
 #ifndef CONFIGURATIONPROVIDERPERDEVICE_H
 #define CONFIGURATIONPROVIDERPERDEVICE_H
 
+#include "AsyncConfigurationProviderPerDevice.h"
 #include "core/model/ConfigurationItem.h"
 
+#include <functional>
 #include <string>
 #include <vector>
 
 namespace wolkabout
 {
-class ConfigurationProviderPerDevice
+class ConfigurationProviderPerDevice : public AsyncConfigurationProviderPerDevice
 {
 public:
     /**
@@ -38,6 +40,15 @@ public:
      */
     virtual std::vector<ConfigurationItem> getConfiguration(const std::string& deviceKey) = 0;
 
+    /**
+     * @brief Invokes getConfiguration and completes immediately
+     */
+    void getConfiguration(const std::string& deviceKey,
+                          std::function<void(const std::vector<ConfigurationItem>&)> onConfiguration) override
+    {
+        onConfiguration(getConfiguration(deviceKey));
+    }
+
     virtual ~ConfigurationProviderPerDevice() = default;
 };
 }    // namespace wolkabout
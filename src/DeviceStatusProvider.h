@@ -16,13 +16,15 @@
 #ifndef DEVICESTATUSPROVIDER_H
 #define DEVICESTATUSPROVIDER_H
 
+#include "AsyncDeviceStatusProvider.h"
 #include "core/model/DeviceStatus.h"
 
+#include <functional>
 #include <string>
 
 namespace wolkabout
 {
-class DeviceStatusProvider
+class DeviceStatusProvider : public AsyncDeviceStatusProvider
 {
 public:
     /**
@@ -34,6 +36,14 @@ public:
      */
     virtual DeviceStatus::Status getDeviceStatus(const std::string& deviceKey) = 0;
 
+    /**
+     * @brief Invokes getDeviceStatus and completes immediately
+     */
+    void getDeviceStatus(const std::string& deviceKey, std::function<void(DeviceStatus::Status)> onStatus) override
+    {
+        onStatus(getDeviceStatus(deviceKey));
+    }
+
     virtual ~DeviceStatusProvider() = default;
 };
 }    // namespace wolkabout
@@ -16,7 +16,10 @@
 #ifndef FIRMWAREINSTALLER_H
 #define FIRMWAREINSTALLER_H
 
+#include "utilities/FirmwareImage.h"
+
 #include <functional>
+#include <memory>
 #include <string>
 
 namespace wolkabout
@@ -40,6 +43,50 @@ public:
                          std::function<void(const std::string& deviceKey)> onSuccess,
                          std::function<void(const std::string& deviceKey)> onFail) = 0;
 
+    /**
+     * @brief Install the firmware from provided image
+     *
+     * Image digest is already computed, content can be streamed with wolkabout::FirmwareImage::ChunkReader
+     * without loading whole image into memory. Default implementation installs from image file path.
+     *
+     * This call needs to return as quickly as possible
+     *
+     * @param deviceKey Key of the device
+     * @param image Firmware image to install, same image is shared by all devices of install command
+     * @param onSuccess Function to call if install is successful
+     * @param onFail Function to call if install has failed
+     */
+    virtual void install(const std::string& deviceKey, std::shared_ptr<const FirmwareImage> image,
+                         std::function<void(const std::string& deviceKey)> onSuccess,
+                         std::function<void(const std::string& deviceKey)> onFail)
+    {
+        install(deviceKey, image->getPath(), onSuccess, onFail);
+    }
+
+    /**
+     * @brief Install the firmware from provided image, reporting progress
+     *
+     * onProgress can be called as often as convenient, from any thread. Progress is coalesced
+     * and published at most once per progress interval per device.
+     * Default implementation installs without reporting progress.
+     *
+     * This call needs to return as quickly as possible
+     *
+     * @param deviceKey Key of the device
+     * @param image Firmware image to install, same image is shared by all devices of install command
+     * @param onSuccess Function to call if install is successful
+     * @param onFail Function to call if install has failed
+     * @param onProgress Function to call with installation progress in percent
+     */
+    virtual void install(const std::string& deviceKey, std::shared_ptr<const FirmwareImage> image,
+                         std::function<void(const std::string& deviceKey)> onSuccess,
+                         std::function<void(const std::string& deviceKey)> onFail,
+                         std::function<void(const std::string& deviceKey, unsigned int percent)> onProgress)
+    {
+        (void)onProgress;
+        install(deviceKey, image, onSuccess, onFail);
+    }
+
     /**
      * @brief Abort firmware installation if possible
      *
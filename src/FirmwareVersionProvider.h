@@ -16,7 +16,9 @@
 #ifndef FIRMWAREVERSIONPROVIDER_H
 #define FIRMWAREVERSIONPROVIDER_H
 
+#include <map>
 #include <string>
+#include <vector>
 
 namespace wolkabout
 {
@@ -31,6 +33,23 @@ public:
      * @return firmware version
      */
     virtual std::string getFirmwareVersion(const std::string& deviceKey) = 0;
+
+    /**
+     * @brief Provide firmware versions for specified devices at once<br>
+     *        Default implementation queries versions one device at a time
+     * @param deviceKeys Keys of the devices
+     * @return firmware versions by device key, devices without known version may be omitted
+     */
+    virtual std::map<std::string, std::string> getFirmwareVersions(const std::vector<std::string>& deviceKeys)
+    {
+        std::map<std::string, std::string> firmwareVersions;
+        for (const auto& deviceKey : deviceKeys)
+        {
+            firmwareVersions[deviceKey] = getFirmwareVersion(deviceKey);
+        }
+
+        return firmwareVersions;
+    }
 };
 }    // namespace wolkabout
 
@@ -20,8 +20,10 @@
 #include "core/protocol/Protocol.h"
 #include "core/utilities/Logger.h"
 #include "core/utilities/StringUtils.h"
+#include "utilities/Tracer.h"
 
 #include <algorithm>
+#include <chrono>
 
 namespace wolkabout
 {
@@ -34,6 +36,13 @@ InboundGatewayMessageHandler::~InboundGatewayMessageHandler()
 
 void InboundGatewayMessageHandler::messageReceived(const std::string& channel, const std::string& payload)
 {
+    const bool isTraced = Tracer::isEnabled();
+    std::chrono::steady_clock::time_point received;
+    if (isTraced)
+    {
+        received = std::chrono::steady_clock::now();
+    }
+
     LOG(DEBUG) << "Message received on channel: '" << channel << "' : '" << payload << "'";
 
     std::lock_guard<std::mutex> lg{m_lock};
@@ -49,6 +58,10 @@ void InboundGatewayMessageHandler::messageReceived(const std::string& channel, c
         addToCommandBuffer([=] {
             if (auto handler = channelHandler.lock())
             {
+                if (isTraced)
+                {
+                    Tracer::markReceived(received);
+                }
                 handler->messageReceived(std::make_shared<Message>(payload, channel));
             }
         });
@@ -16,8 +16,8 @@
 
 #include "Wolk.h"
 
-#include "ActuationHandlerPerDevice.h"
-#include "ActuatorStatusProviderPerDevice.h"
+#include "AsyncActuationHandlerPerDevice.h"
+#include "AsyncActuatorStatusProviderPerDevice.h"
 #include "InboundGatewayMessageHandler.h"
 #include "WolkBuilder.h"
 #include "core/connectivity/ConnectivityService.h"
@@ -30,102 +30,173 @@
 #include "core/utilities/Logger.h"
 #include "core/utilities/StringUtils.h"
 #include "model/Device.h"
+#include "service/AsyncPublisher.h"
+#include "service/ConfigurationCache.h"
 #include "service/DataService.h"
+#include "service/DeviceIoExecutor.h"
 #include "service/DeviceRegistrationService.h"
+#include "service/DeviceRegistry.h"
 #include "service/DeviceStatusService.h"
+#include "service/DrainScheduler.h"
 #include "service/FirmwareUpdateService.h"
+#include "service/FlushScheduler.h"
+#include "service/SensorReadingAggregator.h"
+#include "service/SensorReadingFilter.h"
+#include "utilities/LogRateLimiter.h"
+#include "utilities/TaskTimer.h"
 
 #include <algorithm>
 #include <memory>
 #include <sstream>
 #include <string>
-#include <thread>
 #include <utility>
 
-#define INSTANTIATE_ADD_SENSOR_READING_FOR(x)                                                                    \
-    template void Wolk::addSensorReading<x>(const std::string& deviceKey, const std::string& reference, x value, \
-                                            unsigned long long rtc);                                             \
-    template void Wolk::addSensorReading<x>(const std::string& deviceKey, const std::string& reference,          \
-                                            std::initializer_list<x> value, unsigned long long int rtc);         \
-    template void Wolk::addSensorReading<x>(const std::string& deviceKey, const std::string& reference,          \
-                                            const std::vector<x> values, unsigned long long int rtc)
+#define INSTANTIATE_ADD_SENSOR_READING_FOR(x)                                                                       \
+    template IngestionStatus Wolk::addSensorReading<x>(const std::string& deviceKey, const std::string& reference,  \
+                                                       x value, unsigned long long rtc);                            \
+    template IngestionStatus Wolk::addSensorReading<x>(const std::string& deviceKey, const std::string& reference,  \
+                                                       std::initializer_list<x> value, unsigned long long int rtc); \
+    template IngestionStatus Wolk::addSensorReading<x>(const std::string& deviceKey, const std::string& reference,  \
+                                                       const std::vector<x> values, unsigned long long int rtc)
 
 namespace wolkabout
 {
+const std::chrono::milliseconds Wolk::RECONNECT_DELAY{2000};
+const std::chrono::milliseconds Wolk::DEVICE_IO_SHUTDOWN_TIMEOUT{1000};
+
 WolkBuilder Wolk::newBuilder()
 {
     return WolkBuilder();
 }
 
 template <>
-void Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference, std::string value,
-                            unsigned long long rtc)
+IngestionStatus Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference,
+                                       std::string value, unsigned long long rtc)
 {
-    addToCommandBuffer([=]() -> void {
-        if (!deviceExists(deviceKey))
-        {
-            LOG(ERROR) << "Device does not exist: " << deviceKey;
-            return;
-        }
+    if (rtc == 0)
+    {
+        rtc = Wolk::currentRtc();
+    }
 
-        if (!sensorDefinedForDevice(deviceKey, reference))
-        {
-            LOG(ERROR) << "Sensor does not exist for device: " << deviceKey << ", " << reference;
-            return;
-        }
+    PersistenceKey ids;
+    const auto status = validateSensorReading(deviceKey, reference, ids);
+    if (status != IngestionStatus::ACCEPTED)
+    {
+        return logRejectedIngestion(status, deviceKey, reference);
+    }
 
-        m_dataService->addSensorReading(deviceKey, reference, value, rtc != 0 ? rtc : Wolk::currentRtc());
-    });
+    if (m_sensorReadingAggregator->isAggregated(reference))
+    {
+        m_sensorReadingAggregator->addSample(deviceKey, reference, {value}, rtc);
+        return IngestionStatus::ACCEPTED;
+    }
+
+    if (!m_sensorReadingFilter->accept(deviceKey, reference, {value}, rtc))
+    {
+        return IngestionStatus::ACCEPTED;
+    }
+
+    // queued command holds ids instead of copies of device key and reference
+    const auto size = reference.size() + value.size();
+    const bool admitted = addToCommandBuffer(
+      [this, ids, value, rtc, size]() -> void {
+          m_dataService->addSensorReading(ids, value, rtc);
+
+          if (m_flushScheduler)
+          {
+              m_flushScheduler->added(size);
+          }
+      },
+      CommandLane::TELEMETRY);
+
+    if (!admitted)
+    {
+        return logRejectedIngestion(IngestionStatus::QUEUE_FULL, deviceKey, reference);
+    }
+
+    return IngestionStatus::ACCEPTED;
 }
 
 template <typename T>
-void Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference, T value, unsigned long long rtc)
+IngestionStatus Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference, T value,
+                                       unsigned long long rtc)
 {
-    addSensorReading(deviceKey, reference, StringUtils::toString(value), rtc);
+    return addSensorReading(deviceKey, reference, StringUtils::toString(value), rtc);
 }
 
 template <>
-void Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference,
-                            const std::vector<std::string> values, unsigned long long int rtc)
+IngestionStatus Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference,
+                                       const std::vector<std::string> values, unsigned long long int rtc)
 {
     if (values.empty())
     {
-        return;
+        return IngestionStatus::ACCEPTED;
     }
 
-    addToCommandBuffer([=]() -> void {
-        if (!deviceExists(deviceKey))
-        {
-            LOG(ERROR) << "Device does not exist: " << deviceKey;
-            return;
-        }
+    if (rtc == 0)
+    {
+        rtc = Wolk::currentRtc();
+    }
 
-        if (!sensorDefinedForDevice(deviceKey, reference))
-        {
-            LOG(ERROR) << "Sensor does not exist for device: " << deviceKey << ", " << reference;
-            return;
-        }
+    PersistenceKey ids;
+    const auto status = validateSensorReading(deviceKey, reference, ids);
+    if (status != IngestionStatus::ACCEPTED)
+    {
+        return logRejectedIngestion(status, deviceKey, reference);
+    }
 
-        m_dataService->addSensorReading(deviceKey, reference, values, rtc != 0 ? rtc : Wolk::currentRtc());
-    });
+    if (m_sensorReadingAggregator->isAggregated(reference))
+    {
+        m_sensorReadingAggregator->addSample(deviceKey, reference, values, rtc);
+        return IngestionStatus::ACCEPTED;
+    }
+
+    if (!m_sensorReadingFilter->accept(deviceKey, reference, values, rtc))
+    {
+        return IngestionStatus::ACCEPTED;
+    }
+
+    std::size_t size = reference.size();
+    for (const auto& value : values)
+    {
+        size += value.size();
+    }
+
+    const bool admitted = addToCommandBuffer(
+      [this, ids, values, rtc, size]() -> void {
+          m_dataService->addSensorReading(ids, values, rtc);
+
+          if (m_flushScheduler)
+          {
+              m_flushScheduler->added(size);
+          }
+      },
+      CommandLane::TELEMETRY);
+
+    if (!admitted)
+    {
+        return logRejectedIngestion(IngestionStatus::QUEUE_FULL, deviceKey, reference);
+    }
+
+    return IngestionStatus::ACCEPTED;
 }
 
 template <typename T>
-void Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference, std::initializer_list<T> values,
-                            unsigned long long int rtc)
+IngestionStatus Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference,
+                                       std::initializer_list<T> values, unsigned long long int rtc)
 {
-    addSensorReading(deviceKey, reference, std::vector<T>(values), rtc);
+    return addSensorReading(deviceKey, reference, std::vector<T>(values), rtc);
 }
 
 template <typename T>
-void Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference, const std::vector<T> values,
-                            unsigned long long int rtc)
+IngestionStatus Wolk::addSensorReading(const std::string& deviceKey, const std::string& reference,
+                                       const std::vector<T> values, unsigned long long int rtc)
 {
     std::vector<std::string> stringifiedValues(values.size());
     std::transform(values.cbegin(), values.cend(), stringifiedValues.begin(),
                    [&](const T& value) -> std::string { return StringUtils::toString(value); });
 
-    addSensorReading(deviceKey, reference, stringifiedValues, rtc);
+    return addSensorReading(deviceKey, reference, stringifiedValues, rtc);
 }
 
 INSTANTIATE_ADD_SENSOR_READING_FOR(std::string);
@@ -141,28 +212,39 @@ INSTANTIATE_ADD_SENSOR_READING_FOR(unsigned int);
 INSTANTIATE_ADD_SENSOR_READING_FOR(unsigned long int);
 INSTANTIATE_ADD_SENSOR_READING_FOR(unsigned long long int);
 
-void Wolk::addAlarm(const std::string& deviceKey, const std::string& reference, bool active, unsigned long long rtc)
+IngestionStatus Wolk::addAlarm(const std::string& deviceKey, const std::string& reference, bool active,
+                               unsigned long long rtc)
 {
     if (rtc == 0)
     {
         rtc = Wolk::currentRtc();
     }
 
-    addToCommandBuffer([=]() -> void {
-        if (!deviceExists(deviceKey))
-        {
-            LOG(ERROR) << "Device does not exist: " << deviceKey;
-            return;
-        }
+    PersistenceKey ids;
+    const auto status = validateAlarm(deviceKey, reference, ids);
+    if (status != IngestionStatus::ACCEPTED)
+    {
+        return logRejectedIngestion(status, deviceKey, reference);
+    }
 
-        if (!alarmDefinedForDevice(deviceKey, reference))
-        {
-            LOG(ERROR) << "Alarm does not exist for device: " << deviceKey << ", " << reference;
-            return;
-        }
+    const auto size = reference.size() + 1;
+    const bool admitted = addToCommandBuffer(
+      [this, ids, active, rtc, size]() -> void {
+          m_dataService->addAlarm(ids, active, rtc);
 
-        m_dataService->addAlarm(deviceKey, reference, active, rtc);
-    });
+          if (m_flushScheduler)
+          {
+              m_flushScheduler->added(size);
+          }
+      },
+      CommandLane::TELEMETRY);
+
+    if (!admitted)
+    {
+        return logRejectedIngestion(IngestionStatus::QUEUE_FULL, deviceKey, reference);
+    }
+
+    return IngestionStatus::ACCEPTED;
 }
 
 void Wolk::publishActuatorStatus(const std::string& deviceKey, const std::string& reference)
@@ -174,7 +256,7 @@ void Wolk::publishActuatorStatus(const std::string& deviceKey, const std::string
 {
     addToCommandBuffer([=] {
         m_dataService->addActuatorStatus(deviceKey, reference, value, ActuatorStatus::State::READY);
-        m_dataService->publishActuatorStatuses(deviceKey);
+        schedulePendingPublish();
     });
 }
 
@@ -186,11 +268,22 @@ void Wolk::publishConfiguration(const std::string& deviceKey)
 void Wolk::publishConfiguration(const std::string& deviceKey, std::vector<ConfigurationItem> configurations)
 {
     addToCommandBuffer([=] {
-        m_dataService->addConfiguration(deviceKey, configurations);
-        m_dataService->publishConfiguration();
+        const auto changedItems = m_configurationCache->update(deviceKey, configurations);
+        if (changedItems.empty())
+        {
+            return;
+        }
+
+        m_dataService->addConfiguration(deviceKey, changedItems);
+        schedulePendingPublish();
     });
 }
 
+void Wolk::invalidateConfiguration(const std::string& deviceKey)
+{
+    m_configurationCache->invalidate(deviceKey);
+}
+
 void Wolk::addDeviceStatus(const std::string& deviceKey, DeviceStatus::Status status)
 {
     addToCommandBuffer([=] {
@@ -210,20 +303,24 @@ void Wolk::connect(bool publishRightAway)
         if (m_connectivityService->connect())
         {
             m_connected = true;
+
+            // batches sent before (re)connecting will not be acknowledged, publish them again
+            m_dataService->resetInFlight();
+
+            // configuration may have been changed on devices while disconnected, read it from them again
+            m_configurationCache->invalidateAll();
+
             registerDevices();
             if (publishRightAway)
             {
                 publishFirmwareVersions();
                 publishDeviceStatuses();
 
-                for (const auto& kvp : m_devices)
-                {
-                    for (const std::string& actuatorReference : kvp.second.getActuatorReferences())
-                    {
-                        publishActuatorStatus(kvp.first, actuatorReference);
-                    }
+                addToCommandBuffer([=] { refreshActuatorStatuses(getDeviceKeys()); });
 
-                    publishConfiguration(kvp.first);
+                for (const auto& deviceKey : getDeviceKeys())
+                {
+                    publishConfiguration(deviceKey);
                 }
 
                 publish();
@@ -231,8 +328,7 @@ void Wolk::connect(bool publishRightAway)
         }
         else
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(2000));
-            connect(publishRightAway);
+            m_reconnectTimer->start(RECONNECT_DELAY, [=] { connect(publishRightAway); });
         }
     });
 }
@@ -240,6 +336,8 @@ void Wolk::connect(bool publishRightAway)
 void Wolk::disconnect()
 {
     addToCommandBuffer([=]() -> void {
+        m_reconnectTimer->stop();
+
         m_connected = false;
         m_connectivityService->disconnect();
     });
@@ -250,9 +348,10 @@ void Wolk::publish()
     addToCommandBuffer([=]() -> void {
         m_dataService->publishActuatorStatuses();
         m_dataService->publishConfiguration();
-        m_dataService->publishAlarms();
-        m_dataService->publishSensorReadings();
     });
+
+    addToCommandBuffer([=]() -> void { m_drainScheduler->drain(m_dataService->getTelemetryDeviceKeys()); },
+                       CommandLane::TELEMETRY, true);
 }
 
 void Wolk::publish(const std::string& deviceKey)
@@ -266,23 +365,29 @@ void Wolk::publish(const std::string& deviceKey)
 
         m_dataService->publishActuatorStatuses(deviceKey);
         m_dataService->publishConfiguration(deviceKey);
-        m_dataService->publishAlarms(deviceKey);
-        m_dataService->publishSensorReadings(deviceKey);
     });
+
+    addToCommandBuffer(
+      [=]() -> void {
+          if (!deviceExists(deviceKey))
+          {
+              return;
+          }
+
+          m_drainScheduler->drain({deviceKey});
+      },
+      CommandLane::TELEMETRY, true);
 }
 
 void Wolk::addDevice(const Device& device)
 {
-    addToCommandBuffer([=] {
-        const std::string deviceKey = device.getKey();
-        if (deviceExists(deviceKey))
-        {
-            LOG(ERROR) << "Device with key '" << deviceKey << "' was already added";
-            return;
-        }
-
-        m_devices[deviceKey] = device;
+    if (!m_deviceRegistry->addDevice(device))
+    {
+        LOG(ERROR) << "Device with key '" << device.getKey() << "' was already added";
+        return;
+    }
 
+    addToCommandBuffer([=] {
         m_deviceStatusService->devicesUpdated(getDeviceKeys());
 
         if (m_connected)
@@ -298,15 +403,16 @@ void Wolk::addAssetsToDevice(std::string deviceKey, bool updateDefaultSemantics,
                              std::vector<AlarmTemplate> alarms, std::vector<ActuatorTemplate> actuators)
 {
     addToCommandBuffer([=] {
-        if (!deviceExists(deviceKey))
+        const auto devices = m_deviceRegistry->getSnapshot();
+
+        const auto it = devices->find(deviceKey);
+        if (it == devices->end())
         {
             LOG(ERROR) << "Can't update device with key '" << deviceKey << "': device is not registered";
             return;
         }
 
-        auto& device = m_devices[deviceKey];
-
-        if (!validateAssetsToUpdate(device, configurations, sensors, alarms, actuators))
+        if (!validateAssetsToUpdate(it->second, configurations, sensors, alarms, actuators))
         {
             return;
         }
@@ -314,32 +420,151 @@ void Wolk::addAssetsToDevice(std::string deviceKey, bool updateDefaultSemantics,
         if (m_connected)
         {
             updateDevice(deviceKey, updateDefaultSemantics, configurations, sensors, alarms, actuators);
-            storeAssetsToDevice(device, configurations, sensors, alarms, actuators);
+            m_deviceRegistry->updateDevice(deviceKey, [&](Device& device) {
+                storeAssetsToDevice(device, configurations, sensors, alarms, actuators);
+            });
         }
     });
 }
 
 void Wolk::removeDevice(const std::string& deviceKey)
 {
-    addToCommandBuffer([=] {
-        auto it = m_devices.find(deviceKey);
-        if (it != m_devices.end())
-        {
-            m_devices.erase(it);
-        }
-    });
+    m_deviceRegistry->removeDevice(deviceKey);
+    m_configurationCache->invalidate(deviceKey);
+
+    if (m_handlerWatchdog)
+    {
+        m_handlerWatchdog->removeDevice(deviceKey);
+    }
+
+    m_sensorReadingFilter->removeDevice(deviceKey);
+    m_sensorReadingAggregator->removeDevice(deviceKey);
+
+    // after telemetry of device that is already queued
+    addToCommandBuffer([=] { m_dataService->removeDevice(deviceKey); }, CommandLane::TELEMETRY, true);
+}
+
+void Wolk::setSensorReadingFilter(const std::string& deviceKey, const std::string& reference,
+                                  const DeadbandFilter& filter)
+{
+    m_sensorReadingFilter->setFilter(deviceKey, reference, filter);
+}
+
+DeadbandFilterStatistics Wolk::getSensorReadingFilterStatistics() const
+{
+    return m_sensorReadingFilter->getStatistics();
+}
+
+CommandLaneStatistics Wolk::getCommandLaneStatistics(CommandLane lane) const
+{
+    return m_commandBuffer->getStatistics(lane);
+}
+
+MemoryPoolStatistics Wolk::getModelPoolStatistics() const
+{
+    return m_dataService->getModelPoolStatistics();
 }
 
-Wolk::Wolk() : m_connected{false}, m_commandBuffer{new CommandBuffer()} {}
+HandlerWatchdogStatistics Wolk::getHandlerWatchdogStatistics() const
+{
+    return m_handlerWatchdog ? m_handlerWatchdog->getStatistics() : HandlerWatchdogStatistics{0, 0, 0, 0, 0, 0};
+}
+
+TraceStageStatistics Wolk::getActuationTraceStatistics(TraceStage stage) const
+{
+    if (m_tracer)
+    {
+        return m_tracer->getStatistics(stage);
+    }
+
+    return TraceStageStatistics{0, 0, 0, {}};
+}
+
+std::size_t Wolk::getFirmwareInstallQueuePosition(const std::string& deviceKey) const
+{
+    return m_firmwareUpdateService ? m_firmwareUpdateService->getInstallQueuePosition(deviceKey) : 0;
+}
+
+Wolk::Wolk()
+: m_sensorReadingFilter{new SensorReadingFilter()}
+, m_sensorReadingAggregator{new SensorReadingAggregator(
+    [this](const std::string& deviceKey, const std::string& reference, const std::vector<std::string>& values,
+           unsigned long long int rtc) { addSensorReading(deviceKey, reference, values, rtc); })}
+, m_configurationCache{new ConfigurationCache()}
+, m_ingestionErrorLog{new LogRateLimiter(INGESTION_ERROR_LOG_RATE, INGESTION_ERROR_LOG_BURST)}
+, m_connected{false}
+, m_reconnectTimer{new TaskTimer()}
+, m_pendingPublishScheduled{false}
+, m_commandBuffer{new PriorityCommandBuffer()}
+{
+}
 
 Wolk::~Wolk()
 {
+    // commands use all components below, so nothing is executed once they start stopping;
+    // components may still push to stopped command buffer, such commands are discarded
     m_commandBuffer->stop();
+
+    // stopped after command buffer, which may schedule a retry
+    m_reconnectTimer->stop();
+
+    // aggregator publishes through this object, so it is destroyed before other members
+    m_sensorReadingAggregator.reset();
+
+    if (m_flushScheduler)
+    {
+        m_flushScheduler->stop();
+    }
+
+    if (m_drainScheduler)
+    {
+        m_drainScheduler->stop();
+    }
+
+    if (m_asyncPublisher)
+    {
+        m_asyncPublisher->stop();
+    }
+
+    // watchdog and device I/O complete through command buffer, so they are stopped before it is destroyed
+    m_handlerWatchdog.reset();
+    m_deviceIoExecutor.reset();
 }
 
-void Wolk::addToCommandBuffer(std::function<void()> command)
+bool Wolk::addToCommandBuffer(std::function<void()> command, CommandLane lane, bool bypassCapacity)
 {
-    m_commandBuffer->pushCommand(std::make_shared<std::function<void()>>(command));
+    return m_commandBuffer->pushCommand(std::move(command), lane, bypassCapacity);
+}
+
+void Wolk::schedulePendingPublish()
+{
+    if (m_pendingPublishScheduled)
+    {
+        return;
+    }
+
+    m_pendingPublishScheduled = true;
+
+    addToCommandBuffer([=] {
+        m_pendingPublishScheduled = false;
+
+        const auto publishedReferences = m_dataService->publishPendingActuatorStatuses();
+        m_dataService->publishPendingConfigurations();
+
+        for (const auto& pending : m_pendingPublishTraces)
+        {
+            // status that is not published now stays persisted and is published later, outside of its trace
+            const auto it = publishedReferences.find(pending.deviceKey);
+            if (it != publishedReferences.end() &&
+                std::find(it->second.begin(), it->second.end(), pending.reference) != it->second.end())
+            {
+                traceActuation(pending.trace, TraceStage::PUBLISH);
+            }
+
+            endActuationTrace(pending.trace);
+        }
+        m_pendingPublishTraces.clear();
+    });
 }
 
 unsigned long long Wolk::currentRtc()
@@ -348,45 +573,116 @@ unsigned long long Wolk::currentRtc()
     return static_cast<unsigned long long>(std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
 }
 
+bool Wolk::isConfigurationApplied(const std::vector<ConfigurationItem>& requested,
+                                  const std::vector<ConfigurationItem>& configuration)
+{
+    for (const auto& requestedItem : requested)
+    {
+        const auto it = std::find_if(configuration.begin(), configuration.end(), [&](const ConfigurationItem& item) {
+            return item.getReference() == requestedItem.getReference();
+        });
+
+        if (it == configuration.end() || it->getValues() != requestedItem.getValues())
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void Wolk::refreshActuatorStatuses(const std::vector<std::string>& deviceKeys)
+{
+    std::map<std::string, std::vector<std::string>> references;
+    for (const auto& deviceKey : deviceKeys)
+    {
+        auto actuatorReferences = getActuatorReferences(deviceKey);
+        if (!actuatorReferences.empty())
+        {
+            references.emplace(deviceKey, std::move(actuatorReferences));
+        }
+    }
+
+    if (references.empty())
+    {
+        return;
+    }
+
+    getActuatorStatuses(references, [=](const std::map<std::string, std::map<std::string, ActuatorStatus>>& statuses) {
+        for (const auto& kvp : references)
+        {
+            const auto deviceStatusesIt = statuses.find(kvp.first);
+
+            for (const auto& reference : kvp.second)
+            {
+                const ActuatorStatus actuatorStatus = [&] {
+                    if (deviceStatusesIt != statuses.end())
+                    {
+                        auto statusIt = deviceStatusesIt->second.find(reference);
+                        if (statusIt != deviceStatusesIt->second.end())
+                        {
+                            return statusIt->second;
+                        }
+                    }
+
+                    return ActuatorStatus("", ActuatorStatus::State::ERROR);
+                }();
+
+                m_dataService->addActuatorStatus(kvp.first, reference, actuatorStatus.getValue(),
+                                                 actuatorStatus.getState());
+            }
+        }
+
+        schedulePendingPublish();
+    });
+}
+
 void Wolk::handleActuatorSetCommand(const std::string& key, const std::string& reference, const std::string& value)
 {
+    // called from inbound message thread, so arrival of actuation message is attributed to this trace
+    const Tracer::TraceId trace = m_tracer ? m_tracer->begin(key, reference) : 0;
+
     addToCommandBuffer([=] {
+        traceActuation(trace, TraceStage::COMMAND_QUEUE);
+
         if (!deviceExists(key))
         {
             LOG(ERROR) << "Device does not exist: " << key;
+            endActuationTrace(trace);
             return;
         }
 
         if (!actuatorDefinedForDevice(key, reference))
         {
             LOG(ERROR) << "Actuator does not exist for device: " << key << ", " << reference;
+            endActuationTrace(trace);
             return;
         }
 
-        if (m_actuationHandler)
-        {
-            m_actuationHandler->handleActuation(key, reference, value);
-        }
-        else if (m_actuationHandlerLambda)
-        {
-            m_actuationHandlerLambda(key, reference, value);
-        }
+        const auto actuation = watchActuation(key, reference);
 
-        const ActuatorStatus actuatorStatus = [&] {
-            if (m_actuatorStatusProvider)
-            {
-                return m_actuatorStatusProvider->getActuatorStatus(key, reference);
-            }
-            else if (m_actuatorStatusProviderLambda)
-            {
-                return m_actuatorStatusProviderLambda(key, reference);
-            }
+        handleActuation(key, reference, value, [=] {
+            traceActuation(trace, TraceStage::ACTUATION);
 
-            return ActuatorStatus("", ActuatorStatus::State::ERROR);
-        }();
+            getActuatorStatus(key, reference, [=](const ActuatorStatus& actuatorStatus) {
+                traceActuation(trace, TraceStage::STATUS);
 
-        m_dataService->addActuatorStatus(key, reference, actuatorStatus.getValue(), actuatorStatus.getState());
-        m_dataService->publishActuatorStatuses();
+                if (m_handlerWatchdog)
+                {
+                    m_handlerWatchdog->finish(actuation);
+                }
+
+                m_dataService->addActuatorStatus(key, reference, actuatorStatus.getValue(),
+                                                 actuatorStatus.getState());
+
+                if (m_tracer)
+                {
+                    m_pendingPublishTraces.push_back(PendingPublishTrace{trace, key, reference});
+                }
+
+                schedulePendingPublish();
+            });
+        });
     });
 }
 
@@ -395,28 +691,7 @@ void Wolk::handleActuatorGetCommand(const std::string& key, const std::string& r
     addToCommandBuffer([=] {
         if (key.empty() && reference.empty())
         {
-            for (const auto& kvp : m_devices)
-            {
-                for (const std::string& actuatorReference : kvp.second.getActuatorReferences())
-                {
-                    const ActuatorStatus actuatorStatus = [&] {
-                        if (m_actuatorStatusProvider)
-                        {
-                            return m_actuatorStatusProvider->getActuatorStatus(kvp.second.getKey(), actuatorReference);
-                        }
-                        else if (m_actuatorStatusProviderLambda)
-                        {
-                            return m_actuatorStatusProviderLambda(kvp.second.getKey(), actuatorReference);
-                        }
-
-                        return ActuatorStatus("", ActuatorStatus::State::ERROR);
-                    }();
-
-                    m_dataService->addActuatorStatus(kvp.second.getKey(), actuatorReference, actuatorStatus.getValue(),
-                                                     actuatorStatus.getState());
-                }
-                m_dataService->publishActuatorStatuses();
-            }
+            refreshActuatorStatuses(getDeviceKeys());
         }
         else
         {
@@ -431,21 +706,18 @@ void Wolk::handleActuatorGetCommand(const std::string& key, const std::string& r
                 return;
             }
 
-            const ActuatorStatus actuatorStatus = [&] {
-                if (m_actuatorStatusProvider)
-                {
-                    return m_actuatorStatusProvider->getActuatorStatus(key, reference);
-                }
-                else if (m_actuatorStatusProviderLambda)
+            const auto actuation = watchActuation(key, reference);
+
+            getActuatorStatus(key, reference, [=](const ActuatorStatus& actuatorStatus) {
+                if (m_handlerWatchdog)
                 {
-                    return m_actuatorStatusProviderLambda(key, reference);
+                    m_handlerWatchdog->finish(actuation);
                 }
 
-                return ActuatorStatus("", ActuatorStatus::State::ERROR);
-            }();
-
-            m_dataService->addActuatorStatus(key, reference, actuatorStatus.getValue(), actuatorStatus.getState());
-            m_dataService->publishActuatorStatuses();
+                m_dataService->addActuatorStatus(key, reference, actuatorStatus.getValue(),
+                                                 actuatorStatus.getState());
+                schedulePendingPublish();
+            });
         }
     });
 }
@@ -464,20 +736,9 @@ void Wolk::handleDeviceStatusRequest(const std::string& key)
                 return;
             }
 
-            const DeviceStatus::Status status = [&] {
-                if (m_deviceStatusProvider)
-                {
-                    return m_deviceStatusProvider->getDeviceStatus(key);
-                }
-                else if (m_deviceStatusProviderLambda)
-                {
-                    return m_deviceStatusProviderLambda(key);
-                }
-
-                return DeviceStatus::Status::OFFLINE;
-            }();
-
-            m_deviceStatusService->publishDeviceStatusResponse(key, status);
+            getDeviceStatus(key, [=](DeviceStatus::Status status) {
+                m_deviceStatusService->publishDeviceStatusResponse(key, status);
+            });
         }
     });
 }
@@ -501,30 +762,42 @@ void Wolk::handleConfigurationSetCommand(const std::string& key, const std::vect
             }
         }
 
-        if (m_configurationHandler)
-        {
-            m_configurationHandler->handleConfiguration(key, configuration);
-        }
-        else if (m_configurationHandlerLambda)
+        std::vector<std::string> references;
+        for (const auto& configurationItem : configuration)
         {
-            m_configurationHandlerLambda(key, configuration);
+            references.push_back(configurationItem.getReference());
         }
 
-        const std::vector<ConfigurationItem> configFromDevice = [&] {
-            if (m_configurationProvider)
-            {
-                return m_configurationProvider->getConfiguration(key);
-            }
-            else if (m_configurationProviderLambda)
-            {
-                return m_configurationProviderLambda(key);
-            }
+        // handler receives only items that differ from last known configuration of device
+        const auto changedItems = m_configurationCache->diff(key, configuration);
 
-            return std::vector<ConfigurationItem>{};
-        }();
+        const auto publishReadBack = [=] {
+            getConfigurationFromDevice(key, [=](const std::vector<ConfigurationItem>& configurationFromDevice) {
+                if (!isConfigurationApplied(changedItems, configurationFromDevice))
+                {
+                    // rejected change means cached configuration no longer reflects the device
+                    m_configurationCache->invalidate(key);
+                }
 
-        m_dataService->addConfiguration(key, configFromDevice);
-        m_dataService->publishConfiguration();
+                // items of set command are always published as its response, unrelated items only if they changed
+                const auto publishedItems = m_configurationCache->update(key, configurationFromDevice, references);
+                if (publishedItems.empty())
+                {
+                    return;
+                }
+
+                m_dataService->addConfiguration(key, publishedItems);
+                schedulePendingPublish();
+            });
+        };
+
+        if (changedItems.empty())
+        {
+            publishReadBack();
+            return;
+        }
+
+        handleConfiguration(key, changedItems, publishReadBack);
     });
 }
 
@@ -537,24 +810,240 @@ void Wolk::handleConfigurationGetCommand(const std::string& key)
             return;
         }
 
-        const std::vector<ConfigurationItem> configFromDevice = [&] {
-            if (m_configurationProvider)
-            {
-                return m_configurationProvider->getConfiguration(key);
-            }
-            else if (m_configurationProviderLambda)
+        std::vector<ConfigurationItem> configuration;
+        if (m_configurationCache->get(key, configuration))
+        {
+            m_dataService->addConfiguration(key, configuration);
+            schedulePendingPublish();
+            return;
+        }
+
+        getConfigurationFromDevice(key, [=](const std::vector<ConfigurationItem>& configurationFromDevice) {
+            m_configurationCache->update(key, configurationFromDevice);
+
+            m_dataService->addConfiguration(key, configurationFromDevice);
+            schedulePendingPublish();
+        });
+    });
+}
+
+void Wolk::handleActuation(const std::string& deviceKey, const std::string& reference, const std::string& value,
+                           std::function<void()> onComplete)
+{
+    const auto commandBuffer = m_commandBuffer;
+    const auto complete = [=] { commandBuffer->pushCommand(onComplete, CommandLane::CONTROL, true); };
+
+    const auto handler = m_actuationHandler;
+    const auto handlerLambda = m_actuationHandlerLambda;
+    executeDeviceIo(deviceKey, [=] {
+        if (handler)
+        {
+            handler->handleActuation(deviceKey, reference, value, complete);
+            return;
+        }
+
+        if (handlerLambda)
+        {
+            handlerLambda(deviceKey, reference, value);
+        }
+
+        complete();
+    });
+}
+
+void Wolk::getActuatorStatus(const std::string& deviceKey, const std::string& reference,
+                             std::function<void(const ActuatorStatus&)> onStatus)
+{
+    const auto commandBuffer = m_commandBuffer;
+    const auto complete = [=](const ActuatorStatus& status) {
+        commandBuffer->pushCommand([=] { onStatus(status); }, CommandLane::CONTROL, true);
+    };
+
+    const auto provider = m_actuatorStatusProvider;
+    const auto providerLambda = m_actuatorStatusProviderLambda;
+    executeDeviceIo(deviceKey, [=] {
+        if (provider)
+        {
+            provider->getActuatorStatus(deviceKey, reference, complete);
+        }
+        else if (providerLambda)
+        {
+            complete(providerLambda(deviceKey, reference));
+        }
+        else
+        {
+            complete(ActuatorStatus("", ActuatorStatus::State::ERROR));
+        }
+    });
+}
+
+void Wolk::getActuatorStatuses(
+  const std::map<std::string, std::vector<std::string>>& references,
+  std::function<void(const std::map<std::string, std::map<std::string, ActuatorStatus>>&)> onStatuses)
+{
+    const auto commandBuffer = m_commandBuffer;
+    const auto complete = [=](const std::map<std::string, std::map<std::string, ActuatorStatus>>& statuses) {
+        commandBuffer->pushCommand([=] { onStatuses(statuses); }, CommandLane::CONTROL, true);
+    };
+
+    std::vector<std::string> deviceKeys;
+    for (const auto& kvp : references)
+    {
+        deviceKeys.push_back(kvp.first);
+    }
+
+    // bulk request spans devices, so it is executed in order with calls of each of them
+    const auto provider = m_actuatorStatusProvider;
+    const auto providerLambda = m_actuatorStatusProviderLambda;
+    executeDeviceIo(deviceKeys, [=] {
+        if (provider)
+        {
+            provider->getActuatorStatuses(references, complete);
+            return;
+        }
+
+        std::map<std::string, std::map<std::string, ActuatorStatus>> statuses;
+        if (providerLambda)
+        {
+            for (const auto& kvp : references)
             {
-                return m_configurationProviderLambda(key);
+                auto& deviceStatuses = statuses[kvp.first];
+                for (const auto& reference : kvp.second)
+                {
+                    deviceStatuses.emplace(reference, providerLambda(kvp.first, reference));
+                }
             }
+        }
 
-            return std::vector<ConfigurationItem>{};
-        }();
+        complete(statuses);
+    });
+}
 
-        m_dataService->addConfiguration(key, configFromDevice);
-        m_dataService->publishConfiguration();
+void Wolk::getDeviceStatus(const std::string& deviceKey, std::function<void(DeviceStatus::Status)> onStatus)
+{
+    const auto commandBuffer = m_commandBuffer;
+    const auto complete = [=](DeviceStatus::Status status) {
+        commandBuffer->pushCommand([=] { onStatus(status); }, CommandLane::CONTROL, true);
+    };
+
+    const auto provider = m_deviceStatusProvider;
+    const auto providerLambda = m_deviceStatusProviderLambda;
+    executeDeviceIo(deviceKey, [=] {
+        if (provider)
+        {
+            provider->getDeviceStatus(deviceKey, complete);
+        }
+        else if (providerLambda)
+        {
+            complete(providerLambda(deviceKey));
+        }
+        else
+        {
+            complete(DeviceStatus::Status::OFFLINE);
+        }
+    });
+}
+
+void Wolk::handleConfiguration(const std::string& deviceKey, const std::vector<ConfigurationItem>& configuration,
+                               std::function<void()> onComplete)
+{
+    const auto commandBuffer = m_commandBuffer;
+    const auto complete = [=] { commandBuffer->pushCommand(onComplete, CommandLane::CONTROL, true); };
+
+    const auto handler = m_configurationHandler;
+    const auto handlerLambda = m_configurationHandlerLambda;
+    executeDeviceIo(deviceKey, [=] {
+        if (handler)
+        {
+            handler->handleConfiguration(deviceKey, configuration, complete);
+            return;
+        }
+
+        if (handlerLambda)
+        {
+            handlerLambda(deviceKey, configuration);
+        }
+
+        complete();
+    });
+}
+
+void Wolk::getConfigurationFromDevice(const std::string& deviceKey,
+                                      std::function<void(const std::vector<ConfigurationItem>&)> onConfiguration)
+{
+    const auto commandBuffer = m_commandBuffer;
+    const auto complete = [=](const std::vector<ConfigurationItem>& configuration) {
+        commandBuffer->pushCommand([=] { onConfiguration(configuration); }, CommandLane::CONTROL, true);
+    };
+
+    const auto provider = m_configurationProvider;
+    const auto providerLambda = m_configurationProviderLambda;
+    executeDeviceIo(deviceKey, [=] {
+        if (provider)
+        {
+            provider->getConfiguration(deviceKey, complete);
+        }
+        else if (providerLambda)
+        {
+            complete(providerLambda(deviceKey));
+        }
+        else
+        {
+            complete({});
+        }
     });
 }
 
+void Wolk::executeDeviceIo(const std::string& deviceKey, std::function<void()> call)
+{
+    if (!m_deviceIoExecutor->execute(deviceKey, std::move(call)))
+    {
+        LOG(WARN) << "Too many pending handler calls for device: " << deviceKey << ", call is dropped";
+    }
+}
+
+void Wolk::executeDeviceIo(const std::vector<std::string>& deviceKeys, std::function<void()> call)
+{
+    if (!m_deviceIoExecutor->execute(deviceKeys, std::move(call)))
+    {
+        LOG(WARN) << "Too many pending handler calls for one of " << deviceKeys.size() << " devices, call is dropped";
+    }
+}
+
+std::uint64_t Wolk::watchActuation(const std::string& deviceKey, const std::string& reference)
+{
+    return m_handlerWatchdog ? m_handlerWatchdog->start(deviceKey, reference) : 0;
+}
+
+void Wolk::traceActuation(Tracer::TraceId trace, TraceStage stage)
+{
+    if (m_tracer)
+    {
+        m_tracer->mark(trace, stage);
+    }
+}
+
+void Wolk::endActuationTrace(Tracer::TraceId trace)
+{
+    if (m_tracer)
+    {
+        m_tracer->end(trace);
+    }
+}
+
+void Wolk::handleActuationTimeout(const std::string& deviceKey, const std::string& reference)
+{
+    addToCommandBuffer(
+      [=] {
+          LOG(WARN) << "Actuation timed out for device: " << deviceKey << ", " << reference
+                    << ", device is quarantined";
+
+          m_dataService->addActuatorStatus(deviceKey, reference, "", ActuatorStatus::State::ERROR);
+          schedulePendingPublish();
+      },
+      CommandLane::CONTROL, true);
+}
+
 void Wolk::registerDevice(const Device& device)
 {
     addToCommandBuffer([=] { m_deviceRegistrationService->publishRegistrationRequest(device); });
@@ -574,7 +1063,7 @@ void Wolk::updateDevice(std::string deviceKey, bool updateDefaultSemantics,
 void Wolk::registerDevices()
 {
     addToCommandBuffer([=] {
-        for (const auto& kvp : m_devices)
+        for (const auto& kvp : *m_deviceRegistry->getSnapshot())
         {
             m_deviceRegistrationService->publishRegistrationRequest(kvp.second);
         }
@@ -601,33 +1090,19 @@ void Wolk::publishFirmwareVersions()
             return;
         }
 
-        for (const auto& kvp : m_devices)
-        {
-            m_firmwareUpdateService->publishFirmwareVersion(kvp.second.getKey());
-        }
+        m_firmwareUpdateService->publishFirmwareVersions(getDeviceKeys());
     });
 }
 
 void Wolk::publishDeviceStatuses()
 {
     addToCommandBuffer([=] {
-        for (const auto& kvp : m_devices)
+        for (const auto& deviceKey : getDeviceKeys())
         {
             addToCommandBuffer([=] {
-                const DeviceStatus::Status status = [&] {
-                    if (m_deviceStatusProvider)
-                    {
-                        return m_deviceStatusProvider->getDeviceStatus(kvp.second.getKey());
-                    }
-                    else if (m_deviceStatusProviderLambda)
-                    {
-                        return m_deviceStatusProviderLambda(kvp.second.getKey());
-                    }
-
-                    return DeviceStatus::Status::OFFLINE;
-                }();
-
-                m_deviceStatusService->publishDeviceStatusUpdate(kvp.second.getKey(), status);
+                getDeviceStatus(deviceKey, [=](DeviceStatus::Status status) {
+                    m_deviceStatusService->publishDeviceStatusUpdate(deviceKey, status);
+                });
             });
         }
     });
@@ -638,92 +1113,77 @@ void Wolk::publishDeviceStatus(const std::string& deviceKey, DeviceStatus::Statu
     addToCommandBuffer([=] { m_deviceStatusService->publishDeviceStatusUpdate(deviceKey, status); });
 }
 
-std::vector<std::string> Wolk::getDeviceKeys()
+std::vector<std::string> Wolk::getDeviceKeys() const
 {
-    std::vector<std::string> keys;
-    for (const auto& kvp : m_devices)
-    {
-        keys.push_back(kvp.first);
-    }
-
-    return keys;
+    return m_deviceRegistry->getDeviceKeys();
 }
 
-bool Wolk::deviceExists(const std::string& deviceKey)
+bool Wolk::deviceExists(const std::string& deviceKey) const
 {
-    auto it = m_devices.find(deviceKey);
-    return it != m_devices.end();
+    return m_deviceRegistry->deviceExists(deviceKey);
 }
 
-bool Wolk::sensorDefinedForDevice(const std::string& deviceKey, const std::string& reference)
+std::vector<std::string> Wolk::getActuatorReferences(const std::string& deviceKey) const
 {
-    auto it = m_devices.find(deviceKey);
-    if (it == m_devices.end())
-    {
-        return false;
-    }
-
-    const auto sensors = it->second.getTemplate().getSensors();
-    auto sensorIt = std::find_if(sensors.cbegin(), sensors.cend(),
-                                 [&](const SensorTemplate& Template) { return Template.getReference() == reference; });
-
-    return sensorIt != sensors.end();
+    return m_deviceRegistry->getActuatorReferences(deviceKey);
 }
 
-std::vector<std::string> Wolk::getActuatorReferences(const std::string& deviceKey)
+bool Wolk::actuatorDefinedForDevice(const std::string& deviceKey, const std::string& reference) const
 {
-    auto it = m_devices.find(deviceKey);
-    if (it == m_devices.end())
-    {
-        return {};
-    }
-
-    return it->second.getActuatorReferences();
+    return m_deviceRegistry->actuatorDefinedForDevice(deviceKey, reference);
 }
 
-bool Wolk::alarmDefinedForDevice(const std::string& deviceKey, const std::string& reference)
+bool Wolk::configurationItemDefinedForDevice(const std::string& deviceKey, const std::string& reference) const
 {
-    auto it = m_devices.find(deviceKey);
-    if (it == m_devices.end())
-    {
-        return false;
-    }
+    return m_deviceRegistry->configurationItemDefinedForDevice(deviceKey, reference);
+}
 
-    const auto alarms = it->second.getTemplate().getAlarms();
-    auto alarmIt = std::find_if(alarms.cbegin(), alarms.cend(),
-                                [&](const AlarmTemplate& Template) { return Template.getReference() == reference; });
+IngestionStatus Wolk::validateSensorReading(const std::string& deviceKey, const std::string& reference,
+                                            PersistenceKey& ids) const
+{
+    return m_deviceRegistry->validateSensorReading(deviceKey, reference, ids);
+}
 
-    return alarmIt != alarms.end();
+IngestionStatus Wolk::validateAlarm(const std::string& deviceKey, const std::string& reference,
+                                    PersistenceKey& ids) const
+{
+    return m_deviceRegistry->validateAlarm(deviceKey, reference, ids);
 }
 
-bool Wolk::actuatorDefinedForDevice(const std::string& deviceKey, const std::string& reference)
+IngestionStatus Wolk::logRejectedIngestion(IngestionStatus status, const std::string& deviceKey,
+                                           const std::string& reference)
 {
-    auto it = m_devices.find(deviceKey);
-    if (it == m_devices.end())
+    std::uint64_t suppressed = 0;
+    if (!m_ingestionErrorLog->tryAcquire(suppressed))
     {
-        return false;
+        return status;
     }
 
-    const auto actuators = it->second.getActuatorReferences();
-    auto actuatorIt = std::find(actuators.cbegin(), actuators.cend(), reference);
-
-    return actuatorIt != actuators.end();
-}
+    const char* reason = [&]() -> const char* {
+        switch (status)
+        {
+        case IngestionStatus::UNKNOWN_DEVICE:
+            return "Device does not exist";
+        case IngestionStatus::UNKNOWN_REFERENCE:
+            return "Reference does not exist for device";
+        case IngestionStatus::QUEUE_FULL:
+            return "Telemetry capacity reached";
+        default:
+            return "Rejected";
+        }
+    }();
 
-bool Wolk::configurationItemDefinedForDevice(const std::string& deviceKey, const std::string& reference)
-{
-    auto it = m_devices.find(deviceKey);
-    if (it == m_devices.end())
+    if (suppressed != 0)
     {
-        return false;
+        LOG(ERROR) << reason << ": " << deviceKey << ", " << reference << " (" << suppressed
+                   << " similar messages suppressed)";
+    }
+    else
+    {
+        LOG(ERROR) << reason << ": " << deviceKey << ", " << reference;
     }
 
-    const auto configurations = it->second.getTemplate().getConfigurations();
-    auto configurationIt =
-      std::find_if(configurations.cbegin(), configurations.cend(),
-                   [&](const ConfigurationTemplate& Template) { return Template.getReference() == reference; });
-
-    return configurationIt != configurations.end();
+    return status;
 }
 
 bool Wolk::validateAssetsToUpdate(const Device& device, const std::vector<ConfigurationTemplate>& configurations,
@@ -824,10 +1284,7 @@ void Wolk::handleRegistrationResponse(const std::string& deviceKey, PlatformResu
 
         if (result == PlatformResult::Code::OK)
         {
-            for (const auto& ref : getActuatorReferences(deviceKey))
-            {
-                publishActuatorStatus(deviceKey, ref);
-            }
+            refreshActuatorStatuses({deviceKey});
 
             publishConfiguration(deviceKey);
 
@@ -852,10 +1309,7 @@ void Wolk::handleUpdateResponse(const std::string& deviceKey, PlatformResult::Co
 
         if (result == PlatformResult::Code::OK)
         {
-            for (const auto& ref : getActuatorReferences(deviceKey))
-            {
-                publishActuatorStatus(deviceKey, ref);
-            }
+            refreshActuatorStatuses({deviceKey});
 
             publishConfiguration(deviceKey);
 
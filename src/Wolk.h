@@ -17,17 +17,27 @@
 #ifndef WOLK_H
 #define WOLK_H
 
-#include "ActuationHandlerPerDevice.h"
-#include "ActuatorStatusProviderPerDevice.h"
-#include "ConfigurationHandlerPerDevice.h"
-#include "ConfigurationProviderPerDevice.h"
+#include "AsyncActuationHandlerPerDevice.h"
+#include "AsyncActuatorStatusProviderPerDevice.h"
+#include "AsyncConfigurationHandlerPerDevice.h"
+#include "AsyncConfigurationProviderPerDevice.h"
+#include "AsyncDeviceStatusProvider.h"
 #include "WolkBuilder.h"
 #include "core/model/ActuatorStatus.h"
 #include "core/model/DeviceStatus.h"
 #include "core/model/PlatformResult.h"
-#include "core/utilities/CommandBuffer.h"
+#include "model/DeadbandFilter.h"
 #include "model/Device.h"
-
+#include "model/IngestionStatus.h"
+#include "model/PersistenceKey.h"
+#include "service/HandlerWatchdog.h"
+#include "utilities/MemoryPool.h"
+#include "utilities/PriorityCommandBuffer.h"
+#include "utilities/Tracer.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -36,15 +46,25 @@
 
 namespace wolkabout
 {
+class AsyncPublisher;
+class ConfigurationCache;
 class ConnectivityService;
 class DataService;
-class DeviceStatusService;
+class DeviceIoExecutor;
 class DeviceRegistrationService;
+class DeviceRegistry;
+class DeviceStatusService;
+class DrainScheduler;
 class FileDownloadService;
 class FirmwareUpdateService;
+class FlushScheduler;
 class InboundGatewayMessageHandler;
 class InboundMessageHandler;
 class JsonDFUProtocol;
+class LogRateLimiter;
+class SensorReadingAggregator;
+class SensorReadingFilter;
+class TaskTimer;
 
 class Wolk
 {
@@ -83,10 +103,11 @@ public:
      *               - const char*<br>
      * @param rtc Reading POSIX time - Number of seconds since 01/01/1970<br>
      *            If omitted current POSIX time is adopted
+     * @return IngestionStatus::ACCEPTED if reading is queued, filtered or aggregated
      */
     template <typename T>
-    void addSensorReading(const std::string& deviceKey, const std::string& reference, T value,
-                          unsigned long long int rtc = 0);
+    IngestionStatus addSensorReading(const std::string& deviceKey, const std::string& reference, T value,
+                                     unsigned long long int rtc = 0);
 
     /**
      * @brief Publishes multi-value sensor reading to WolkAbout IoT Cloud<br>
@@ -108,10 +129,11 @@ public:
      *               - const char*<br>
      * @param rtc Reading POSIX time - Number of seconds since 01/01/1970<br>
      *            If omitted current POSIX time is adopted
+     * @return IngestionStatus::ACCEPTED if reading is queued, filtered or aggregated
      */
     template <typename T>
-    void addSensorReading(const std::string& deviceKey, const std::string& reference, std::initializer_list<T> values,
-                          unsigned long long int rtc = 0);
+    IngestionStatus addSensorReading(const std::string& deviceKey, const std::string& reference,
+                                     std::initializer_list<T> values, unsigned long long int rtc = 0);
 
     /**
      * @brief Publishes multi-value sensor reading to WolkAbout IoT Cloud<br>
@@ -133,10 +155,11 @@ public:
      *               - const char*<br>
      * @param rtc Reading POSIX time - Number of seconds since 01/01/1970<br>
      *            If omitted current POSIX time is adopted
+     * @return IngestionStatus::ACCEPTED if reading is queued, filtered or aggregated
      */
     template <typename T>
-    void addSensorReading(const std::string& deviceKey, const std::string& reference, const std::vector<T> values,
-                          unsigned long long int rtc = 0);
+    IngestionStatus addSensorReading(const std::string& deviceKey, const std::string& reference,
+                                     const std::vector<T> values, unsigned long long int rtc = 0);
 
     /**
      * @brief Publishes alarm to WolkAbout IoT Cloud<br>
@@ -147,9 +170,10 @@ public:
      * @param active Is alarm active or not
      * @param rtc POSIX time at which event occurred - Number of seconds since
      * 01/01/1970<br> If omitted current POSIX time is adopted
+     * @return IngestionStatus::ACCEPTED if alarm is queued
      */
-    void addAlarm(const std::string& deviceKey, const std::string& reference, bool active,
-                  unsigned long long int rtc = 0);
+    IngestionStatus addAlarm(const std::string& deviceKey, const std::string& reference, bool active,
+                             unsigned long long int rtc = 0);
 
     /**
      * @brief Invokes ActuatorStatusProvider callback to obtain actuator
@@ -175,20 +199,29 @@ public:
     void addDeviceStatus(const std::string& deviceKey, DeviceStatus::Status status);
 
     /**
-     * @brief Invokes ConfigurationProvider to obtain device configuration, and the publishes it.<br>
+     * @brief Publishes device configuration, served from cache when available, otherwise obtained
+     *        from ConfigurationProvider.<br>
      *        This method is thread safe, and can be called from multiple thread simultaneously
      * * @param deviceKey key of the device that holds the configuration
      */
     void publishConfiguration(const std::string& deviceKey);
 
     /**
-     * @brief Invokes ConfigurationProvider to obtain device configuration, and the publishes it.<br>
+     * @brief Publishes given configuration items whose values changed since last published configuration.<br>
      *        This method is thread safe, and can be called from multiple thread simultaneously
      * * @param deviceKey key of the device that holds the configuration
      * * @param configurations values for each configuration reference of said device
      */
     void publishConfiguration(const std::string& deviceKey, std::vector<ConfigurationItem> configurations);
 
+    /**
+     * @brief Drops cached configuration of device, so next configuration publish reads it from ConfigurationProvider.
+     *        Should be called when device configuration is changed outside of Wolk.<br>
+     *        This method is thread safe, and can be called from multiple thread simultaneously
+     * @param deviceKey key of the device that holds the configuration
+     */
+    void invalidateConfiguration(const std::string& deviceKey);
+
     /**
      * @brief connect Establishes connection with WolkAbout IoT platform
      */
@@ -237,21 +270,119 @@ public:
      */
     void removeDevice(const std::string& deviceKey);
 
+    /**
+     * @brief Sets deadband filter for sensor of a single device<br>
+     *        Overrides filter set for the sensor reference with wolkabout::WolkBuilder<br>
+     *        This method is thread safe, and can be called from multiple thread simultaneously
+     * @param deviceKey key of the device that holds the sensor
+     * @param reference Sensor reference
+     * @param filter Deadband filter applied before reading is queued
+     */
+    void setSensorReadingFilter(const std::string& deviceKey, const std::string& reference,
+                                const DeadbandFilter& filter);
+
+    /**
+     * @brief Returns number of sensor readings accepted and suppressed by deadband filters
+     */
+    DeadbandFilterStatistics getSensorReadingFilterStatistics() const;
+
+    /**
+     * @brief Returns depth and wait time statistics of command lane<br>
+     *        Actuations, configuration, firmware and status requests are executed in CONTROL lane,
+     *        sensor readings and alarms in TELEMETRY lane
+     * @param lane Command lane
+     */
+    CommandLaneStatistics getCommandLaneStatistics(CommandLane lane) const;
+
+    /**
+     * @brief Returns statistics of pool from which sensor readings, alarms and actuator statuses are allocated<br>
+     *        Only objects and their control blocks come from the pool, values and references they hold are
+     *        still allocated on the heap
+     */
+    MemoryPoolStatistics getModelPoolStatistics() const;
+
+    /**
+     * @brief Returns durations of watched actuations, timed out actuations and quarantined devices.<br>
+     *        All values are 0 if actuation timeout is not set
+     */
+    HandlerWatchdogStatistics getHandlerWatchdogStatistics() const;
+
+    /**
+     * @brief Returns duration histogram of actuation round trip stage.<br>
+     *        All values are 0 if actuation tracing is not enabled
+     */
+    TraceStageStatistics getActuationTraceStatistics(TraceStage stage) const;
+
+    /**
+     * @brief Returns position of device in firmware install queue starting from 1,
+     *        0 if device is not waiting for firmware installation or firmware update is not enabled
+     */
+    std::size_t getFirmwareInstallQueuePosition(const std::string& deviceKey) const;
+
 private:
     class ConnectivityFacade;
 
     Wolk();
 
-    void addToCommandBuffer(std::function<void()> command);
+    bool addToCommandBuffer(std::function<void()> command, CommandLane lane = CommandLane::CONTROL,
+                            bool bypassCapacity = false);
+
+    /**
+     * Actuator statuses and configurations changed while commands already in the buffer are executed
+     * are published together, once those commands are done
+     */
+    void schedulePendingPublish();
 
     static unsigned long long int currentRtc();
 
+    /**
+     * @return false if any requested item is missing from configuration or has a different value
+     */
+    static bool isConfigurationApplied(const std::vector<ConfigurationItem>& requested,
+                                       const std::vector<ConfigurationItem>& configuration);
+
+    /**
+     * Reads statuses of all actuators of given devices, using bulk provider interface if available.
+     * Must be called from command buffer
+     */
+    void refreshActuatorStatuses(const std::vector<std::string>& deviceKeys);
+
     void handleActuatorSetCommand(const std::string& key, const std::string& reference, const std::string& value);
     void handleActuatorGetCommand(const std::string& key, const std::string& reference);
     void handleDeviceStatusRequest(const std::string& key);
     void handleConfigurationSetCommand(const std::string& key, const std::vector<ConfigurationItem>& configuration);
     void handleConfigurationGetCommand(const std::string& key);
 
+    /**
+     * Device I/O is delegated to asynchronous handler and provider variants. Completion callbacks are always
+     * executed in command buffer, once the handler or provider completes
+     */
+    void handleActuation(const std::string& deviceKey, const std::string& reference, const std::string& value,
+                         std::function<void()> onComplete);
+    void getActuatorStatus(const std::string& deviceKey, const std::string& reference,
+                           std::function<void(const ActuatorStatus&)> onStatus);
+    void getActuatorStatuses(
+      const std::map<std::string, std::vector<std::string>>& references,
+      std::function<void(const std::map<std::string, std::map<std::string, ActuatorStatus>>&)> onStatuses);
+    void getDeviceStatus(const std::string& deviceKey, std::function<void(DeviceStatus::Status)> onStatus);
+    void handleConfiguration(const std::string& deviceKey, const std::vector<ConfigurationItem>& configuration,
+                             std::function<void()> onComplete);
+    void getConfigurationFromDevice(const std::string& deviceKey,
+                                    std::function<void(const std::vector<ConfigurationItem>&)> onConfiguration);
+
+    /**
+     * Executes device I/O call on device I/O executor, so handlers that block do not hold command thread.
+     * Call that hangs on shutdown outlives this object, so calls capture handlers and command buffer by value
+     */
+    void executeDeviceIo(const std::string& deviceKey, std::function<void()> call);
+    void executeDeviceIo(const std::vector<std::string>& deviceKeys, std::function<void()> call);
+
+    std::uint64_t watchActuation(const std::string& deviceKey, const std::string& reference);
+    void handleActuationTimeout(const std::string& deviceKey, const std::string& reference);
+
+    void traceActuation(Tracer::TraceId trace, TraceStage stage);
+    void endActuationTrace(Tracer::TraceId trace);
+
     void registerDevices();
     void registerDevice(const Device& device);
     void updateDevice(std::string deviceKey, bool updateDefaultSemantics,
@@ -263,13 +394,18 @@ private:
 
     void publishDeviceStatuses();
 
-    std::vector<std::string> getDeviceKeys();
-    bool deviceExists(const std::string& deviceKey);
-    bool sensorDefinedForDevice(const std::string& deviceKey, const std::string& reference);
-    std::vector<std::string> getActuatorReferences(const std::string& deviceKey);
-    bool alarmDefinedForDevice(const std::string& deviceKey, const std::string& reference);
-    bool actuatorDefinedForDevice(const std::string& deviceKey, const std::string& reference);
-    bool configurationItemDefinedForDevice(const std::string& deviceKey, const std::string& reference);
+    std::vector<std::string> getDeviceKeys() const;
+    bool deviceExists(const std::string& deviceKey) const;
+    std::vector<std::string> getActuatorReferences(const std::string& deviceKey) const;
+    bool actuatorDefinedForDevice(const std::string& deviceKey, const std::string& reference) const;
+    bool configurationItemDefinedForDevice(const std::string& deviceKey, const std::string& reference) const;
+
+    IngestionStatus validateSensorReading(const std::string& deviceKey, const std::string& reference,
+                                          PersistenceKey& ids) const;
+    IngestionStatus validateAlarm(const std::string& deviceKey, const std::string& reference,
+                                  PersistenceKey& ids) const;
+    IngestionStatus logRejectedIngestion(IngestionStatus status, const std::string& deviceKey,
+                                         const std::string& reference);
 
     bool validateAssetsToUpdate(const Device& device, const std::vector<ConfigurationTemplate>& configurations,
                                 const std::vector<SensorTemplate>& sensors, const std::vector<AlarmTemplate>& alarms,
@@ -297,31 +433,74 @@ private:
     std::shared_ptr<ConnectivityFacade> m_connectivityManager;
 
     std::function<void(const std::string&, const std::string&, const std::string&)> m_actuationHandlerLambda;
-    std::shared_ptr<ActuationHandlerPerDevice> m_actuationHandler;
+    std::shared_ptr<AsyncActuationHandlerPerDevice> m_actuationHandler;
 
     std::function<ActuatorStatus(const std::string&, const std::string&)> m_actuatorStatusProviderLambda;
-    std::shared_ptr<ActuatorStatusProviderPerDevice> m_actuatorStatusProvider;
+    std::shared_ptr<AsyncActuatorStatusProviderPerDevice> m_actuatorStatusProvider;
 
     std::function<DeviceStatus::Status(const std::string&)> m_deviceStatusProviderLambda;
-    std::shared_ptr<DeviceStatusProvider> m_deviceStatusProvider;
+    std::shared_ptr<AsyncDeviceStatusProvider> m_deviceStatusProvider;
 
     std::function<void(const std::string&, const std::vector<ConfigurationItem>& configuration)>
       m_configurationHandlerLambda;
-    std::shared_ptr<ConfigurationHandlerPerDevice> m_configurationHandler;
+    std::shared_ptr<AsyncConfigurationHandlerPerDevice> m_configurationHandler;
 
     std::function<std::vector<ConfigurationItem>(const std::string&)> m_configurationProviderLambda;
-    std::shared_ptr<ConfigurationProviderPerDevice> m_configurationProvider;
+    std::shared_ptr<AsyncConfigurationProviderPerDevice> m_configurationProvider;
 
     std::shared_ptr<DataService> m_dataService;
     std::shared_ptr<DeviceStatusService> m_deviceStatusService;
     std::shared_ptr<DeviceRegistrationService> m_deviceRegistrationService;
     std::shared_ptr<FirmwareUpdateService> m_firmwareUpdateService;
 
-    std::map<std::string, Device> m_devices;
+    std::shared_ptr<AsyncPublisher> m_asyncPublisher;
+    std::unique_ptr<DrainScheduler> m_drainScheduler;
+    std::unique_ptr<FlushScheduler> m_flushScheduler;
+
+    std::unique_ptr<SensorReadingFilter> m_sensorReadingFilter;
+    std::unique_ptr<SensorReadingAggregator> m_sensorReadingAggregator;
+
+    std::unique_ptr<DeviceRegistry> m_deviceRegistry;
+
+    // write-through cache of last known device configuration, serves configuration gets and
+    // limits published configuration to changed items and items of set command
+    std::unique_ptr<ConfigurationCache> m_configurationCache;
+
+    // handler and provider calls, completions are passed back to command buffer
+    std::unique_ptr<DeviceIoExecutor> m_deviceIoExecutor;
+    static const constexpr std::size_t DEVICE_IO_WORKERS = 4;
+    static const constexpr std::size_t DEVICE_IO_MAX_PENDING_CALLS = 64;
+    static const std::chrono::milliseconds DEVICE_IO_SHUTDOWN_TIMEOUT;
+
+    // not set when actuation timeout is disabled
+    std::unique_ptr<HandlerWatchdog> m_handlerWatchdog;
+
+    // not set when actuation tracing is disabled
+    std::unique_ptr<Tracer> m_tracer;
+    struct PendingPublishTrace
+    {
+        Tracer::TraceId trace;
+        std::string deviceKey;
+        std::string reference;
+    };
+
+    // traces of actuator statuses waiting for pending publish, only accessed from command buffer
+    std::vector<PendingPublishTrace> m_pendingPublishTraces;
+
+    std::unique_ptr<LogRateLimiter> m_ingestionErrorLog;
+    static const constexpr double INGESTION_ERROR_LOG_RATE = 1;
+    static const constexpr double INGESTION_ERROR_LOG_BURST = 10;
 
     std::atomic_bool m_connected;
 
-    std::unique_ptr<CommandBuffer> m_commandBuffer;
+    // retries failed connect without holding command buffer
+    std::unique_ptr<TaskTimer> m_reconnectTimer;
+    static const std::chrono::milliseconds RECONNECT_DELAY;
+
+    bool m_pendingPublishScheduled;
+
+    // shared with device I/O completions, which may run after this object is destroyed
+    std::shared_ptr<PriorityCommandBuffer> m_commandBuffer;
 
     class ConnectivityFacade : public ConnectivityServiceListener
     {
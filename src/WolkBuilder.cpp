@@ -16,8 +16,8 @@
 
 #include "WolkBuilder.h"
 
-#include "ActuationHandlerPerDevice.h"
-#include "ActuatorStatusProviderPerDevice.h"
+#include "AsyncActuationHandlerPerDevice.h"
+#include "AsyncActuatorStatusProviderPerDevice.h"
 #include "Wolk.h"
 #include "core/InboundMessageHandler.h"
 #include "core/connectivity/ConnectivityService.h"
@@ -30,10 +30,19 @@
 #include "core/protocol/json/JsonRegistrationProtocol.h"
 #include "core/protocol/json/JsonStatusProtocol.h"
 #include "model/Device.h"
+#include "service/AsyncPublisher.h"
 #include "service/DataService.h"
+#include "service/DeviceIoExecutor.h"
 #include "service/DeviceRegistrationService.h"
+#include "service/DeviceRegistry.h"
 #include "service/DeviceStatusService.h"
+#include "service/DrainScheduler.h"
 #include "service/FirmwareUpdateService.h"
+#include "service/FlushScheduler.h"
+#include "service/HandlerWatchdog.h"
+#include "service/SensorReadingAggregator.h"
+#include "service/SensorReadingFilter.h"
+#include "utilities/Tracer.h"
 
 #include <functional>
 #include <stdexcept>
@@ -56,7 +65,7 @@ WolkBuilder& WolkBuilder::actuationHandler(
     return *this;
 }
 
-WolkBuilder& WolkBuilder::actuationHandler(std::shared_ptr<ActuationHandlerPerDevice> actuationHandler)
+WolkBuilder& WolkBuilder::actuationHandler(std::shared_ptr<AsyncActuationHandlerPerDevice> actuationHandler)
 {
     m_actuationHandler = std::move(actuationHandler);
     m_actuationHandlerLambda = nullptr;
@@ -72,7 +81,7 @@ WolkBuilder& WolkBuilder::actuatorStatusProvider(
 }
 
 WolkBuilder& WolkBuilder::actuatorStatusProvider(
-  std::shared_ptr<ActuatorStatusProviderPerDevice> actuatorStatusProvider)
+  std::shared_ptr<AsyncActuatorStatusProviderPerDevice> actuatorStatusProvider)
 {
     m_actuatorStatusProvider = std::move(actuatorStatusProvider);
     m_actuatorStatusProviderLambda = nullptr;
@@ -87,7 +96,8 @@ WolkBuilder& WolkBuilder::configurationHandler(
     return *this;
 }
 
-WolkBuilder& WolkBuilder::configurationHandler(std::shared_ptr<ConfigurationHandlerPerDevice> configurationHandler)
+WolkBuilder& WolkBuilder::configurationHandler(
+  std::shared_ptr<AsyncConfigurationHandlerPerDevice> configurationHandler)
 {
     m_configurationHandler = std::move(configurationHandler);
     m_configurationHandlerLambda = nullptr;
@@ -102,7 +112,8 @@ WolkBuilder& WolkBuilder::configurationProvider(
     return *this;
 }
 
-WolkBuilder& WolkBuilder::configurationProvider(std::shared_ptr<ConfigurationProviderPerDevice> configurationProvider)
+WolkBuilder& WolkBuilder::configurationProvider(
+  std::shared_ptr<AsyncConfigurationProviderPerDevice> configurationProvider)
 {
     m_configurationProvider = std::move(configurationProvider);
     m_configurationProviderLambda = nullptr;
@@ -117,7 +128,7 @@ WolkBuilder& WolkBuilder::deviceStatusProvider(
     return *this;
 }
 
-WolkBuilder& WolkBuilder::deviceStatusProvider(std::shared_ptr<DeviceStatusProvider> deviceStatusProvider)
+WolkBuilder& WolkBuilder::deviceStatusProvider(std::shared_ptr<AsyncDeviceStatusProvider> deviceStatusProvider)
 {
     m_deviceStatusProvider = std::move(deviceStatusProvider);
     m_deviceStatusProviderLambda = nullptr;
@@ -138,6 +149,22 @@ WolkBuilder& WolkBuilder::withFirmwareUpdate(std::shared_ptr<FirmwareInstaller>
     return *this;
 }
 
+WolkBuilder& WolkBuilder::withFirmwareInstallParallelism(
+  std::size_t maxParallelInstalls, std::size_t maxParallelInstallsPerGroup,
+  std::function<std::string(const std::string& deviceKey)> groupResolver)
+{
+    m_maxParallelFirmwareInstalls = maxParallelInstalls;
+    m_maxParallelFirmwareInstallsPerGroup = maxParallelInstallsPerGroup;
+    m_firmwareInstallGroupResolver = std::move(groupResolver);
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withFirmwareProgressInterval(std::chrono::milliseconds interval)
+{
+    m_firmwareProgressInterval = interval;
+    return *this;
+}
+
 WolkBuilder& WolkBuilder::withRegistrationResponseHandler(
   std::function<void(const std::string&, PlatformResult::Code)> registrationResponseHandler)
 {
@@ -145,6 +172,79 @@ WolkBuilder& WolkBuilder::withRegistrationResponseHandler(
     return *this;
 }
 
+WolkBuilder& WolkBuilder::withSensorReadingFilter(const std::string& reference, const DeadbandFilter& filter)
+{
+    m_sensorReadingFilters.erase(reference);
+    m_sensorReadingFilters.emplace(reference, filter);
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withSensorReadingAggregation(const std::string& reference, const AggregationWindow& window)
+{
+    m_aggregationWindows.erase(reference);
+    m_aggregationWindows.emplace(reference, window);
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withTelemetryAdmission(std::size_t capacity, AdmissionPolicy policy,
+                                                 std::chrono::milliseconds blockTimeout)
+{
+    m_telemetryCapacity = capacity;
+    m_telemetryAdmissionPolicy = policy;
+    m_telemetryBlockTimeout = blockTimeout;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withTelemetrySaturationHandler(std::function<void(bool)> saturationHandler)
+{
+    m_telemetrySaturationHandler = saturationHandler;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withPublishWindow(std::size_t windowSize)
+{
+    m_publishWindowSize = windowSize;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withPublishRateLimit(double messagesPerSecond, double bytesPerSecond)
+{
+    m_publishMessagesPerSecond = messagesPerSecond;
+    m_publishBytesPerSecond = bytesPerSecond;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withDevicePublishWeight(const std::string& deviceKey, unsigned int weight)
+{
+    m_devicePublishWeights[deviceKey] = weight;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withAutoPublish(const FlushPolicy& policy)
+{
+    m_flushPolicy = policy;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withActuationTimeout(std::chrono::milliseconds timeout)
+{
+    m_actuationTimeout = timeout;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withDeviceIoWorkers(std::size_t workers)
+{
+    m_deviceIoWorkers = workers;
+    return *this;
+}
+
+WolkBuilder& WolkBuilder::withActuationTracing(const std::string& exportPath)
+{
+    m_actuationTracing = true;
+    m_actuationTraceExportPath = exportPath;
+    return *this;
+}
+
 std::unique_ptr<Wolk> WolkBuilder::build()
 {
     if (!m_actuationHandlerLambda && !m_actuationHandler)
@@ -216,6 +316,30 @@ std::unique_ptr<Wolk> WolkBuilder::build()
     if (m_registrationResponseHandler)
         wolk->m_registrationResponseHandler = m_registrationResponseHandler;
 
+    for (const auto& kvp : m_sensorReadingFilters)
+    {
+        wolk->m_sensorReadingFilter->setFilter(kvp.first, kvp.second);
+    }
+
+    for (const auto& kvp : m_aggregationWindows)
+    {
+        wolk->m_sensorReadingAggregator->setWindow(kvp.first, kvp.second);
+    }
+
+    wolk->m_commandBuffer->setCapacity(CommandLane::TELEMETRY, m_telemetryCapacity, m_telemetryAdmissionPolicy,
+                                       m_telemetryBlockTimeout);
+
+    if (m_telemetrySaturationHandler)
+    {
+        const auto saturationHandler = m_telemetrySaturationHandler;
+        wolk->m_commandBuffer->setSaturationHandler([saturationHandler](CommandLane lane, bool saturated) {
+            if (lane == CommandLane::TELEMETRY)
+            {
+                saturationHandler(saturated);
+            }
+        });
+    }
+
     const auto rawPointer = wolk.get();
 
     wolk->m_dataService = std::make_shared<DataService>(
@@ -231,6 +355,65 @@ std::unique_ptr<Wolk> WolkBuilder::build()
       },
       [rawPointer](const std::string& key) { rawPointer->handleConfigurationGetCommand(key); });
 
+    wolk->m_deviceRegistry.reset(new DeviceRegistry(wolk->m_dataService->getDeviceKeyInterner(),
+                                                    wolk->m_dataService->getReferenceInterner()));
+
+    if (m_publishWindowSize != 0)
+    {
+        wolk->m_asyncPublisher = std::make_shared<AsyncPublisher>(*wolk->m_connectivityService, m_publishWindowSize);
+        wolk->m_dataService->setAsyncPublisher(wolk->m_asyncPublisher, [rawPointer](std::function<void()> completion) {
+            rawPointer->addToCommandBuffer(completion, CommandLane::TELEMETRY, true);
+        });
+    }
+
+    const auto dataService = wolk->m_dataService;
+    wolk->m_drainScheduler.reset(new DrainScheduler(
+      [dataService](const std::string& deviceKey) {
+          const auto size = dataService->publishBatch(deviceKey);
+          return DeviceBatchResult{size, size != 0 || dataService->hasPendingTelemetry(deviceKey)};
+      },
+      [dataService] { return dataService->isReadyToPublish(); },
+      [rawPointer](std::function<void()> step) { rawPointer->addToCommandBuffer(step, CommandLane::TELEMETRY, true); },
+      m_publishMessagesPerSecond, m_publishBytesPerSecond));
+
+    for (const auto& kvp : m_devicePublishWeights)
+    {
+        wolk->m_drainScheduler->setWeight(kvp.first, kvp.second);
+    }
+
+    if (m_flushPolicy.isEnabled())
+    {
+        wolk->m_flushScheduler.reset(new FlushScheduler(
+          m_flushPolicy,
+          [rawPointer] {
+              rawPointer->m_drainScheduler->drain(rawPointer->m_dataService->getDirtyTelemetryDeviceKeys());
+          },
+          [rawPointer](std::function<void()> flush) {
+              rawPointer->addToCommandBuffer(flush, CommandLane::TELEMETRY, true);
+          }));
+        wolk->m_flushScheduler->start();
+    }
+
+    wolk->m_deviceIoExecutor.reset(
+      new DeviceIoExecutor(m_deviceIoWorkers, Wolk::DEVICE_IO_MAX_PENDING_CALLS, Wolk::DEVICE_IO_SHUTDOWN_TIMEOUT));
+
+    if (m_actuationTimeout.count() > 0)
+    {
+        wolk->m_handlerWatchdog.reset(new HandlerWatchdog(
+          m_actuationTimeout,
+          [rawPointer](const std::string& key, const std::string& reference) {
+              rawPointer->handleActuationTimeout(key, reference);
+          },
+          [rawPointer](const std::string& key, bool quarantined) {
+              rawPointer->m_deviceIoExecutor->setQuarantined(key, quarantined);
+          }));
+    }
+
+    if (m_actuationTracing)
+    {
+        wolk->m_tracer.reset(new Tracer(m_actuationTraceExportPath));
+    }
+
     wolk->m_deviceStatusService = std::make_shared<DeviceStatusService>(
       *wolk->m_statusProtocol, *wolk->m_connectivityService,
       [rawPointer](const std::string& key) { rawPointer->handleDeviceStatusRequest(key); });
@@ -247,9 +430,12 @@ std::unique_ptr<Wolk> WolkBuilder::build()
     // Firmware update service
     if (m_firmwareInstaller != nullptr)
     {
-        wolk->m_firmwareUpdateService =
-          std::make_shared<FirmwareUpdateService>(*wolk->m_firmwareUpdateProtocol, m_firmwareInstaller,
-                                                  m_firmwareVersionProvider, *wolk->m_connectivityService);
+        std::unique_ptr<FirmwareInstallScheduler> installScheduler{new FirmwareInstallScheduler(
+          m_maxParallelFirmwareInstalls, m_maxParallelFirmwareInstallsPerGroup, m_firmwareInstallGroupResolver)};
+
+        wolk->m_firmwareUpdateService = std::make_shared<FirmwareUpdateService>(
+          *wolk->m_firmwareUpdateProtocol, m_firmwareInstaller, m_firmwareVersionProvider,
+          *wolk->m_connectivityService, std::move(installScheduler), m_firmwareProgressInterval);
 
         wolk->m_inboundMessageHandler->addListener(wolk->m_firmwareUpdateService);
     }
@@ -283,6 +469,19 @@ WolkBuilder::WolkBuilder()
 , m_persistence{new InMemoryPersistence()}
 , m_firmwareInstaller{nullptr}
 , m_firmwareVersionProvider{nullptr}
+, m_maxParallelFirmwareInstalls{0}
+, m_maxParallelFirmwareInstallsPerGroup{0}
+, m_firmwareInstallGroupResolver{nullptr}
+, m_firmwareProgressInterval{10000}
+, m_telemetryCapacity{0}
+, m_telemetryAdmissionPolicy{AdmissionPolicy::REJECT}
+, m_telemetryBlockTimeout{0}
+, m_publishWindowSize{0}
+, m_publishMessagesPerSecond{0}
+, m_publishBytesPerSecond{0}
+, m_actuationTimeout{0}
+, m_deviceIoWorkers{Wolk::DEVICE_IO_WORKERS}
+, m_actuationTracing{false}
 {
 }
 }    // namespace wolkabout
@@ -30,10 +30,16 @@
 #include "core/model/PlatformResult.h"
 #include "core/persistence/Persistence.h"
 #include "core/protocol/FirmwareUpdateProtocol.h"
+#include "model/AggregationWindow.h"
+#include "model/DeadbandFilter.h"
 #include "model/Device.h"
+#include "model/FlushPolicy.h"
+#include "utilities/PriorityCommandBuffer.h"
 
+#include <chrono>
 #include <cstdint>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 
@@ -77,11 +83,12 @@ public:
 
     /**
      * @brief Sets actuation handler
-     * @param actuationHandler Implementation that handles actuation requests
+     * @param actuationHandler Implementation that handles actuation requests, either
+     * wolkabout::ActuationHandlerPerDevice or wolkabout::AsyncActuationHandlerPerDevice
      * @return Reference to current wolkabout::WolkBuilder instance (Provides
      * fluent interface)
      */
-    WolkBuilder& actuationHandler(std::shared_ptr<ActuationHandlerPerDevice> actuationHandler);
+    WolkBuilder& actuationHandler(std::shared_ptr<AsyncActuationHandlerPerDevice> actuationHandler);
 
     /**
      * @brief Sets actuation status provider
@@ -96,11 +103,13 @@ public:
     /**
      * @brief Sets actuation status provider
      * @param actuatorStatusProvider Implementation that provides ActuatorStatus
-     * by reference of requested actuator
+     * by reference of requested actuator, either wolkabout::ActuatorStatusProviderPerDevice
+     * or wolkabout::AsyncActuatorStatusProviderPerDevice
      * @return Reference to current wolkabout::WolkBuilder instance (Provides
      * fluent interface)
      */
-    WolkBuilder& actuatorStatusProvider(std::shared_ptr<ActuatorStatusProviderPerDevice> actuatorStatusProvider);
+    WolkBuilder& actuatorStatusProvider(
+      std::shared_ptr<AsyncActuatorStatusProviderPerDevice> actuatorStatusProvider);
 
     /**
      * @brief Sets device configuration handler
@@ -113,10 +122,11 @@ public:
 
     /**
      * @brief Sets device configuration handler
-     * @param configurationHandler Instance of wolkabout::ConfigurationHandler that handles setting of configuration
+     * @param configurationHandler Instance of wolkabout::ConfigurationHandlerPerDevice or
+     *        wolkabout::AsyncConfigurationHandlerPerDevice that handles setting of configuration
      * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
      */
-    WolkBuilder& configurationHandler(std::shared_ptr<ConfigurationHandlerPerDevice> configurationHandler);
+    WolkBuilder& configurationHandler(std::shared_ptr<AsyncConfigurationHandlerPerDevice> configurationHandler);
 
     /**
      * @brief Sets device configuration provider
@@ -128,10 +138,12 @@ public:
 
     /**
      * @brief Sets device configuration provider
-     * @param configurationProvider Instance of wolkabout::ConfigurationProvider that provides device configuration
+     * @param configurationProvider Instance of wolkabout::ConfigurationProviderPerDevice or
+     *        wolkabout::AsyncConfigurationProviderPerDevice that provides device configuration
      * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
      */
-    WolkBuilder& configurationProvider(std::shared_ptr<ConfigurationProviderPerDevice> configurationProvider);
+    WolkBuilder& configurationProvider(
+      std::shared_ptr<AsyncConfigurationProviderPerDevice> configurationProvider);
 
     /**
      * @brief Sets device status provider
@@ -146,11 +158,11 @@ public:
     /**
      * @brief Sets device status provider
      * @param deviceStatusProvider Implementation that provides DeviceStatus
-     * by device key
+     * by device key, either wolkabout::DeviceStatusProvider or wolkabout::AsyncDeviceStatusProvider
      * @return Reference to current wolkabout::WolkBuilder instance (Provides
      * fluent interface)
      */
-    WolkBuilder& deviceStatusProvider(std::shared_ptr<DeviceStatusProvider> deviceStatusProvider);
+    WolkBuilder& deviceStatusProvider(std::shared_ptr<AsyncDeviceStatusProvider> deviceStatusProvider);
 
     /**
      * @brief Sets underlying persistence mechanism to be used<br>
@@ -179,6 +191,28 @@ public:
     WolkBuilder& withFirmwareUpdate(std::shared_ptr<FirmwareInstaller> installer,
                                     std::shared_ptr<FirmwareVersionProvider> provider);
 
+    /**
+     * @brief withFirmwareInstallParallelism Limits number of devices on which firmware is installed at the same time,
+     * in total and per group of devices sharing a bus. Remaining devices wait in queue until one of installations
+     * finishes. Queued devices are reported as INSTALLATION, their queue position is available with
+     * Wolk::getFirmwareInstallQueuePosition.
+     * @param maxParallelInstalls Maximum number of installations in progress, 0 for unlimited
+     * @param maxParallelInstallsPerGroup Maximum number of installations in progress within a group, 0 for unlimited
+     * @param groupResolver Returns group of device, every device is in the same group if not set
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withFirmwareInstallParallelism(
+      std::size_t maxParallelInstalls, std::size_t maxParallelInstallsPerGroup = 0,
+      std::function<std::string(const std::string& deviceKey)> groupResolver = nullptr);
+
+    /**
+     * @brief withFirmwareProgressInterval Sets minimum time between two installation progress publishes for a device.
+     * Progress reported by wolkabout::FirmwareInstaller in between is coalesced.
+     * @param interval Progress publish interval
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withFirmwareProgressInterval(std::chrono::milliseconds interval);
+
     /**
      * @brief withRegistrationResponseHandler Enables a callback function that is called when a subdevice is registered.
      * @param registrationResponseHandler The lambda expression called with the result.
@@ -187,6 +221,101 @@ public:
     WolkBuilder& withRegistrationResponseHandler(
       std::function<void(const std::string&, PlatformResult::Code)> registrationResponseHandler);
 
+    /**
+     * @brief withSensorReadingFilter Drops unchanged readings of a sensor before they are queued for publishing
+     * @param reference Reference of the sensor template, filter applies to every device having it
+     * @param filter Deadband and heartbeat settings
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withSensorReadingFilter(const std::string& reference, const DeadbandFilter& filter);
+
+    /**
+     * @brief withSensorReadingAggregation Publishes only min/max/mean/RMS of sensor readings over a window,
+     * instead of every reading. Aggregation is performed off the caller thread.
+     * @param reference Reference of the sensor template, aggregation applies to every device having it
+     * @param window Window size and output sensor for each aggregate
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withSensorReadingAggregation(const std::string& reference, const AggregationWindow& window);
+
+    /**
+     * @brief withTelemetryAdmission Bounds number of sensor readings and alarms waiting to be queued for publishing
+     * @param capacity Maximum number of waiting readings and alarms
+     * @param policy Applied when capacity is reached: wait for space, reject new or drop oldest reading
+     * @param blockTimeout Maximum time caller is blocked with AdmissionPolicy::BLOCK
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withTelemetryAdmission(std::size_t capacity, AdmissionPolicy policy,
+                                        std::chrono::milliseconds blockTimeout = std::chrono::milliseconds{0});
+
+    /**
+     * @brief withTelemetrySaturationHandler Enables a callback function that is called with true when telemetry
+     * capacity is reached, and with false once half of it is free again
+     * @param saturationHandler The lambda expression called with saturation state
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withTelemetrySaturationHandler(std::function<void(bool)> saturationHandler);
+
+    /**
+     * @brief withPublishWindow Publishes sensor readings and alarms without waiting for each batch to be
+     * acknowledged before sending the next one. Unacknowledged batches are published again after reconnect.
+     * @param windowSize Maximum number of batches in flight, 0 publishes one batch at a time on the calling thread
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withPublishWindow(std::size_t windowSize);
+
+    /**
+     * @brief withPublishRateLimit Limits rate at which persisted sensor readings and alarms are published.
+     * Devices are drained in rotation, one batch at a time, so a single device's backlog does not delay the others.
+     * @param messagesPerSecond Maximum number of published messages per second, 0 for unlimited
+     * @param bytesPerSecond Maximum number of published bytes per second, 0 for unlimited
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withPublishRateLimit(double messagesPerSecond, double bytesPerSecond = 0);
+
+    /**
+     * @brief withDevicePublishWeight Sets number of batches device publishes in each rotation, 1 by default
+     * @param deviceKey Device key
+     * @param weight Number of batches per rotation
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withDevicePublishWeight(const std::string& deviceKey, unsigned int weight);
+
+    /**
+     * @brief withAutoPublish Publishes sensor readings and alarms of devices that received new data,
+     * without calling wolkabout::Wolk::publish
+     * @param policy Interval, items count and size limits, publish is triggered by whichever is reached first
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withAutoPublish(const FlushPolicy& policy);
+
+    /**
+     * @brief withActuationTimeout Publishes actuator status with ERROR state when actuation handler and actuator
+     * status provider do not complete within timeout. Handlers and providers are called from device I/O threads,
+     * so a call that does not return only holds back later calls for the same device.
+     * @param timeout Actuation timeout, 0 disables the watchdog
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withActuationTimeout(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief withDeviceIoWorkers Sets number of threads calling handlers and providers. Calls of one device are
+     * made one at a time, so each device whose handler blocks holds one thread until devices that time out
+     * are quarantined.
+     * @param workers Number of device I/O threads, at least 1
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withDeviceIoWorkers(std::size_t workers);
+
+    /**
+     * @brief withActuationTracing Measures stages of actuation round trip, from arrival of actuation command
+     * until actuator status is published. Per stage histograms are available through
+     * wolkabout::Wolk::getActuationTraceStatistics
+     * @param exportPath File to which stages are written in Chrome trace format, nothing is written if empty
+     * @return Reference to current wolkabout::WolkBuilder instance (Provides fluent interface)
+     */
+    WolkBuilder& withActuationTracing(const std::string& exportPath = "");
+
     /**
      * @brief Builds Wolk instance
      * @return Wolk instance as std::unique_ptr<Wolk>
@@ -211,25 +340,51 @@ private:
     std::function<void(const std::string&, PlatformResult::Code)> m_registrationResponseHandler;
 
     std::function<void(const std::string&, const std::string&, const std::string&)> m_actuationHandlerLambda;
-    std::shared_ptr<ActuationHandlerPerDevice> m_actuationHandler;
+    std::shared_ptr<AsyncActuationHandlerPerDevice> m_actuationHandler;
 
     std::function<ActuatorStatus(const std::string&, const std::string&)> m_actuatorStatusProviderLambda;
-    std::shared_ptr<ActuatorStatusProviderPerDevice> m_actuatorStatusProvider;
+    std::shared_ptr<AsyncActuatorStatusProviderPerDevice> m_actuatorStatusProvider;
 
     std::function<void(const std::string&, const std::vector<ConfigurationItem>& configuration)>
       m_configurationHandlerLambda;
-    std::shared_ptr<ConfigurationHandlerPerDevice> m_configurationHandler;
+    std::shared_ptr<AsyncConfigurationHandlerPerDevice> m_configurationHandler;
 
     std::function<std::vector<ConfigurationItem>(const std::string&)> m_configurationProviderLambda;
-    std::shared_ptr<ConfigurationProviderPerDevice> m_configurationProvider;
+    std::shared_ptr<AsyncConfigurationProviderPerDevice> m_configurationProvider;
 
     std::function<DeviceStatus::Status(const std::string&)> m_deviceStatusProviderLambda;
-    std::shared_ptr<DeviceStatusProvider> m_deviceStatusProvider;
+    std::shared_ptr<AsyncDeviceStatusProvider> m_deviceStatusProvider;
 
     std::unique_ptr<Persistence> m_persistence;
 
     std::shared_ptr<FirmwareInstaller> m_firmwareInstaller;
     std::shared_ptr<FirmwareVersionProvider> m_firmwareVersionProvider;
+    std::size_t m_maxParallelFirmwareInstalls;
+    std::size_t m_maxParallelFirmwareInstallsPerGroup;
+    std::function<std::string(const std::string&)> m_firmwareInstallGroupResolver;
+    std::chrono::milliseconds m_firmwareProgressInterval;
+
+    std::map<std::string, DeadbandFilter> m_sensorReadingFilters;
+    std::map<std::string, AggregationWindow> m_aggregationWindows;
+
+    std::size_t m_telemetryCapacity;
+    AdmissionPolicy m_telemetryAdmissionPolicy;
+    std::chrono::milliseconds m_telemetryBlockTimeout;
+    std::function<void(bool)> m_telemetrySaturationHandler;
+
+    std::size_t m_publishWindowSize;
+
+    double m_publishMessagesPerSecond;
+    double m_publishBytesPerSecond;
+    std::map<std::string, unsigned int> m_devicePublishWeights;
+
+    FlushPolicy m_flushPolicy;
+
+    std::chrono::milliseconds m_actuationTimeout;
+    std::size_t m_deviceIoWorkers;
+
+    bool m_actuationTracing;
+    std::string m_actuationTraceExportPath;
 
     static const constexpr char* MESSAGE_BUS_HOST = "tcp://localhost:1883";
 };
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AGGREGATIONWINDOW_H
+#define AGGREGATIONWINDOW_H
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <utility>
+
+namespace wolkabout
+{
+/**
+ * @brief Describes how raw samples of a high-rate sensor are reduced before publishing.<br>
+ *        Window is closed once it holds 'samples' samples, or once it spans 'duration' (if set),
+ *        whichever comes first. Window with duration is also closed once duration elapses since its first sample
+ *        was added, even if no further samples arrive.
+ *        Each configured function is then published as a reading of its output sensor.
+ *        For multi-value sensors, functions are computed for each value separately.
+ */
+class AggregationWindow
+{
+public:
+    enum class Function
+    {
+        MIN,
+        MAX,
+        MEAN,
+        RMS
+    };
+
+    /**
+     * @param samples Maximum number of samples in a window
+     * @param outputs Reference of the sensor to which each function is published.<br>
+     *                Output sensors must be defined in device template, and must differ from aggregated sensor
+     * @param duration Maximum time span between first and last sample in a window, zero disables it
+     */
+    AggregationWindow(std::size_t samples, std::map<Function, std::string> outputs,
+                      std::chrono::milliseconds duration = std::chrono::milliseconds{0})
+    : m_samples{samples}, m_outputs{std::move(outputs)}, m_duration{duration}
+    {
+    }
+
+    std::size_t getSamples() const { return m_samples; }
+    const std::map<Function, std::string>& getOutputs() const { return m_outputs; }
+    std::chrono::milliseconds getDuration() const { return m_duration; }
+
+private:
+    std::size_t m_samples;
+    std::map<Function, std::string> m_outputs;
+    std::chrono::milliseconds m_duration;
+};
+}    // namespace wolkabout
+
+#endif    // AGGREGATIONWINDOW_H
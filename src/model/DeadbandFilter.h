@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEADBANDFILTER_H
+#define DEADBANDFILTER_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace wolkabout
+{
+/**
+ * @brief Describes when a sensor reading is considered unchanged and can be dropped before it is queued.<br>
+ *        Reading is dropped if every value differs from the last accepted value by no more than
+ *        max(absoluteDeadband, percentDeadband% of the last accepted value).<br>
+ *        Non numeric values are dropped only if they are equal to the last accepted value.
+ */
+class DeadbandFilter
+{
+public:
+    /**
+     * @param absoluteDeadband Absolute change that is treated as no change
+     * @param percentDeadband Change relative to the last accepted value, in percent, that is treated as no change
+     * @param maxSilence Reading is accepted regardless of deadband if the last accepted reading is older than this.
+     *                   Zero disables the heartbeat.
+     */
+    DeadbandFilter(double absoluteDeadband = 0, double percentDeadband = 0,
+                   std::chrono::milliseconds maxSilence = std::chrono::milliseconds{0})
+    : m_absoluteDeadband{absoluteDeadband}, m_percentDeadband{percentDeadband}, m_maxSilence{maxSilence}
+    {
+    }
+
+    double getAbsoluteDeadband() const { return m_absoluteDeadband; }
+    double getPercentDeadband() const { return m_percentDeadband; }
+    std::chrono::milliseconds getMaxSilence() const { return m_maxSilence; }
+
+private:
+    double m_absoluteDeadband;
+    double m_percentDeadband;
+    std::chrono::milliseconds m_maxSilence;
+};
+
+struct DeadbandFilterStatistics
+{
+    std::uint64_t accepted;
+    std::uint64_t suppressed;
+};
+}    // namespace wolkabout
+
+#endif    // DEADBANDFILTER_H
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLUSHPOLICY_H
+#define FLUSHPOLICY_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace wolkabout
+{
+/**
+ * @brief Describes when buffered sensor readings and alarms are published automatically.<br>
+ *        Publish is triggered by whichever limit is reached first, zero disables a limit.
+ */
+class FlushPolicy
+{
+public:
+    /**
+     * @param interval Maximum time between two publishes
+     * @param itemsCount Number of readings and alarms buffered since the last publish
+     * @param bytes Approximate size of readings and alarms buffered since the last publish
+     */
+    FlushPolicy(std::chrono::milliseconds interval = std::chrono::milliseconds{0}, std::size_t itemsCount = 0,
+                std::size_t bytes = 0)
+    : m_interval{interval}, m_itemsCount{itemsCount}, m_bytes{bytes}
+    {
+    }
+
+    std::chrono::milliseconds getInterval() const { return m_interval; }
+    std::size_t getItemsCount() const { return m_itemsCount; }
+    std::size_t getBytes() const { return m_bytes; }
+
+    bool isEnabled() const { return m_interval.count() != 0 || m_itemsCount != 0 || m_bytes != 0; }
+
+private:
+    std::chrono::milliseconds m_interval;
+    std::size_t m_itemsCount;
+    std::size_t m_bytes;
+};
+}    // namespace wolkabout
+
+#endif    // FLUSHPOLICY_H
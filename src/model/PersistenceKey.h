@@ -0,0 +1,45 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PERSISTENCEKEY_H
+#define PERSISTENCEKEY_H
+
+#include "utilities/StringInterner.h"
+
+#include <cstdint>
+
+namespace wolkabout
+{
+/**
+ * @brief Identifies data of a single device reference in persistence, by interned device key and reference
+ */
+struct PersistenceKey
+{
+    StringInterner::Id deviceKey;
+    StringInterner::Id reference;
+
+    std::uint64_t pack() const { return (static_cast<std::uint64_t>(deviceKey) << 32) | reference; }
+
+    bool operator==(const PersistenceKey& other) const
+    {
+        return deviceKey == other.deviceKey && reference == other.reference;
+    }
+
+    bool operator<(const PersistenceKey& other) const { return pack() < other.pack(); }
+};
+}    // namespace wolkabout
+
+#endif    // PERSISTENCEKEY_H
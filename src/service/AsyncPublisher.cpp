@@ -0,0 +1,136 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/AsyncPublisher.h"
+
+#include "core/connectivity/ConnectivityService.h"
+#include "core/model/Message.h"
+
+#include <utility>
+
+namespace wolkabout
+{
+AsyncPublisher::AsyncPublisher(ConnectivityService& connectivityService, std::size_t windowSize)
+: m_connectivityService{connectivityService}, m_windowSize{windowSize}, m_isRunning{true}, m_isSending{false}
+{
+    m_worker = std::thread(&AsyncPublisher::run, this);
+}
+
+AsyncPublisher::~AsyncPublisher()
+{
+    stop();
+}
+
+bool AsyncPublisher::publish(std::shared_ptr<Message> message, std::function<void(bool)> onCompleted)
+{
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        if (!m_isRunning || getInFlightCountUnlocked() >= m_windowSize)
+        {
+            return false;
+        }
+
+        m_pendingMessages.push_back(PendingMessage{std::move(message), std::move(onCompleted)});
+    }
+
+    m_condition.notify_one();
+    return true;
+}
+
+void AsyncPublisher::discardPending()
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+    m_pendingMessages.clear();
+}
+
+std::size_t AsyncPublisher::getWindowSize() const
+{
+    return m_windowSize;
+}
+
+std::size_t AsyncPublisher::getInFlightCount() const
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+    return getInFlightCountUnlocked();
+}
+
+void AsyncPublisher::stop()
+{
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_isRunning = false;
+    }
+
+    m_condition.notify_all();
+
+    if (m_worker.joinable())
+    {
+        m_worker.join();
+    }
+}
+
+std::size_t AsyncPublisher::getInFlightCountUnlocked() const
+{
+    return m_pendingMessages.size() + (m_isSending ? 1 : 0);
+}
+
+void AsyncPublisher::run()
+{
+    while (true)
+    {
+        PendingMessage pending;
+        {
+            std::unique_lock<std::mutex> lock{m_lock};
+            m_condition.wait(lock, [&] { return !m_isRunning || !m_pendingMessages.empty(); });
+
+            if (!m_isRunning)
+            {
+                return;
+            }
+
+            pending = std::move(m_pendingMessages.front());
+            m_pendingMessages.pop_front();
+            m_isSending = true;
+        }
+
+        const bool published = m_connectivityService.publish(pending.message);
+
+        std::deque<PendingMessage> failed;
+        {
+            std::lock_guard<std::mutex> lg{m_lock};
+            m_isSending = false;
+
+            if (!published)
+            {
+                failed.swap(m_pendingMessages);
+            }
+        }
+
+        if (pending.onCompleted)
+        {
+            pending.onCompleted(published);
+        }
+
+        for (const auto& message : failed)
+        {
+            if (message.onCompleted)
+            {
+                message.onCompleted(false);
+            }
+        }
+    }
+}
+}    // namespace wolkabout
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef ASYNCPUBLISHER_H
+#define ASYNCPUBLISHER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace wolkabout
+{
+class ConnectivityService;
+class Message;
+
+/**
+ * @brief Publishes messages without blocking the caller, keeping at most window size messages queued or in flight.<br>
+ *        Messages are sent one by one from a single publisher thread, in the order they were passed to publish,
+ *        so batches of the same device never overtake each other. Message is acknowledged when
+ *        ConnectivityService::publish returns; completion handler is called from the publisher thread with the
+ *        result.<br>
+ *        Once a publish fails, messages still queued are completed as not published without being sent, so that
+ *        a later message never reaches the broker ahead of a failed one.
+ */
+class AsyncPublisher
+{
+public:
+    AsyncPublisher(ConnectivityService& connectivityService, std::size_t windowSize);
+    ~AsyncPublisher();
+
+    /**
+     * @return false if window is full, or publisher is stopped
+     */
+    bool publish(std::shared_ptr<Message> message, std::function<void(bool)> onCompleted);
+
+    /**
+     * @brief Discards queued messages which were not sent yet, without calling their completion handlers.<br>
+     *        Message being sent at the moment is still completed
+     */
+    void discardPending();
+
+    std::size_t getWindowSize() const;
+    std::size_t getInFlightCount() const;
+
+    void stop();
+
+private:
+    struct PendingMessage
+    {
+        std::shared_ptr<Message> message;
+        std::function<void(bool)> onCompleted;
+    };
+
+    std::size_t getInFlightCountUnlocked() const;
+
+    void run();
+
+    ConnectivityService& m_connectivityService;
+    const std::size_t m_windowSize;
+
+    mutable std::mutex m_lock;
+    std::condition_variable m_condition;
+
+    bool m_isRunning;
+    bool m_isSending;
+    std::deque<PendingMessage> m_pendingMessages;
+
+    std::thread m_worker;
+};
+}    // namespace wolkabout
+
+#endif    // ASYNCPUBLISHER_H
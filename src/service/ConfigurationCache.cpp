@@ -0,0 +1,122 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/ConfigurationCache.h"
+
+#include <algorithm>
+
+namespace wolkabout
+{
+std::vector<ConfigurationItem> ConfigurationCache::diff(const std::string& deviceKey,
+                                                        const std::vector<ConfigurationItem>& configuration) const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    const auto it = m_configurations.find(deviceKey);
+    return diff(it != m_configurations.end() ? &it->second : nullptr, configuration);
+}
+
+std::vector<ConfigurationItem> ConfigurationCache::update(const std::string& deviceKey,
+                                                          const std::vector<ConfigurationItem>& configuration)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    auto& cached = m_configurations[deviceKey];
+    auto changed = diff(&cached, configuration);
+
+    for (const auto& item : changed)
+    {
+        cached[item.getReference()] = item.getValues();
+    }
+
+    return changed;
+}
+
+std::vector<ConfigurationItem> ConfigurationCache::update(const std::string& deviceKey,
+                                                          const std::vector<ConfigurationItem>& configuration,
+                                                          const std::vector<std::string>& references)
+{
+    const auto changed = update(deviceKey, configuration);
+
+    std::vector<ConfigurationItem> items;
+    for (const auto& item : configuration)
+    {
+        const auto& reference = item.getReference();
+        if (std::find(references.begin(), references.end(), reference) != references.end() ||
+            std::any_of(changed.begin(), changed.end(),
+                        [&](const ConfigurationItem& changedItem) { return changedItem.getReference() == reference; }))
+        {
+            items.push_back(item);
+        }
+    }
+
+    return items;
+}
+
+bool ConfigurationCache::get(const std::string& deviceKey, std::vector<ConfigurationItem>& configuration) const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    const auto it = m_configurations.find(deviceKey);
+    if (it == m_configurations.end())
+    {
+        return false;
+    }
+
+    configuration.clear();
+    for (const auto& kvp : it->second)
+    {
+        configuration.emplace_back(kvp.second, kvp.first);
+    }
+
+    return true;
+}
+
+void ConfigurationCache::invalidate(const std::string& deviceKey)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    m_configurations.erase(deviceKey);
+}
+
+void ConfigurationCache::invalidateAll()
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    m_configurations.clear();
+}
+
+std::vector<ConfigurationItem> ConfigurationCache::diff(const Values* cached,
+                                                        const std::vector<ConfigurationItem>& configuration)
+{
+    if (!cached)
+    {
+        return configuration;
+    }
+
+    std::vector<ConfigurationItem> changed;
+    for (const auto& item : configuration)
+    {
+        const auto it = cached->find(item.getReference());
+        if (it == cached->end() || it->second != item.getValues())
+        {
+            changed.push_back(item);
+        }
+    }
+
+    return changed;
+}
+}    // namespace wolkabout
@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CONFIGURATIONCACHE_H
+#define CONFIGURATIONCACHE_H
+
+#include "core/model/ConfigurationItem.h"
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wolkabout
+{
+/**
+ * @brief Holds last known configuration of each device, so configuration changes can be reduced to
+ *        items whose values actually differ.<br>
+ *        Device without cached configuration treats every item as changed.
+ */
+class ConfigurationCache
+{
+public:
+    /**
+     * @return Items that are not cached or whose values differ from cached ones
+     */
+    std::vector<ConfigurationItem> diff(const std::string& deviceKey,
+                                        const std::vector<ConfigurationItem>& configuration) const;
+
+    /**
+     * @brief Stores given items as last known values of device configuration
+     * @return Items that changed, as returned by diff
+     */
+    std::vector<ConfigurationItem> update(const std::string& deviceKey,
+                                          const std::vector<ConfigurationItem>& configuration);
+
+    /**
+     * @brief Stores given items as last known values of device configuration
+     * @param references References of items that are returned even if unchanged
+     * @return Items that changed or have one of given references, in order of given configuration
+     */
+    std::vector<ConfigurationItem> update(const std::string& deviceKey,
+                                          const std::vector<ConfigurationItem>& configuration,
+                                          const std::vector<std::string>& references);
+
+    /**
+     * @return false if configuration of device is not cached
+     */
+    bool get(const std::string& deviceKey, std::vector<ConfigurationItem>& configuration) const;
+
+    void invalidate(const std::string& deviceKey);
+    void invalidateAll();
+
+private:
+    typedef std::map<std::string, std::vector<std::string>> Values;
+
+    static std::vector<ConfigurationItem> diff(const Values* cached,
+                                               const std::vector<ConfigurationItem>& configuration);
+
+    mutable std::mutex m_lock;
+
+    // values by reference, by device key
+    std::map<std::string, Values> m_configurations;
+};
+}    // namespace wolkabout
+
+#endif    // CONFIGURATIONCACHE_H
@@ -19,20 +19,23 @@
 #include "core/connectivity/ConnectivityService.h"
 #include "core/model/ActuatorGetCommand.h"
 #include "core/model/ActuatorSetCommand.h"
+#include "core/model/Alarm.h"
 #include "core/model/ConfigurationSetCommand.h"
 #include "core/model/Message.h"
 #include "core/model/SensorReading.h"
 #include "core/persistence/Persistence.h"
 #include "core/protocol/DataProtocol.h"
 #include "core/utilities/Logger.h"
+#include "service/AsyncPublisher.h"
+#include "utilities/PoolAllocator.h"
+#include "utilities/Tracer.h"
 
 #include <algorithm>
 #include <cassert>
+#include <utility>
 
 namespace wolkabout
 {
-const std::string DataService::PERSISTENCE_KEY_DELIMITER = "+";
-
 DataService::DataService(DataProtocol& protocol, Persistence& persistence, ConnectivityService& connectivityService,
                          const ActuatorSetHandler& actuatorSetHandler, const ActuatorGetHandler& actuatorGetHandler,
                          const ConfigurationSetHandler& configurationSetHandler,
@@ -44,6 +47,13 @@ DataService::DataService(DataProtocol& protocol, Persistence& persistence, Conne
 , m_actuatorGetHandler{actuatorGetHandler}
 , m_configurationSetHandler{configurationSetHandler}
 , m_configurationGetHandler{configurationGetHandler}
+, m_deviceKeys{std::make_shared<StringInterner>()}
+, m_references{std::make_shared<StringInterner>()}
+, m_keyAdapter{*m_deviceKeys, *m_references}
+, m_modelPool{std::make_shared<MemoryPool>()}
+, m_dirtySensorReadingKeysLoaded{false}
+, m_dirtyAlarmKeysLoaded{false}
+, m_nextBatchSequence{0}
 {
 }
 
@@ -51,6 +61,11 @@ void DataService::messageReceived(std::shared_ptr<Message> message)
 {
     assert(message);
 
+    if (Tracer::isEnabled())
+    {
+        Tracer::markDispatched();
+    }
+
     const std::string deviceKey = m_protocol.extractDeviceKeyFromChannel(message->getChannel());
 
     if (m_protocol.isActuatorGetMessage(*message))
@@ -125,47 +140,133 @@ const Protocol& DataService::getProtocol()
 void DataService::addSensorReading(const std::string& deviceKey, const std::string& reference, const std::string& value,
                                    unsigned long long int rtc)
 {
-    auto sensorReading = std::make_shared<SensorReading>(value, reference, rtc);
-
-    m_persistence.putSensorReading(makePersistenceKey(deviceKey, reference), sensorReading);
+    const PersistenceKey key{m_keyAdapter.retainDevice(deviceKey), m_references->intern(reference)};
+    addSensorReading(key, value, rtc);
 }
 
 void DataService::addSensorReading(const std::string& deviceKey, const std::string& reference,
                                    const std::vector<std::string>& values, unsigned long long int rtc)
 {
-    auto sensorReading = std::make_shared<SensorReading>(values, reference, rtc);
-
-    auto key = makePersistenceKey(deviceKey, reference);
-
-    m_persistence.putSensorReading(key, sensorReading);
+    const PersistenceKey key{m_keyAdapter.retainDevice(deviceKey), m_references->intern(reference)};
+    addSensorReading(key, values, rtc);
 }
 
 void DataService::addAlarm(const std::string& deviceKey, const std::string& reference, bool active,
                            unsigned long long int rtc)
 {
-    auto alarm = std::make_shared<Alarm>(active, reference, rtc);
+    const PersistenceKey key{m_keyAdapter.retainDevice(deviceKey), m_references->intern(reference)};
+    addAlarm(key, active, rtc);
+}
 
-    m_persistence.putAlarm(makePersistenceKey(deviceKey, reference), alarm);
+void DataService::addSensorReading(const PersistenceKey& key, const std::string& value, unsigned long long int rtc)
+{
+    if (!m_keyAdapter.retainDevice(key.deviceKey))
+    {
+        LOG(DEBUG) << "Dropping sensor reading of removed device";
+        return;
+    }
+
+    auto sensorReading = std::allocate_shared<SensorReading>(PoolAllocator<SensorReading>(m_modelPool), value,
+                                                             m_references->resolve(key.reference), rtc);
+
+    const auto& persistanceKey = m_keyAdapter.encode(key);
+
+    m_persistence.putSensorReading(persistanceKey, sensorReading);
+    markDirty(BatchType::SENSOR_READINGS, key.deviceKey, persistanceKey);
+    m_dirtyTelemetryDevices.insert(key.deviceKey);
+}
+
+void DataService::addSensorReading(const PersistenceKey& key, const std::vector<std::string>& values,
+                                   unsigned long long int rtc)
+{
+    if (!m_keyAdapter.retainDevice(key.deviceKey))
+    {
+        LOG(DEBUG) << "Dropping sensor reading of removed device";
+        return;
+    }
+
+    auto sensorReading = std::allocate_shared<SensorReading>(PoolAllocator<SensorReading>(m_modelPool), values,
+                                                             m_references->resolve(key.reference), rtc);
+
+    const auto& persistanceKey = m_keyAdapter.encode(key);
+
+    m_persistence.putSensorReading(persistanceKey, sensorReading);
+    markDirty(BatchType::SENSOR_READINGS, key.deviceKey, persistanceKey);
+    m_dirtyTelemetryDevices.insert(key.deviceKey);
+}
+
+void DataService::addAlarm(const PersistenceKey& key, bool active, unsigned long long int rtc)
+{
+    if (!m_keyAdapter.retainDevice(key.deviceKey))
+    {
+        LOG(DEBUG) << "Dropping alarm of removed device";
+        return;
+    }
+
+    auto alarm = std::allocate_shared<Alarm>(PoolAllocator<Alarm>(m_modelPool), active,
+                                             m_references->resolve(key.reference), rtc);
+
+    const auto& persistanceKey = m_keyAdapter.encode(key);
+
+    m_persistence.putAlarm(persistanceKey, alarm);
+    markDirty(BatchType::ALARMS, key.deviceKey, persistanceKey);
+    m_dirtyTelemetryDevices.insert(key.deviceKey);
+}
+
+std::shared_ptr<StringInterner> DataService::getDeviceKeyInterner() const
+{
+    return m_deviceKeys;
+}
+
+std::shared_ptr<StringInterner> DataService::getReferenceInterner() const
+{
+    return m_references;
 }
 
 void DataService::addActuatorStatus(const std::string& deviceKey, const std::string& reference,
                                     const std::string& value, ActuatorStatus::State state)
 {
-    auto actuatorStatusWithRef = std::make_shared<ActuatorStatus>(value, reference, state);
+    auto actuatorStatusWithRef =
+      std::allocate_shared<ActuatorStatus>(PoolAllocator<ActuatorStatus>(m_modelPool), value, reference, state);
 
-    m_persistence.putActuatorStatus(makePersistenceKey(deviceKey, reference), actuatorStatusWithRef);
+    const auto key = makePersistenceKey(deviceKey, reference);
+
+    m_persistence.putActuatorStatus(key, actuatorStatusWithRef);
+    m_pendingActuatorStatusKeys.insert(key);
 }
 
 void DataService::addConfiguration(const std::string& deviceKey, const std::vector<ConfigurationItem>& configuration)
 {
     auto conf = std::make_shared<std::vector<ConfigurationItem>>(configuration);
 
+    // configuration may hold only changed items, keep items of configuration that is not yet published
+    if (const auto pending = m_persistence.getConfiguration(deviceKey))
+    {
+        for (const auto& item : *pending)
+        {
+            const auto it = std::find_if(conf->begin(), conf->end(), [&](const ConfigurationItem& added) {
+                return added.getReference() == item.getReference();
+            });
+
+            if (it == conf->end())
+            {
+                conf->push_back(item);
+            }
+        }
+    }
+
     m_persistence.putConfiguration(deviceKey, conf);
+    m_pendingConfigurationKeys.insert(deviceKey);
+}
+
+MemoryPoolStatistics DataService::getModelPoolStatistics() const
+{
+    return m_modelPool->getStatistics();
 }
 
 void DataService::publishSensorReadings()
 {
-    for (const auto& key : m_persistence.getSensorReadingsKeys())
+    for (const auto& key : getDirtyKeys(BatchType::SENSOR_READINGS))
     {
         publishSensorReadingsForPersistanceKey(key);
     }
@@ -173,54 +274,66 @@ void DataService::publishSensorReadings()
 
 void DataService::publishSensorReadings(const std::string& deviceKey)
 {
-    const auto& readingskeys = m_persistence.getSensorReadingsKeys();
-
-    const std::vector<std::string> matchingReadingsKeys = findMatchingPersistanceKeys(deviceKey, readingskeys);
-
-    for (const std::string& matchingKey : matchingReadingsKeys)
+    for (const std::string& matchingKey : getDirtyKeys(BatchType::SENSOR_READINGS, deviceKey))
     {
         publishSensorReadingsForPersistanceKey(matchingKey);
     }
 }
 
 void DataService::publishSensorReadingsForPersistanceKey(const std::string& persistanceKey)
+{
+    if (m_asyncPublisher)
+    {
+        publishInWindow(BatchType::SENSOR_READINGS, persistanceKey);
+        return;
+    }
+
+    // proceed to publish next batch only if publish is successfull
+    while (publishSensorReadingsBatch(persistanceKey))
+    {
+    }
+}
+
+std::shared_ptr<Message> DataService::publishSensorReadingsBatch(const std::string& persistanceKey)
 {
     const auto sensorReadings = m_persistence.getSensorReadings(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
 
     if (sensorReadings.empty())
     {
-        return;
+        markClean(BatchType::SENSOR_READINGS, persistanceKey);
+        return nullptr;
     }
 
-    auto pair = parsePersistenceKey(persistanceKey);
-    if (pair.first.empty() || pair.second.empty())
+    PersistenceKey key;
+    if (!parsePersistenceKey(persistanceKey, key))
     {
         LOG(ERROR) << "Unable to parse persistence key: " << persistanceKey;
         m_persistence.removeSensorReadings(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
-        return;
+        return nullptr;
     }
 
-    const std::shared_ptr<Message> outboundMessage = m_protocol.makeMessage(pair.first, sensorReadings);
+    const std::shared_ptr<Message> outboundMessage =
+      m_protocol.makeMessage(m_deviceKeys->resolve(key.deviceKey), sensorReadings);
 
     if (!outboundMessage)
     {
         LOG(ERROR) << "Unable to create message from readings: " << persistanceKey;
         m_persistence.removeSensorReadings(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
-        return;
+        return nullptr;
     }
 
-    if (m_connectivityService.publish(outboundMessage))
+    if (!m_connectivityService.publish(outboundMessage))
     {
-        m_persistence.removeSensorReadings(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
-
-        // proceed to publish next batch only if publish is successfull
-        publishSensorReadingsForPersistanceKey(persistanceKey);
+        return nullptr;
     }
+
+    m_persistence.removeSensorReadings(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
+    return outboundMessage;
 }
 
 void DataService::publishAlarms()
 {
-    for (const auto& key : m_persistence.getAlarmsKeys())
+    for (const auto& key : getDirtyKeys(BatchType::ALARMS))
     {
         publishAlarmsForPersistanceKey(key);
     }
@@ -228,49 +341,61 @@ void DataService::publishAlarms()
 
 void DataService::publishAlarms(const std::string& deviceKey)
 {
-    const auto& alarmsKeys = m_persistence.getAlarmsKeys();
-
-    const std::vector<std::string> matchingAlarmsKeys = findMatchingPersistanceKeys(deviceKey, alarmsKeys);
-
-    for (const std::string& matchingKey : matchingAlarmsKeys)
+    for (const std::string& matchingKey : getDirtyKeys(BatchType::ALARMS, deviceKey))
     {
         publishAlarmsForPersistanceKey(matchingKey);
     }
 }
 
 void DataService::publishAlarmsForPersistanceKey(const std::string& persistanceKey)
+{
+    if (m_asyncPublisher)
+    {
+        publishInWindow(BatchType::ALARMS, persistanceKey);
+        return;
+    }
+
+    // proceed to publish next batch only if publish is successfull
+    while (publishAlarmsBatch(persistanceKey))
+    {
+    }
+}
+
+std::shared_ptr<Message> DataService::publishAlarmsBatch(const std::string& persistanceKey)
 {
     const auto alarms = m_persistence.getAlarms(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
 
     if (alarms.empty())
     {
-        return;
+        markClean(BatchType::ALARMS, persistanceKey);
+        return nullptr;
     }
 
-    auto pair = parsePersistenceKey(persistanceKey);
-    if (pair.first.empty() || pair.second.empty())
+    PersistenceKey key;
+    if (!parsePersistenceKey(persistanceKey, key))
     {
         LOG(ERROR) << "Unable to parse persistence key: " << persistanceKey;
         m_persistence.removeAlarms(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
-        return;
+        return nullptr;
     }
 
-    const std::shared_ptr<Message> outboundMessage = m_protocol.makeMessage(pair.first, alarms);
+    const std::shared_ptr<Message> outboundMessage =
+      m_protocol.makeMessage(m_deviceKeys->resolve(key.deviceKey), alarms);
 
     if (!outboundMessage)
     {
         LOG(ERROR) << "Unable to create message from alarms: " << persistanceKey;
         m_persistence.removeAlarms(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
-        return;
+        return nullptr;
     }
 
-    if (m_connectivityService.publish(outboundMessage))
+    if (!m_connectivityService.publish(outboundMessage))
     {
-        m_persistence.removeAlarms(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
-
-        // proceed to publish next batch only if publish is successfull
-        publishAlarmsForPersistanceKey(persistanceKey);
+        return nullptr;
     }
+
+    m_persistence.removeAlarms(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
+    return outboundMessage;
 }
 
 void DataService::publishActuatorStatuses()
@@ -302,15 +427,16 @@ void DataService::publishActuatorStatusesForPersistanceKey(const std::string& pe
         return;
     }
 
-    auto pair = parsePersistenceKey(persistanceKey);
-    if (pair.first.empty() || pair.second.empty())
+    PersistenceKey key;
+    if (!parsePersistenceKey(persistanceKey, key))
     {
         LOG(ERROR) << "Unable to parse persistence key: " << persistanceKey;
         m_persistence.removeActuatorStatus(persistanceKey);
         return;
     }
 
-    const std::shared_ptr<Message> outboundMessage = m_protocol.makeMessage(pair.first, {actuatorStatus});
+    const std::shared_ptr<Message> outboundMessage =
+      m_protocol.makeMessage(m_deviceKeys->resolve(key.deviceKey), {actuatorStatus});
 
     if (!outboundMessage)
     {
@@ -325,6 +451,58 @@ void DataService::publishActuatorStatusesForPersistanceKey(const std::string& pe
     }
 }
 
+std::vector<std::string> DataService::publishActuatorStatusesForPersistanceKeys(
+  const std::string& deviceKey, const std::vector<std::string>& persistanceKeys)
+{
+    std::vector<std::string> publishedReferences;
+
+    std::vector<std::shared_ptr<ActuatorStatus>> actuatorStatuses;
+    std::vector<std::string> actuatorStatusesKeys;
+
+    for (const auto& key : persistanceKeys)
+    {
+        const auto actuatorStatus = m_persistence.getActuatorStatus(key);
+        if (actuatorStatus)
+        {
+            actuatorStatuses.push_back(actuatorStatus);
+            actuatorStatusesKeys.push_back(key);
+        }
+    }
+
+    for (std::size_t begin = 0; begin < actuatorStatuses.size(); begin += PUBLISH_BATCH_ITEMS_COUNT)
+    {
+        const std::size_t end = std::min<std::size_t>(begin + PUBLISH_BATCH_ITEMS_COUNT, actuatorStatuses.size());
+
+        const std::vector<std::shared_ptr<ActuatorStatus>> batch(actuatorStatuses.begin() + begin,
+                                                                 actuatorStatuses.begin() + end);
+
+        const std::shared_ptr<Message> outboundMessage = m_protocol.makeMessage(deviceKey, batch);
+
+        if (!outboundMessage)
+        {
+            LOG(ERROR) << "Unable to create message from actuator statuses of device: " << deviceKey;
+        }
+        else if (m_connectivityService.publish(outboundMessage))
+        {
+            for (const auto& actuatorStatus : batch)
+            {
+                publishedReferences.push_back(actuatorStatus->getReference());
+            }
+        }
+        else
+        {
+            continue;
+        }
+
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            m_persistence.removeActuatorStatus(actuatorStatusesKeys[i]);
+        }
+    }
+
+    return publishedReferences;
+}
+
 void DataService::publishConfiguration()
 {
     for (const auto& key : m_persistence.getConfigurationKeys())
@@ -362,34 +540,511 @@ void DataService::publishConfigurationForPersistanceKey(const std::string& persi
     }
 }
 
+std::map<std::string, std::vector<std::string>> DataService::publishPendingActuatorStatuses()
+{
+    std::set<std::string> keys;
+    keys.swap(m_pendingActuatorStatusKeys);
+
+    std::map<std::string, std::vector<std::string>> keysByDevice;
+    for (const auto& key : keys)
+    {
+        PersistenceKey parsedKey;
+        if (!parsePersistenceKey(key, parsedKey))
+        {
+            LOG(ERROR) << "Unable to parse persistence key: " << key;
+            m_persistence.removeActuatorStatus(key);
+            continue;
+        }
+
+        keysByDevice[m_deviceKeys->resolve(parsedKey.deviceKey)].push_back(key);
+    }
+
+    std::map<std::string, std::vector<std::string>> publishedReferences;
+    for (const auto& kvp : keysByDevice)
+    {
+        auto references = publishActuatorStatusesForPersistanceKeys(kvp.first, kvp.second);
+        if (!references.empty())
+        {
+            publishedReferences[kvp.first] = std::move(references);
+        }
+    }
+
+    return publishedReferences;
+}
+
+void DataService::publishPendingConfigurations()
+{
+    std::set<std::string> keys;
+    keys.swap(m_pendingConfigurationKeys);
+
+    for (const auto& key : keys)
+    {
+        publishConfigurationForPersistanceKey(key);
+    }
+}
+
+void DataService::setAsyncPublisher(std::shared_ptr<AsyncPublisher> publisher,
+                                    std::function<void(std::function<void()>)> completionExecutor)
+{
+    m_asyncPublisher = publisher;
+    m_completionExecutor = completionExecutor;
+}
+
+void DataService::resetInFlight()
+{
+    if (m_asyncPublisher)
+    {
+        // batches not sent yet are replayed from persistence, sending them as well would publish them twice
+        m_asyncPublisher->discardPending();
+    }
+
+    m_inFlightSensorReadings.clear();
+    m_inFlightAlarms.clear();
+    m_awaitingWindow.clear();
+    m_drainingKeys.clear();
+}
+
+bool DataService::isReadyToPublish() const
+{
+    return !m_asyncPublisher || m_asyncPublisher->getInFlightCount() < m_asyncPublisher->getWindowSize();
+}
+
+std::vector<std::string> DataService::getTelemetryDeviceKeys()
+{
+    std::set<std::string> deviceKeys;
+
+    for (const auto type : {BatchType::ALARMS, BatchType::SENSOR_READINGS})
+    {
+        for (const auto& kvp : getDirtyKeysByDevice(type))
+        {
+            deviceKeys.insert(m_deviceKeys->resolve(kvp.first));
+        }
+    }
+
+    return std::vector<std::string>(deviceKeys.begin(), deviceKeys.end());
+}
+
+std::vector<std::string> DataService::getDirtyTelemetryDeviceKeys() const
+{
+    std::vector<std::string> deviceKeys;
+    for (const auto deviceKey : m_dirtyTelemetryDevices)
+    {
+        deviceKeys.push_back(m_deviceKeys->resolve(deviceKey));
+    }
+
+    return deviceKeys;
+}
+
+bool DataService::hasPendingTelemetry(const std::string& deviceKey)
+{
+    StringInterner::Id deviceId;
+    if (!m_deviceKeys->find(deviceKey, deviceId))
+    {
+        return false;
+    }
+
+    return getDirtyKeysByDevice(BatchType::ALARMS).count(deviceId) != 0 ||
+           getDirtyKeysByDevice(BatchType::SENSOR_READINGS).count(deviceId) != 0;
+}
+
+std::size_t DataService::publishBatch(const std::string& deviceKey)
+{
+    for (const auto& key : getDirtyKeys(BatchType::ALARMS, deviceKey))
+    {
+        const auto message = m_asyncPublisher ? publishBatchInWindow(BatchType::ALARMS, key) : publishAlarmsBatch(key);
+        if (message)
+        {
+            return getMessageSize(*message);
+        }
+    }
+
+    for (const auto& key : getDirtyKeys(BatchType::SENSOR_READINGS, deviceKey))
+    {
+        const auto message =
+          m_asyncPublisher ? publishBatchInWindow(BatchType::SENSOR_READINGS, key) : publishSensorReadingsBatch(key);
+        if (message)
+        {
+            return getMessageSize(*message);
+        }
+    }
+
+    StringInterner::Id deviceId;
+    if (m_deviceKeys->find(deviceKey, deviceId) && getDirtyKeysByDevice(BatchType::ALARMS).count(deviceId) == 0 &&
+        getDirtyKeysByDevice(BatchType::SENSOR_READINGS).count(deviceId) == 0)
+    {
+        m_dirtyTelemetryDevices.erase(deviceId);
+        releaseRemovedDevice(deviceId);
+    }
+
+    return 0;
+}
+
+void DataService::removeDevice(const std::string& deviceKey)
+{
+    StringInterner::Id deviceId;
+    if (!m_deviceKeys->find(deviceKey, deviceId))
+    {
+        return;
+    }
+
+    m_removedDevices.insert(deviceId);
+
+    if (getDirtyKeysByDevice(BatchType::ALARMS).count(deviceId) == 0 &&
+        getDirtyKeysByDevice(BatchType::SENSOR_READINGS).count(deviceId) == 0)
+    {
+        m_dirtyTelemetryDevices.erase(deviceId);
+        releaseRemovedDevice(deviceId);
+    }
+}
+
+void DataService::releaseRemovedDevice(StringInterner::Id deviceKey)
+{
+    if (m_removedDevices.erase(deviceKey) == 0)
+    {
+        return;
+    }
+
+    m_keyAdapter.removeDevice(deviceKey);
+}
+
+void DataService::publishInWindow(BatchType type, const std::string& persistanceKey)
+{
+    const auto drainingKey = std::make_pair(type, persistanceKey);
+    m_drainingKeys.insert(drainingKey);
+
+    while (true)
+    {
+        if (!isReadyToPublish())
+        {
+            if (std::find(m_awaitingWindow.begin(), m_awaitingWindow.end(), drainingKey) == m_awaitingWindow.end())
+            {
+                m_awaitingWindow.push_back(drainingKey);
+            }
+            return;
+        }
+
+        if (!publishBatchInWindow(type, persistanceKey))
+        {
+            // keep draining after batches still in flight are acknowledged
+            if (getInFlightBatches(type).count(persistanceKey) == 0)
+            {
+                m_drainingKeys.erase(drainingKey);
+            }
+            return;
+        }
+    }
+}
+
+std::shared_ptr<Message> DataService::publishBatchInWindow(BatchType type, const std::string& persistanceKey)
+{
+    PersistenceKey key;
+    if (!parsePersistenceKey(persistanceKey, key))
+    {
+        LOG(ERROR) << "Unable to parse persistence key: " << persistanceKey;
+        removeBatchItems(type, persistanceKey, PUBLISH_BATCH_ITEMS_COUNT);
+        return nullptr;
+    }
+
+    if (!isReadyToPublish())
+    {
+        return nullptr;
+    }
+
+    auto& inFlight = getInFlightBatches(type);
+    auto& batches = inFlight[persistanceKey];
+
+    std::size_t offset = 0;
+    for (const auto& batch : batches)
+    {
+        offset += batch.itemsCount;
+    }
+
+    Batch batch = makeBatch(type, persistanceKey, m_deviceKeys->resolve(key.deviceKey), offset);
+    while (batch.itemsCount != 0 && !batch.message)
+    {
+        LOG(ERROR) << "Unable to create message from batch: " << persistanceKey;
+        if (!batches.empty())
+        {
+            // items can be removed only from the front, retry once batches in flight are acknowledged
+            return nullptr;
+        }
+
+        removeBatchItems(type, persistanceKey, batch.itemsCount);
+        batch = makeBatch(type, persistanceKey, m_deviceKeys->resolve(key.deviceKey), offset);
+    }
+
+    if (batch.itemsCount == 0)
+    {
+        if (batches.empty())
+        {
+            inFlight.erase(persistanceKey);
+            markClean(type, persistanceKey);
+        }
+        return nullptr;
+    }
+
+    const std::uint64_t sequence = m_nextBatchSequence++;
+    batches.push_back(InFlightBatch{sequence, batch.itemsCount, false});
+
+    const auto executor = m_completionExecutor;
+    const bool accepted = m_asyncPublisher->publish(batch.message, [=](bool published) {
+        executor([=] { batchPublished(type, persistanceKey, sequence, published); });
+    });
+
+    if (!accepted)
+    {
+        batches.pop_back();
+        return nullptr;
+    }
+
+    return batch.message;
+}
+
+void DataService::batchPublished(BatchType type, const std::string& persistanceKey, std::uint64_t sequence,
+                                 bool published)
+{
+    auto& inFlight = getInFlightBatches(type);
+
+    auto it = inFlight.find(persistanceKey);
+    if (it == inFlight.end())
+    {
+        // batches were reset in the meantime
+        return;
+    }
+
+    auto& batches = it->second;
+    auto batchIt = std::find_if(batches.begin(), batches.end(),
+                                [&](const InFlightBatch& batch) { return batch.sequence == sequence; });
+    if (batchIt == batches.end())
+    {
+        return;
+    }
+
+    if (!published)
+    {
+        // remaining items stay in persistence and are replayed with the next publish
+        LOG(WARN) << "Batch not acknowledged, dropping batches in flight for: " << persistanceKey;
+        inFlight.erase(it);
+        m_drainingKeys.erase(std::make_pair(type, persistanceKey));
+        return;
+    }
+
+    batchIt->acknowledged = true;
+    while (!batches.empty() && batches.front().acknowledged)
+    {
+        removeBatchItems(type, persistanceKey, batches.front().itemsCount);
+        batches.pop_front();
+    }
+
+    const auto drainingKey = std::make_pair(type, persistanceKey);
+    if (m_drainingKeys.count(drainingKey) != 0 &&
+        std::find(m_awaitingWindow.begin(), m_awaitingWindow.end(), drainingKey) == m_awaitingWindow.end())
+    {
+        m_awaitingWindow.push_back(drainingKey);
+    }
+
+    publishAwaitingWindow();
+}
+
+void DataService::publishAwaitingWindow()
+{
+    while (!m_awaitingWindow.empty() && isReadyToPublish())
+    {
+        const auto awaiting = m_awaitingWindow.front();
+        m_awaitingWindow.pop_front();
+
+        publishInWindow(awaiting.first, awaiting.second);
+    }
+}
+
+DataService::Batch DataService::makeBatch(BatchType type, const std::string& persistanceKey,
+                                          const std::string& deviceKey, std::size_t offset)
+{
+    if (type == BatchType::SENSOR_READINGS)
+    {
+        const auto sensorReadings = m_persistence.getSensorReadings(persistanceKey, offset + PUBLISH_BATCH_ITEMS_COUNT);
+        if (sensorReadings.size() <= offset)
+        {
+            return Batch{nullptr, 0};
+        }
+
+        const std::vector<std::shared_ptr<SensorReading>> batch(sensorReadings.begin() + offset, sensorReadings.end());
+        return Batch{m_protocol.makeMessage(deviceKey, batch), batch.size()};
+    }
+
+    const auto alarms = m_persistence.getAlarms(persistanceKey, offset + PUBLISH_BATCH_ITEMS_COUNT);
+    if (alarms.size() <= offset)
+    {
+        return Batch{nullptr, 0};
+    }
+
+    const std::vector<std::shared_ptr<Alarm>> batch(alarms.begin() + offset, alarms.end());
+    return Batch{m_protocol.makeMessage(deviceKey, batch), batch.size()};
+}
+
+void DataService::removeBatchItems(BatchType type, const std::string& persistanceKey, std::size_t count)
+{
+    if (type == BatchType::SENSOR_READINGS)
+    {
+        m_persistence.removeSensorReadings(persistanceKey, count);
+    }
+    else
+    {
+        m_persistence.removeAlarms(persistanceKey, count);
+    }
+}
+
+std::map<std::string, std::deque<DataService::InFlightBatch>>& DataService::getInFlightBatches(BatchType type)
+{
+    return type == BatchType::SENSOR_READINGS ? m_inFlightSensorReadings : m_inFlightAlarms;
+}
+
+void DataService::markDirty(BatchType type, StringInterner::Id deviceKey, const std::string& persistanceKey)
+{
+    getDirtyKeysByDevice(type)[deviceKey].insert(persistanceKey);
+}
+
+void DataService::markClean(BatchType type, const std::string& persistanceKey)
+{
+    PersistenceKey key;
+    if (!parsePersistenceKey(persistanceKey, key))
+    {
+        return;
+    }
+
+    auto& dirtyKeys = getDirtyKeysByDevice(type);
+
+    const auto it = dirtyKeys.find(key.deviceKey);
+    if (it == dirtyKeys.end())
+    {
+        return;
+    }
+
+    it->second.erase(persistanceKey);
+    if (it->second.empty())
+    {
+        dirtyKeys.erase(it);
+    }
+}
+
+std::vector<std::string> DataService::getDirtyKeys(BatchType type)
+{
+    std::vector<std::string> keys;
+    for (const auto& kvp : getDirtyKeysByDevice(type))
+    {
+        keys.insert(keys.end(), kvp.second.begin(), kvp.second.end());
+    }
+
+    return keys;
+}
+
+std::vector<std::string> DataService::getDirtyKeys(BatchType type, const std::string& deviceKey)
+{
+    const auto& dirtyKeys = getDirtyKeysByDevice(type);
+
+    StringInterner::Id deviceId;
+    if (!m_deviceKeys->find(deviceKey, deviceId))
+    {
+        return {};
+    }
+
+    const auto it = dirtyKeys.find(deviceId);
+    if (it == dirtyKeys.end())
+    {
+        return {};
+    }
+
+    return std::vector<std::string>(it->second.begin(), it->second.end());
+}
+
+std::map<StringInterner::Id, std::set<std::string>>& DataService::getDirtyKeysByDevice(BatchType type)
+{
+    // data persisted before this instance was created is found with a single scan of persistence keys
+    if (type == BatchType::SENSOR_READINGS)
+    {
+        if (!m_dirtySensorReadingKeysLoaded)
+        {
+            m_dirtySensorReadingKeysLoaded = true;
+            loadDirtyKeys(type, m_persistence.getSensorReadingsKeys(), m_dirtySensorReadingKeys);
+        }
+
+        return m_dirtySensorReadingKeys;
+    }
+
+    if (!m_dirtyAlarmKeysLoaded)
+    {
+        m_dirtyAlarmKeysLoaded = true;
+        loadDirtyKeys(type, m_persistence.getAlarmsKeys(), m_dirtyAlarmKeys);
+    }
+
+    return m_dirtyAlarmKeys;
+}
+
+std::size_t DataService::getMessageSize(const Message& message)
+{
+    return std::max<std::size_t>(message.getChannel().size() + message.getContent().size(), 1);
+}
+
 std::string DataService::makePersistenceKey(const std::string& deviceKey, const std::string& reference) const
 {
-    return deviceKey + PERSISTENCE_KEY_DELIMITER + reference;
+    return PersistenceKeyAdapter::encode(deviceKey, reference);
 }
 
-std::pair<std::string, std::string> DataService::parsePersistenceKey(const std::string& key) const
+bool DataService::parsePersistenceKey(const std::string& key, PersistenceKey& result)
 {
-    auto pos = key.find(PERSISTENCE_KEY_DELIMITER);
-    if (pos == std::string::npos)
+    return m_keyAdapter.decode(key, result);
+}
+
+void DataService::loadDirtyKeys(BatchType type, const std::vector<std::string>& persistanceKeys,
+                                std::map<StringInterner::Id, std::set<std::string>>& dirtyKeys)
+{
+    for (const auto& persistanceKey : persistanceKeys)
     {
-        return std::make_pair("", "");
+        PersistenceKey key;
+        if (parsePersistenceKey(persistanceKey, key))
+        {
+            dirtyKeys[key.deviceKey].insert(persistanceKey);
+            continue;
+        }
+
+        // data under unparsable key has no device to be published for, it would otherwise stay persisted forever
+        LOG(ERROR) << "Unable to parse persistence key, discarding its data: " << persistanceKey;
+        discardBatchItems(type, persistanceKey);
     }
+}
 
-    auto deviceKey = key.substr(0, pos);
-    auto reference = key.substr(pos + PERSISTENCE_KEY_DELIMITER.size(), std::string::npos);
+void DataService::discardBatchItems(BatchType type, const std::string& persistanceKey)
+{
+    while (true)
+    {
+        std::size_t count = 0;
+        if (type == BatchType::SENSOR_READINGS)
+        {
+            count = m_persistence.getSensorReadings(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT).size();
+        }
+        else
+        {
+            count = m_persistence.getAlarms(persistanceKey, PUBLISH_BATCH_ITEMS_COUNT).size();
+        }
 
-    return std::make_pair(deviceKey, reference);
+        if (count == 0)
+        {
+            return;
+        }
+
+        removeBatchItems(type, persistanceKey, count);
+    }
 }
 
 std::vector<std::string> DataService::findMatchingPersistanceKeys(const std::string& deviceKey,
-                                                                  const std::vector<std::string>& persistanceKeys) const
+                                                                  const std::vector<std::string>& persistanceKeys)
 {
     std::vector<std::string> matchingKeys;
 
     for (const auto& key : persistanceKeys)
     {
-        auto pair = parsePersistenceKey(key);
-        if (pair.first == deviceKey)
+        PersistenceKey parsedKey;
+        if (parsePersistenceKey(key, parsedKey) && m_deviceKeys->resolve(parsedKey.deviceKey) == deviceKey)
         {
             matchingKeys.push_back(key);
         }
@@ -20,15 +20,22 @@
 #include "core/InboundMessageHandler.h"
 #include "core/model/ActuatorStatus.h"
 #include "core/model/ConfigurationItem.h"
+#include "service/PersistenceKeyAdapter.h"
+#include "utilities/MemoryPool.h"
+#include "utilities/StringInterner.h"
 
+#include <cstdint>
+#include <deque>
 #include <functional>
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
 namespace wolkabout
 {
+class AsyncPublisher;
 class DataProtocol;
 class Persistence;
 class ConnectivityService;
@@ -58,11 +65,37 @@ public:
 
     void addAlarm(const std::string& deviceKey, const std::string& reference, bool active, unsigned long long int rtc);
 
+    /**
+     * @brief Adds sensor reading of device key and reference interned in interners of this service<br>
+     *        Reading is dropped if device key was freed, as device was removed meanwhile
+     */
+    void addSensorReading(const PersistenceKey& key, const std::string& value, unsigned long long int rtc);
+    void addSensorReading(const PersistenceKey& key, const std::vector<std::string>& values,
+                          unsigned long long int rtc);
+    void addAlarm(const PersistenceKey& key, bool active, unsigned long long int rtc);
+
+    /**
+     * @brief Interners for device keys and references, shared with wolkabout::DeviceRegistry so that ids are
+     *        resolved when data is added instead of on this service's thread
+     */
+    std::shared_ptr<StringInterner> getDeviceKeyInterner() const;
+    std::shared_ptr<StringInterner> getReferenceInterner() const;
+
     void addActuatorStatus(const std::string& deviceKey, const std::string& reference, const std::string& value,
                            ActuatorStatus::State state);
 
+    /**
+     * @brief Items are merged into configuration of device that is not yet published, given items take precedence
+     */
     void addConfiguration(const std::string& deviceKey, const std::vector<ConfigurationItem>& configuration);
 
+    /**
+     * @brief Returns statistics of pool from which sensor readings, alarms and actuator statuses are allocated<br>
+     *        Only objects and their control blocks come from the pool, values and references they hold are
+     *        still allocated on the heap
+     */
+    MemoryPoolStatistics getModelPoolStatistics() const;
+
     void publishSensorReadings();
     void publishSensorReadings(const std::string& deviceKey);
 
@@ -75,17 +108,124 @@ public:
     void publishConfiguration();
     void publishConfiguration(const std::string& deviceKey);
 
+    /**
+     * @brief Publishes only actuator statuses added since the last call, without scanning persistence keys<br>
+     *        Statuses of the same device are packed into as few messages as possible
+     * @return References of actuator statuses that were published, by device key
+     */
+    std::map<std::string, std::vector<std::string>> publishPendingActuatorStatuses();
+
+    /**
+     * @brief Publishes only configurations added since the last call, without scanning persistence keys
+     */
+    void publishPendingConfigurations();
+
+    /**
+     * @brief Publishes sensor readings and alarms through asynchronous publisher, keeping up to window size batches
+     *        in flight. Batch is removed from persistence once acknowledged, in the order batches were taken.<br>
+     *        Completion of each batch is passed to completionExecutor, which must run it on the thread using
+     *        this DataService
+     */
+    void setAsyncPublisher(std::shared_ptr<AsyncPublisher> publisher,
+                           std::function<void(std::function<void()>)> completionExecutor);
+
+    /**
+     * @brief Forgets batches in flight without removing them from persistence, so they are published again.<br>
+     *        Batches waiting in asynchronous publisher are discarded
+     */
+    void resetInFlight();
+
+    /**
+     * @brief Returns false while the window of batches in flight is full
+     */
+    bool isReadyToPublish() const;
+
+    /**
+     * @brief Returns keys of devices having persisted alarms or sensor readings<br>
+     *        Data persisted under keys which cannot be parsed has no device to be published for, and is discarded
+     */
+    std::vector<std::string> getTelemetryDeviceKeys();
+
+    /**
+     * @brief Returns keys of devices that received sensor readings or alarms which are not published yet<br>
+     *        Device is cleared by publishBatch once it has nothing left to publish, so failed publish is retried
+     */
+    std::vector<std::string> getDirtyTelemetryDeviceKeys() const;
+
+    /**
+     * @brief Returns true while device has persisted alarms or sensor readings which are not published yet
+     */
+    bool hasPendingTelemetry(const std::string& deviceKey);
+
+    /**
+     * @brief Publishes a single batch of device's alarms, or if there are none, of its sensor readings
+     * @return Size of published message in bytes, 0 if there is nothing to publish or batch was not published
+     */
+    std::size_t publishBatch(const std::string& deviceKey);
+
+    /**
+     * @brief Frees interned device key once device has no telemetry left to publish
+     */
+    void removeDevice(const std::string& deviceKey);
+
 private:
+    enum class BatchType
+    {
+        SENSOR_READINGS,
+        ALARMS
+    };
+
+    struct Batch
+    {
+        std::shared_ptr<Message> message;
+        std::size_t itemsCount;
+    };
+
+    struct InFlightBatch
+    {
+        std::uint64_t sequence;
+        std::size_t itemsCount;
+        bool acknowledged;
+    };
+
+    void releaseRemovedDevice(StringInterner::Id deviceKey);
+
     std::string makePersistenceKey(const std::string& deviceKey, const std::string& reference) const;
-    std::pair<std::string, std::string> parsePersistenceKey(const std::string& key) const;
+    bool parsePersistenceKey(const std::string& key, PersistenceKey& result);
     std::vector<std::string> findMatchingPersistanceKeys(const std::string& deviceKey,
-                                                         const std::vector<std::string>& persistanceKeys) const;
+                                                         const std::vector<std::string>& persistanceKeys);
 
     void publishSensorReadingsForPersistanceKey(const std::string& persistanceKey);
+    std::shared_ptr<Message> publishSensorReadingsBatch(const std::string& persistanceKey);
     void publishAlarmsForPersistanceKey(const std::string& persistanceKey);
+    std::shared_ptr<Message> publishAlarmsBatch(const std::string& persistanceKey);
     void publishActuatorStatusesForPersistanceKey(const std::string& persistanceKey);
+    std::vector<std::string> publishActuatorStatusesForPersistanceKeys(const std::string& deviceKey,
+                                                                       const std::vector<std::string>& persistanceKeys);
     void publishConfigurationForPersistanceKey(const std::string& persistanceKey);
 
+    void publishInWindow(BatchType type, const std::string& persistanceKey);
+    std::shared_ptr<Message> publishBatchInWindow(BatchType type, const std::string& persistanceKey);
+    void batchPublished(BatchType type, const std::string& persistanceKey, std::uint64_t sequence, bool published);
+    void publishAwaitingWindow();
+
+    Batch makeBatch(BatchType type, const std::string& persistanceKey, const std::string& deviceKey,
+                    std::size_t offset);
+    void removeBatchItems(BatchType type, const std::string& persistanceKey, std::size_t count);
+    std::map<std::string, std::deque<InFlightBatch>>& getInFlightBatches(BatchType type);
+
+    void markDirty(BatchType type, StringInterner::Id deviceKey, const std::string& persistanceKey);
+    void markClean(BatchType type, const std::string& persistanceKey);
+    std::vector<std::string> getDirtyKeys(BatchType type);
+    std::vector<std::string> getDirtyKeys(BatchType type, const std::string& deviceKey);
+    std::map<StringInterner::Id, std::set<std::string>>& getDirtyKeysByDevice(BatchType type);
+    void loadDirtyKeys(BatchType type, const std::vector<std::string>& persistanceKeys,
+                       std::map<StringInterner::Id, std::set<std::string>>& dirtyKeys);
+    void discardBatchItems(BatchType type, const std::string& persistanceKey);
+
+
+    static std::size_t getMessageSize(const Message& message);
+
     DataProtocol& m_protocol;
     Persistence& m_persistence;
     ConnectivityService& m_connectivityService;
@@ -96,7 +236,34 @@ private:
     ConfigurationSetHandler m_configurationSetHandler;
     ConfigurationGetHandler m_configurationGetHandler;
 
-    static const std::string PERSISTENCE_KEY_DELIMITER;
+    std::set<std::string> m_pendingActuatorStatusKeys;
+    std::set<std::string> m_pendingConfigurationKeys;
+
+    // references are bounded by device templates, device keys are released once removed device is drained
+    std::shared_ptr<StringInterner> m_deviceKeys;
+    std::shared_ptr<StringInterner> m_references;
+    PersistenceKeyAdapter m_keyAdapter;
+    std::set<StringInterner::Id> m_removedDevices;
+
+    std::shared_ptr<MemoryPool> m_modelPool;
+
+    std::set<StringInterner::Id> m_dirtyTelemetryDevices;
+
+    // persistence keys that may hold data, grouped by device key
+    std::map<StringInterner::Id, std::set<std::string>> m_dirtySensorReadingKeys;
+    std::map<StringInterner::Id, std::set<std::string>> m_dirtyAlarmKeys;
+    bool m_dirtySensorReadingKeysLoaded;
+    bool m_dirtyAlarmKeysLoaded;
+
+    std::shared_ptr<AsyncPublisher> m_asyncPublisher;
+    std::function<void(std::function<void()>)> m_completionExecutor;
+
+    std::map<std::string, std::deque<InFlightBatch>> m_inFlightSensorReadings;
+    std::map<std::string, std::deque<InFlightBatch>> m_inFlightAlarms;
+    std::deque<std::pair<BatchType, std::string>> m_awaitingWindow;
+    std::set<std::pair<BatchType, std::string>> m_drainingKeys;
+    std::uint64_t m_nextBatchSequence;
+
     static const constexpr unsigned int PUBLISH_BATCH_ITEMS_COUNT = 50;
 };
 }    // namespace wolkabout
@@ -0,0 +1,312 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/DeviceIoExecutor.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace wolkabout
+{
+DeviceIoExecutor::DeviceIoExecutor(std::size_t workers, std::size_t maxPendingCalls,
+                                   std::chrono::milliseconds shutdownTimeout)
+: m_shutdownTimeout{shutdownTimeout}, m_state{std::make_shared<State>()}
+{
+    std::lock_guard<std::mutex> lg{m_state->lock};
+
+    m_state->workers = std::max<std::size_t>(workers, 1);
+    m_state->maxPendingCalls = maxPendingCalls;
+    m_state->isShutdown = false;
+    m_state->pendingCount = 0;
+    m_state->runningWorkers = m_state->workers;
+    m_state->quarantinedWorkers = 0;
+
+    for (std::size_t i = 0; i < m_state->workers; ++i)
+    {
+        m_state->threads.emplace_back(&DeviceIoExecutor::work, m_state);
+    }
+}
+
+DeviceIoExecutor::~DeviceIoExecutor()
+{
+    std::vector<std::thread> threads;
+    bool isStopped = false;
+
+    {
+        std::unique_lock<std::mutex> lock{m_state->lock};
+        m_state->isShutdown = true;
+        m_state->calls.clear();
+        m_state->readyCalls.clear();
+        m_state->pendingCount = 0;
+
+        m_state->condition.notify_all();
+
+        isStopped = m_state->workerStopped.wait_for(lock, m_shutdownTimeout,
+                                                    [&] { return m_state->runningWorkers == 0; });
+        threads.swap(m_state->threads);
+    }
+
+    for (auto& thread : threads)
+    {
+        if (isStopped)
+        {
+            thread.join();
+        }
+        else
+        {
+            // call that does not return keeps its worker, which holds only the shared state
+            thread.detach();
+        }
+    }
+}
+
+bool DeviceIoExecutor::execute(const std::string& deviceKey, std::function<void()> call)
+{
+    return execute(std::vector<std::string>{deviceKey}, std::move(call));
+}
+
+bool DeviceIoExecutor::execute(const std::vector<std::string>& deviceKeys, std::function<void()> call)
+{
+    const std::set<std::string> uniqueDeviceKeys(deviceKeys.begin(), deviceKeys.end());
+
+    std::lock_guard<std::mutex> lg{m_state->lock};
+    if (m_state->isShutdown)
+    {
+        return false;
+    }
+
+    for (const auto& deviceKey : uniqueDeviceKeys)
+    {
+        const auto it = m_state->calls.find(deviceKey);
+        if (it == m_state->calls.end() || m_state->maxPendingCalls == 0)
+        {
+            continue;
+        }
+
+        const std::size_t pending = it->second.size() - (it->second.front()->isRunning ? 1 : 0);
+        if (pending >= m_state->maxPendingCalls)
+        {
+            return false;
+        }
+    }
+
+    auto entry = std::make_shared<Call>(
+      Call{std::move(call), std::vector<std::string>(uniqueDeviceKeys.begin(), uniqueDeviceKeys.end()), 0, false,
+           false});
+    ++m_state->pendingCount;
+
+    if (entry->deviceKeys.empty())
+    {
+        m_state->readyCalls.push_back(entry);
+        m_state->condition.notify_one();
+        return true;
+    }
+
+    for (const auto& deviceKey : entry->deviceKeys)
+    {
+        auto& calls = m_state->calls[deviceKey];
+        calls.push_back(entry);
+
+        // call becomes first in order of device once calls added before it are done
+        if (calls.size() == 1)
+        {
+            deviceReady(*m_state, entry);
+        }
+    }
+
+    return true;
+}
+
+void DeviceIoExecutor::setQuarantined(const std::string& deviceKey, bool quarantined)
+{
+    std::lock_guard<std::mutex> lg{m_state->lock};
+    if (m_state->isShutdown)
+    {
+        return;
+    }
+
+    if (!quarantined)
+    {
+        m_state->quarantinedDevices.erase(deviceKey);
+        return;
+    }
+
+    if (!m_state->quarantinedDevices.insert(deviceKey).second)
+    {
+        return;
+    }
+
+    const auto it = m_state->calls.find(deviceKey);
+    if (it != m_state->calls.end() && it->second.front()->isRunning && !it->second.front()->isQuarantined)
+    {
+        quarantineWorker(m_state, *it->second.front());
+    }
+}
+
+std::size_t DeviceIoExecutor::getPendingCount() const
+{
+    std::lock_guard<std::mutex> lg{m_state->lock};
+
+    return m_state->pendingCount;
+}
+
+std::size_t DeviceIoExecutor::getWorkerCount() const
+{
+    std::lock_guard<std::mutex> lg{m_state->lock};
+
+    return m_state->runningWorkers;
+}
+
+void DeviceIoExecutor::work(std::shared_ptr<State> state)
+{
+    std::unique_lock<std::mutex> lock{state->lock};
+
+    while (true)
+    {
+        std::shared_ptr<Call> call;
+        while (!state->isShutdown && !(call = takeReadyCall(*state)))
+        {
+            state->condition.wait(lock);
+        }
+
+        if (state->isShutdown)
+        {
+            stopWorker(*state);
+            return;
+        }
+
+        --state->pendingCount;
+        call->isRunning = true;
+
+        if (isQuarantined(*state, *call))
+        {
+            state->quarantinedCall = call;
+            quarantineWorker(state, *call);
+        }
+
+        lock.unlock();
+        call->call();
+        call->call = nullptr;
+        lock.lock();
+
+        if (state->isShutdown)
+        {
+            stopWorker(*state);
+            return;
+        }
+
+        if (state->quarantinedCall == call)
+        {
+            // next call of quarantined devices may be waiting for this one
+            state->quarantinedCall = nullptr;
+            state->condition.notify_one();
+        }
+
+        callDone(*state, *call);
+
+        if (call->isQuarantined)
+        {
+            --state->quarantinedWorkers;
+
+            // replacement took over, worker that ran quarantined call is no longer needed
+            if (state->runningWorkers - state->quarantinedWorkers > state->workers)
+            {
+                const auto self = std::find_if(state->threads.begin(), state->threads.end(), [](const std::thread& t) {
+                    return t.get_id() == std::this_thread::get_id();
+                });
+
+                if (self != state->threads.end())
+                {
+                    self->detach();
+                    state->threads.erase(self);
+                }
+
+                stopWorker(*state);
+                return;
+            }
+        }
+    }
+}
+
+std::shared_ptr<DeviceIoExecutor::Call> DeviceIoExecutor::takeReadyCall(State& state)
+{
+    for (auto it = state.readyCalls.begin(); it != state.readyCalls.end(); ++it)
+    {
+        if (!state.quarantinedCall || !isQuarantined(state, **it))
+        {
+            const auto call = *it;
+            state.readyCalls.erase(it);
+            return call;
+        }
+    }
+
+    return nullptr;
+}
+
+bool DeviceIoExecutor::isQuarantined(const State& state, const Call& call)
+{
+    return std::any_of(call.deviceKeys.begin(), call.deviceKeys.end(), [&](const std::string& deviceKey) {
+        return state.quarantinedDevices.find(deviceKey) != state.quarantinedDevices.end();
+    });
+}
+
+void DeviceIoExecutor::deviceReady(State& state, const std::shared_ptr<Call>& call)
+{
+    if (++call->readyDevices == call->deviceKeys.size())
+    {
+        state.readyCalls.push_back(call);
+        state.condition.notify_one();
+    }
+}
+
+void DeviceIoExecutor::callDone(State& state, const Call& call)
+{
+    for (const auto& deviceKey : call.deviceKeys)
+    {
+        const auto it = state.calls.find(deviceKey);
+
+        it->second.pop_front();
+        if (it->second.empty())
+        {
+            state.calls.erase(it);
+        }
+        else
+        {
+            deviceReady(state, it->second.front());
+        }
+    }
+}
+
+void DeviceIoExecutor::quarantineWorker(const std::shared_ptr<State>& state, Call& call)
+{
+    call.isQuarantined = true;
+    ++state->quarantinedWorkers;
+
+    // number of replacements is bounded, so devices that never return cannot exhaust threads
+    if (state->runningWorkers - state->quarantinedWorkers < state->workers &&
+        state->quarantinedWorkers <= state->workers)
+    {
+        ++state->runningWorkers;
+        state->threads.emplace_back(&DeviceIoExecutor::work, state);
+    }
+}
+
+void DeviceIoExecutor::stopWorker(State& state)
+{
+    --state.runningWorkers;
+    state.workerStopped.notify_all();
+}
+}    // namespace wolkabout
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVICEIOEXECUTOR_H
+#define DEVICEIOEXECUTOR_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace wolkabout
+{
+/**
+ * @brief Executes device I/O calls on a pool of worker threads. Calls of the same device are executed
+ *        one at a time in order they were added, calls of different devices are executed in parallel.<br>
+ *        Calls of quarantined devices are executed by a single extra worker, one at a time, and a worker
+ *        running a call of a device that gets quarantined is replaced, so hanging devices do not take
+ *        workers of other devices.
+ */
+class DeviceIoExecutor
+{
+public:
+    /**
+     * @param maxPendingCalls Calls of device that have not started, beyond which added calls are rejected
+     * @param shutdownTimeout How long destructor waits for running calls, workers still running are detached
+     */
+    DeviceIoExecutor(std::size_t workers, std::size_t maxPendingCalls, std::chrono::milliseconds shutdownTimeout);
+
+    /**
+     * @brief Discards calls that have not started and waits for running calls to return, up to shutdown timeout
+     */
+    ~DeviceIoExecutor();
+
+    /**
+     * @return false if call is rejected, because device has too many pending calls
+     */
+    bool execute(const std::string& deviceKey, std::function<void()> call);
+
+    /**
+     * @brief Executes call spanning several devices, once calls of those devices added before it are done.
+     *        Calls of those devices added after it wait for it to return.
+     * @return false if call is rejected, because one of devices has too many pending calls
+     */
+    bool execute(const std::vector<std::string>& deviceKeys, std::function<void()> call);
+
+    void setQuarantined(const std::string& deviceKey, bool quarantined);
+
+    /**
+     * @return Number of calls that have not started yet
+     */
+    std::size_t getPendingCount() const;
+
+    /**
+     * @return Number of worker threads, including replacements of workers running calls of quarantined devices
+     */
+    std::size_t getWorkerCount() const;
+
+private:
+    struct Call
+    {
+        std::function<void()> call;
+        std::vector<std::string> deviceKeys;
+        // devices for which this call is first in order
+        std::size_t readyDevices;
+        bool isRunning;
+        bool isQuarantined;
+    };
+
+    // shared with workers, which may outlive executor when detached on shutdown
+    struct State
+    {
+        std::mutex lock;
+        std::condition_variable condition;
+        std::condition_variable workerStopped;
+
+        std::size_t workers;
+        std::size_t maxPendingCalls;
+
+        bool isShutdown;
+
+        // calls of each device in order, starting with the running one
+        std::map<std::string, std::deque<std::shared_ptr<Call>>> calls;
+        // calls that are first in order for all of their devices
+        std::deque<std::shared_ptr<Call>> readyCalls;
+        std::set<std::string> quarantinedDevices;
+
+        std::size_t pendingCount;
+        std::size_t runningWorkers;
+        std::size_t quarantinedWorkers;
+        // call of quarantined devices started by a worker, at most one runs at a time
+        std::shared_ptr<Call> quarantinedCall;
+
+        std::vector<std::thread> threads;
+    };
+
+    static void work(std::shared_ptr<State> state);
+
+    static std::shared_ptr<Call> takeReadyCall(State& state);
+    static bool isQuarantined(const State& state, const Call& call);
+    static void deviceReady(State& state, const std::shared_ptr<Call>& call);
+    static void callDone(State& state, const Call& call);
+
+    // worker running call of quarantined device is replaced, so other devices keep the configured workers
+    static void quarantineWorker(const std::shared_ptr<State>& state, Call& call);
+    static void stopWorker(State& state);
+
+    const std::chrono::milliseconds m_shutdownTimeout;
+
+    std::shared_ptr<State> m_state;
+};
+}    // namespace wolkabout
+
+#endif    // DEVICEIOEXECUTOR_H
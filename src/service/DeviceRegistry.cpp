@@ -0,0 +1,236 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/DeviceRegistry.h"
+
+namespace wolkabout
+{
+DeviceRegistry::DeviceRegistry(std::shared_ptr<StringInterner> deviceKeys, std::shared_ptr<StringInterner> references)
+: m_deviceKeys{deviceKeys ? deviceKeys : std::make_shared<StringInterner>()}
+, m_references{references ? references : std::make_shared<StringInterner>()}
+, m_snapshot{std::make_shared<const Snapshot>()}
+{
+}
+
+std::shared_ptr<const DeviceRegistry::Devices> DeviceRegistry::getSnapshot() const
+{
+    const auto snapshot = std::atomic_load(&m_snapshot);
+    return std::shared_ptr<const Devices>(snapshot, &snapshot->devices);
+}
+
+bool DeviceRegistry::addDevice(const Device& device)
+{
+    std::lock_guard<std::mutex> guard{m_writeLock};
+
+    const auto current = std::atomic_load(&m_snapshot);
+    if (current->devices.find(device.getKey()) != current->devices.end())
+    {
+        return false;
+    }
+
+    auto next = std::make_shared<Snapshot>(*current);
+    next->devices.emplace(device.getKey(), device);
+    next->deviceKeys.emplace(device.getKey(), m_deviceKeys->retain(device.getKey()));
+    internReferences(device, *next);
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>{std::move(next)});
+    return true;
+}
+
+bool DeviceRegistry::updateDevice(const std::string& deviceKey, const std::function<void(Device&)>& update)
+{
+    std::lock_guard<std::mutex> guard{m_writeLock};
+
+    const auto current = std::atomic_load(&m_snapshot);
+    if (current->devices.find(deviceKey) == current->devices.end())
+    {
+        return false;
+    }
+
+    auto next = std::make_shared<Snapshot>(*current);
+    auto& device = next->devices.at(deviceKey);
+    update(device);
+    internReferences(device, *next);
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>{std::move(next)});
+    return true;
+}
+
+bool DeviceRegistry::removeDevice(const std::string& deviceKey)
+{
+    std::lock_guard<std::mutex> guard{m_writeLock};
+
+    const auto current = std::atomic_load(&m_snapshot);
+    if (current->devices.find(deviceKey) == current->devices.end())
+    {
+        return false;
+    }
+
+    auto next = std::make_shared<Snapshot>(*current);
+    next->devices.erase(deviceKey);
+    next->deviceKeys.erase(deviceKey);
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const Snapshot>{std::move(next)});
+
+    // data of the device already queued by id is dropped if its key is freed before being added
+    m_deviceKeys->release(current->deviceKeys.at(deviceKey));
+    return true;
+}
+
+std::vector<std::string> DeviceRegistry::getDeviceKeys() const
+{
+    const auto devices = getSnapshot();
+
+    std::vector<std::string> keys;
+    for (const auto& kvp : *devices)
+    {
+        keys.push_back(kvp.first);
+    }
+
+    return keys;
+}
+
+std::vector<std::string> DeviceRegistry::getActuatorReferences(const std::string& deviceKey) const
+{
+    const auto devices = getSnapshot();
+
+    auto it = devices->find(deviceKey);
+    if (it == devices->end())
+    {
+        return {};
+    }
+
+    return it->second.getActuatorReferences();
+}
+
+bool DeviceRegistry::deviceExists(const std::string& deviceKey) const
+{
+    const auto devices = getSnapshot();
+    return devices->find(deviceKey) != devices->end();
+}
+
+bool DeviceRegistry::sensorDefinedForDevice(const std::string& deviceKey, const std::string& reference) const
+{
+    const auto devices = getSnapshot();
+
+    auto it = devices->find(deviceKey);
+    if (it == devices->end())
+    {
+        return false;
+    }
+
+    return it->second.getTemplate().hasSensorTemplateWithReference(reference);
+}
+
+bool DeviceRegistry::alarmDefinedForDevice(const std::string& deviceKey, const std::string& reference) const
+{
+    const auto devices = getSnapshot();
+
+    auto it = devices->find(deviceKey);
+    if (it == devices->end())
+    {
+        return false;
+    }
+
+    return it->second.getTemplate().hasAlarmTemplateWithReference(reference);
+}
+
+bool DeviceRegistry::actuatorDefinedForDevice(const std::string& deviceKey, const std::string& reference) const
+{
+    const auto devices = getSnapshot();
+
+    auto it = devices->find(deviceKey);
+    if (it == devices->end())
+    {
+        return false;
+    }
+
+    return it->second.getTemplate().hasActuatorTemplateWithReference(reference);
+}
+
+bool DeviceRegistry::configurationItemDefinedForDevice(const std::string& deviceKey,
+                                                       const std::string& reference) const
+{
+    const auto devices = getSnapshot();
+
+    auto it = devices->find(deviceKey);
+    if (it == devices->end())
+    {
+        return false;
+    }
+
+    return it->second.getTemplate().hasConfigurationTemplateWithReference(reference);
+}
+
+IngestionStatus DeviceRegistry::validateSensorReading(const std::string& deviceKey, const std::string& reference,
+                                                      PersistenceKey& ids) const
+{
+    const auto snapshot = std::atomic_load(&m_snapshot);
+
+    auto it = snapshot->devices.find(deviceKey);
+    if (it == snapshot->devices.end())
+    {
+        return IngestionStatus::UNKNOWN_DEVICE;
+    }
+
+    if (!it->second.getTemplate().hasSensorTemplateWithReference(reference))
+    {
+        return IngestionStatus::UNKNOWN_REFERENCE;
+    }
+
+    ids = PersistenceKey{snapshot->deviceKeys.at(deviceKey), snapshot->references.at(reference)};
+    return IngestionStatus::ACCEPTED;
+}
+
+IngestionStatus DeviceRegistry::validateAlarm(const std::string& deviceKey, const std::string& reference,
+                                              PersistenceKey& ids) const
+{
+    const auto snapshot = std::atomic_load(&m_snapshot);
+
+    auto it = snapshot->devices.find(deviceKey);
+    if (it == snapshot->devices.end())
+    {
+        return IngestionStatus::UNKNOWN_DEVICE;
+    }
+
+    if (!it->second.getTemplate().hasAlarmTemplateWithReference(reference))
+    {
+        return IngestionStatus::UNKNOWN_REFERENCE;
+    }
+
+    ids = PersistenceKey{snapshot->deviceKeys.at(deviceKey), snapshot->references.at(reference)};
+    return IngestionStatus::ACCEPTED;
+}
+
+void DeviceRegistry::internReferences(const Device& device, Snapshot& snapshot)
+{
+    for (const auto& sensor : device.getTemplate().getSensors())
+    {
+        if (snapshot.references.find(sensor.getReference()) == snapshot.references.end())
+        {
+            snapshot.references.emplace(sensor.getReference(), m_references->intern(sensor.getReference()));
+        }
+    }
+
+    for (const auto& alarm : device.getTemplate().getAlarms())
+    {
+        if (snapshot.references.find(alarm.getReference()) == snapshot.references.end())
+        {
+            snapshot.references.emplace(alarm.getReference(), m_references->intern(alarm.getReference()));
+        }
+    }
+}
+}    // namespace wolkabout
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DEVICEREGISTRY_H
+#define DEVICEREGISTRY_H
+
+#include "model/Device.h"
+#include "model/IngestionStatus.h"
+#include "model/PersistenceKey.h"
+#include "utilities/StringInterner.h"
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace wolkabout
+{
+/**
+ * @brief Holds devices as an immutable snapshot that is replaced atomically on every change.<br>
+ *        Reads work on the current snapshot and never wait for writers, so devices and their assets can be
+ *        checked from any thread. Changes are serialized and copy the snapshot, which suits rarely changed devices.<br>
+ *        Device keys are retained and sensor and alarm references are interned when device is added, so data added
+ *        from any thread is passed on by id without locking the interners.
+ */
+class DeviceRegistry
+{
+public:
+    typedef std::map<std::string, Device> Devices;
+
+    /**
+     * @brief Interners are created if not given, pass the ones of wolkabout::DataService to share ids with it
+     */
+    explicit DeviceRegistry(std::shared_ptr<StringInterner> deviceKeys = nullptr,
+                            std::shared_ptr<StringInterner> references = nullptr);
+
+    /**
+     * @brief Returns current snapshot, it is not affected by later changes
+     */
+    std::shared_ptr<const Devices> getSnapshot() const;
+
+    /**
+     * @return false if device with same key already exists
+     */
+    bool addDevice(const Device& device);
+
+    /**
+     * @brief Applies update to copy of device and publishes it in new snapshot
+     * @return false if device does not exist
+     */
+    bool updateDevice(const std::string& deviceKey, const std::function<void(Device&)>& update);
+
+    /**
+     * @return false if device does not exist
+     */
+    bool removeDevice(const std::string& deviceKey);
+
+    std::vector<std::string> getDeviceKeys() const;
+    std::vector<std::string> getActuatorReferences(const std::string& deviceKey) const;
+
+    bool deviceExists(const std::string& deviceKey) const;
+    bool sensorDefinedForDevice(const std::string& deviceKey, const std::string& reference) const;
+    bool alarmDefinedForDevice(const std::string& deviceKey, const std::string& reference) const;
+    bool actuatorDefinedForDevice(const std::string& deviceKey, const std::string& reference) const;
+    bool configurationItemDefinedForDevice(const std::string& deviceKey, const std::string& reference) const;
+
+    /**
+     * @brief Checks that sensor is defined for device and returns ids of device key and reference
+     */
+    IngestionStatus validateSensorReading(const std::string& deviceKey, const std::string& reference,
+                                          PersistenceKey& ids) const;
+
+    /**
+     * @brief Checks that alarm is defined for device and returns ids of device key and reference
+     */
+    IngestionStatus validateAlarm(const std::string& deviceKey, const std::string& reference,
+                                  PersistenceKey& ids) const;
+
+private:
+    struct Snapshot
+    {
+        Devices devices;
+        std::map<std::string, StringInterner::Id> deviceKeys;
+        std::map<std::string, StringInterner::Id> references;
+    };
+
+    void internReferences(const Device& device, Snapshot& snapshot);
+
+    std::shared_ptr<StringInterner> m_deviceKeys;
+    std::shared_ptr<StringInterner> m_references;
+
+    std::mutex m_writeLock;
+
+    // accessed only with std::atomic_load and std::atomic_store
+    std::shared_ptr<const Snapshot> m_snapshot;
+};
+}    // namespace wolkabout
+
+#endif    // DEVICEREGISTRY_H
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/DrainScheduler.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace wolkabout
+{
+const std::chrono::milliseconds DrainScheduler::READINESS_RETRY_DELAY{10};
+const std::chrono::milliseconds DrainScheduler::MIN_PUBLISH_RETRY_DELAY{100};
+const std::chrono::milliseconds DrainScheduler::MAX_PUBLISH_RETRY_DELAY{5000};
+
+DrainScheduler::DrainScheduler(DeviceBatchPublisher batchPublisher, PublishReadiness isReady,
+                               DrainStepExecutor executor, double messagesPerSecond, double bytesPerSecond)
+: m_batchPublisher{std::move(batchPublisher)}
+, m_isReady{std::move(isReady)}
+, m_executor{std::move(executor)}
+, m_messages{messagesPerSecond}
+, m_bytes{bytesPerSecond}
+, m_stepScheduled{false}
+, m_publishRetryDelay{0}
+{
+}
+
+DrainScheduler::~DrainScheduler()
+{
+    stop();
+}
+
+void DrainScheduler::setWeight(const std::string& deviceKey, unsigned int weight)
+{
+    m_weights[deviceKey] = std::max(weight, 1u);
+}
+
+void DrainScheduler::drain(const std::vector<std::string>& deviceKeys)
+{
+    for (const auto& deviceKey : deviceKeys)
+    {
+        const auto it = std::find_if(m_activeDevices.begin(), m_activeDevices.end(),
+                                     [&](const ActiveDevice& device) { return device.key == deviceKey; });
+        if (it == m_activeDevices.end())
+        {
+            m_activeDevices.push_back(ActiveDevice{deviceKey, getWeight(deviceKey)});
+        }
+    }
+
+    if (!m_activeDevices.empty())
+    {
+        scheduleStep(std::chrono::milliseconds{0});
+    }
+}
+
+bool DrainScheduler::isDraining() const
+{
+    return !m_activeDevices.empty();
+}
+
+void DrainScheduler::stop()
+{
+    m_timer.stop();
+}
+
+void DrainScheduler::step()
+{
+    m_stepScheduled = false;
+
+    if (m_activeDevices.empty())
+    {
+        return;
+    }
+
+    if (!m_isReady())
+    {
+        scheduleStep(READINESS_RETRY_DELAY);
+        return;
+    }
+
+    // bytes are known only after publishing, so byte bucket may go into debt which is repaid before next message
+    const auto wait = std::max(m_messages.timeUntilAvailable(1), m_bytes.timeUntilAvailable(0));
+    if (wait.count() > 0)
+    {
+        scheduleStep(wait);
+        return;
+    }
+
+    ActiveDevice& device = m_activeDevices.front();
+
+    const auto result = m_batchPublisher(device.key);
+    if (result.size == 0 && result.hasPending)
+    {
+        ActiveDevice next{device.key, getWeight(device.key)};
+        m_activeDevices.pop_front();
+        m_activeDevices.push_back(next);
+
+        const auto doubledDelay = std::max(m_publishRetryDelay * 2, MIN_PUBLISH_RETRY_DELAY);
+        m_publishRetryDelay = std::min(doubledDelay, MAX_PUBLISH_RETRY_DELAY);
+        scheduleStep(m_publishRetryDelay);
+        return;
+    }
+
+    if (result.size == 0)
+    {
+        m_activeDevices.pop_front();
+    }
+    else
+    {
+        m_publishRetryDelay = std::chrono::milliseconds{0};
+
+        m_messages.consume(1);
+        m_bytes.consume(static_cast<double>(result.size));
+
+        if (--device.credit == 0)
+        {
+            ActiveDevice next{device.key, getWeight(device.key)};
+            m_activeDevices.pop_front();
+            m_activeDevices.push_back(next);
+        }
+    }
+
+    if (!m_activeDevices.empty())
+    {
+        scheduleStep(std::chrono::milliseconds{0});
+    }
+}
+
+void DrainScheduler::scheduleStep(std::chrono::milliseconds delay)
+{
+    if (m_stepScheduled)
+    {
+        return;
+    }
+
+    m_stepScheduled = true;
+
+    if (delay.count() == 0)
+    {
+        m_executor([=] { step(); });
+        return;
+    }
+
+    const auto executor = m_executor;
+    m_timer.start(delay, [=] { executor([=] { step(); }); });
+}
+
+unsigned int DrainScheduler::getWeight(const std::string& deviceKey) const
+{
+    const auto it = m_weights.find(deviceKey);
+    return it != m_weights.end() ? it->second : 1;
+}
+}    // namespace wolkabout
@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DRAINSCHEDULER_H
+#define DRAINSCHEDULER_H
+
+#include "utilities/TaskTimer.h"
+#include "utilities/TokenBucket.h"
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace wolkabout
+{
+/**
+ * @brief Result of publishing a single batch of device's persisted data
+ */
+struct DeviceBatchResult
+{
+    // size of published message in bytes, 0 if nothing was published
+    std::size_t size;
+    // true while device has data left to publish, including data whose publish failed
+    bool hasPending;
+};
+
+typedef std::function<DeviceBatchResult(const std::string&)> DeviceBatchPublisher;
+typedef std::function<bool()> PublishReadiness;
+typedef std::function<void(std::function<void()>)> DrainStepExecutor;
+
+/**
+ * @brief Drains persisted data of devices one batch at a time, rotating between devices.<br>
+ *        Each device publishes up to its weight (1 by default) batches per round. Published messages and bytes
+ *        are limited by token buckets; rate of 0 is unlimited.<br>
+ *        Device whose batch was not published stays in rotation and is retried with exponential backoff.<br>
+ *        Every step is passed to executor, drain and setWeight must be called from the thread executing steps.
+ */
+class DrainScheduler
+{
+public:
+    DrainScheduler(DeviceBatchPublisher batchPublisher, PublishReadiness isReady, DrainStepExecutor executor,
+                   double messagesPerSecond = 0, double bytesPerSecond = 0);
+    ~DrainScheduler();
+
+    void setWeight(const std::string& deviceKey, unsigned int weight);
+
+    /**
+     * @brief Adds devices to rotation, until they have nothing left to publish
+     */
+    void drain(const std::vector<std::string>& deviceKeys);
+
+    bool isDraining() const;
+
+    /**
+     * @brief Cancels delayed step, may be called from any thread<br>
+     *        Steps already passed to executor must be discarded by stopping the executor first
+     */
+    void stop();
+
+private:
+    struct ActiveDevice
+    {
+        std::string key;
+        unsigned int credit;
+    };
+
+    void step();
+    void scheduleStep(std::chrono::milliseconds delay);
+
+    unsigned int getWeight(const std::string& deviceKey) const;
+
+    DeviceBatchPublisher m_batchPublisher;
+    PublishReadiness m_isReady;
+    DrainStepExecutor m_executor;
+
+    TokenBucket m_messages;
+    TokenBucket m_bytes;
+
+    std::map<std::string, unsigned int> m_weights;
+    std::deque<ActiveDevice> m_activeDevices;
+
+    bool m_stepScheduled;
+    std::chrono::milliseconds m_publishRetryDelay;
+    TaskTimer m_timer;
+
+    static const std::chrono::milliseconds READINESS_RETRY_DELAY;
+    static const std::chrono::milliseconds MIN_PUBLISH_RETRY_DELAY;
+    static const std::chrono::milliseconds MAX_PUBLISH_RETRY_DELAY;
+};
+}    // namespace wolkabout
+
+#endif    // DRAINSCHEDULER_H
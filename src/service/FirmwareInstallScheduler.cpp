@@ -0,0 +1,138 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/FirmwareInstallScheduler.h"
+
+#include <algorithm>
+
+namespace wolkabout
+{
+FirmwareInstallScheduler::FirmwareInstallScheduler(std::size_t maxParallelInstalls,
+                                                   std::size_t maxParallelInstallsPerGroup,
+                                                   GroupResolver groupResolver)
+: m_maxParallelInstalls{maxParallelInstalls}
+, m_maxParallelInstallsPerGroup{maxParallelInstallsPerGroup}
+, m_groupResolver{std::move(groupResolver)}
+{
+}
+
+bool FirmwareInstallScheduler::enqueue(const std::string& deviceKey)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    if (m_installing.find(deviceKey) != m_installing.end() ||
+        std::find(m_queue.begin(), m_queue.end(), deviceKey) != m_queue.end())
+    {
+        return false;
+    }
+
+    m_queue.push_back(deviceKey);
+    return true;
+}
+
+bool FirmwareInstallScheduler::cancel(const std::string& deviceKey)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    auto it = std::find(m_queue.begin(), m_queue.end(), deviceKey);
+    if (it == m_queue.end())
+    {
+        return false;
+    }
+
+    m_queue.erase(it);
+    return true;
+}
+
+void FirmwareInstallScheduler::finished(const std::string& deviceKey)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    auto it = m_installing.find(deviceKey);
+    if (it == m_installing.end())
+    {
+        return;
+    }
+
+    auto groupIt = m_installingPerGroup.find(it->second);
+    if (groupIt != m_installingPerGroup.end() && --groupIt->second == 0)
+    {
+        m_installingPerGroup.erase(groupIt);
+    }
+
+    m_installing.erase(it);
+}
+
+std::vector<std::string> FirmwareInstallScheduler::takeStartable()
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    std::vector<std::string> startable;
+
+    auto it = m_queue.begin();
+    while (it != m_queue.end() && (m_maxParallelInstalls == 0 || m_installing.size() < m_maxParallelInstalls))
+    {
+        const auto group = getGroup(*it);
+
+        auto& installingInGroup = m_installingPerGroup[group];
+        if (m_maxParallelInstallsPerGroup != 0 && installingInGroup >= m_maxParallelInstallsPerGroup)
+        {
+            ++it;
+            continue;
+        }
+
+        ++installingInGroup;
+        m_installing[*it] = group;
+        startable.push_back(*it);
+
+        it = m_queue.erase(it);
+    }
+
+    return startable;
+}
+
+std::size_t FirmwareInstallScheduler::getQueuePosition(const std::string& deviceKey) const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    auto it = std::find(m_queue.begin(), m_queue.end(), deviceKey);
+    if (it == m_queue.end())
+    {
+        return 0;
+    }
+
+    return static_cast<std::size_t>(std::distance(m_queue.begin(), it)) + 1;
+}
+
+bool FirmwareInstallScheduler::isInstalling(const std::string& deviceKey) const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    return m_installing.find(deviceKey) != m_installing.end();
+}
+
+std::size_t FirmwareInstallScheduler::getInstallingCount() const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    return m_installing.size();
+}
+
+std::string FirmwareInstallScheduler::getGroup(const std::string& deviceKey) const
+{
+    return m_groupResolver ? m_groupResolver(deviceKey) : std::string{};
+}
+}    // namespace wolkabout
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRMWAREINSTALLSCHEDULER_H
+#define FIRMWAREINSTALLSCHEDULER_H
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace wolkabout
+{
+/**
+ * @brief Decides when queued firmware installations may start, limiting number of installations in progress
+ *        globally and per group of devices sharing a bus.<br>
+ *        Devices are started in queue order, a device whose group is at its limit does not hold back devices
+ *        of other groups. This class is thread safe.
+ */
+class FirmwareInstallScheduler
+{
+public:
+    /**
+     * @brief Returns group of device, devices of the same group share per group limit
+     */
+    typedef std::function<std::string(const std::string& deviceKey)> GroupResolver;
+
+    /**
+     * @param maxParallelInstalls Maximum number of installations in progress, 0 for unlimited
+     * @param maxParallelInstallsPerGroup Maximum number of installations in progress within a group,
+     *                                    0 for unlimited
+     * @param groupResolver Resolves device groups, every device is in the same group if not set
+     */
+    FirmwareInstallScheduler(std::size_t maxParallelInstalls = 0, std::size_t maxParallelInstallsPerGroup = 0,
+                             GroupResolver groupResolver = nullptr);
+
+    /**
+     * @return false if device is already queued or installing
+     */
+    bool enqueue(const std::string& deviceKey);
+
+    /**
+     * @brief Removes device from queue
+     * @return false if device is not queued
+     */
+    bool cancel(const std::string& deviceKey);
+
+    /**
+     * @brief Frees the slot taken by device when its installation started
+     */
+    void finished(const std::string& deviceKey);
+
+    /**
+     * @brief Returns devices that can start installing now, in queue order, and marks them as installing
+     */
+    std::vector<std::string> takeStartable();
+
+    /**
+     * @return Position of device in queue starting from 1, 0 if device is not queued
+     */
+    std::size_t getQueuePosition(const std::string& deviceKey) const;
+
+    bool isInstalling(const std::string& deviceKey) const;
+
+    std::size_t getInstallingCount() const;
+
+private:
+    std::string getGroup(const std::string& deviceKey) const;
+
+    const std::size_t m_maxParallelInstalls;
+    const std::size_t m_maxParallelInstallsPerGroup;
+    const GroupResolver m_groupResolver;
+
+    mutable std::mutex m_lock;
+
+    std::deque<std::string> m_queue;
+    std::map<std::string, std::string> m_installing;
+    std::map<std::string, std::size_t> m_installingPerGroup;
+};
+}    // namespace wolkabout
+
+#endif    // FIRMWAREINSTALLSCHEDULER_H
@@ -25,21 +25,36 @@
 #include "core/model/FirmwareVersion.h"
 #include "core/model/Message.h"
 #include "core/protocol/json/JsonDFUProtocol.h"
-#include "core/utilities/FileSystemUtils.h"
 #include "core/utilities/Logger.h"
 #include "core/utilities/StringUtils.h"
 
+#include <algorithm>
+
 namespace wolkabout
 {
+const constexpr unsigned int FirmwareUpdateService::STALL_PROGRESS_INTERVALS;
+
 FirmwareUpdateService::FirmwareUpdateService(JsonDFUProtocol& protocol,
                                              std::shared_ptr<FirmwareInstaller> firmwareInstaller,
                                              std::shared_ptr<FirmwareVersionProvider> firmwareVersionProvider,
-                                             ConnectivityService& connectivityService)
+                                             ConnectivityService& connectivityService,
+                                             std::unique_ptr<FirmwareInstallScheduler> installScheduler,
+                                             std::chrono::milliseconds progressInterval)
 : m_protocol{protocol}
 , m_firmwareInstaller{firmwareInstaller}
 , m_firmwareVersionProvider{firmwareVersionProvider}
 , m_connectivityService{connectivityService}
+, m_installScheduler{installScheduler ? std::move(installScheduler)
+                                      : std::unique_ptr<FirmwareInstallScheduler>(new FirmwareInstallScheduler())}
+, m_progressInterval{progressInterval}
+{
+}
+
+FirmwareUpdateService::~FirmwareUpdateService()
 {
+    // commands start and stop the progress timer, so they are stopped before it
+    m_commandBuffer.stop();
+    m_progressTimer.stop();
 }
 
 void FirmwareUpdateService::messageReceived(std::shared_ptr<Message> message)
@@ -47,18 +62,14 @@ void FirmwareUpdateService::messageReceived(std::shared_ptr<Message> message)
     auto installCommand = m_protocol.makeFirmwareUpdateInstall(*message);
     if (installCommand)
     {
-        auto installDto = *installCommand;
-        addToCommandBuffer([=] { handleFirmwareUpdateCommand(installDto); });
-
+        handleFirmwareUpdateCommand(*installCommand);
         return;
     }
 
     auto abortCommand = m_protocol.makeFirmwareUpdateAbort(*message);
     if (abortCommand)
     {
-        auto abortDto = *abortCommand;
-        addToCommandBuffer([=] { handleFirmwareUpdateCommand(abortDto); });
-
+        handleFirmwareUpdateCommand(*abortCommand);
         return;
     }
 
@@ -71,6 +82,16 @@ const Protocol& FirmwareUpdateService::getProtocol()
     return m_protocol;
 }
 
+void FirmwareUpdateService::handleFirmwareUpdateCommand(const FirmwareUpdateInstall& command)
+{
+    addToCommandBuffer([=] { executeFirmwareUpdateCommand(command); });
+}
+
+void FirmwareUpdateService::handleFirmwareUpdateCommand(const FirmwareUpdateAbort& command)
+{
+    addToCommandBuffer([=] { executeFirmwareUpdateCommand(command); });
+}
+
 void FirmwareUpdateService::publishFirmwareVersion(const std::string& deviceKey)
 {
     addToCommandBuffer([=] {
@@ -82,32 +103,75 @@ void FirmwareUpdateService::publishFirmwareVersion(const std::string& deviceKey)
             return;
         }
 
-        const std::shared_ptr<Message> message =
-          m_protocol.makeMessage(deviceKey, FirmwareVersion{deviceKey, firmwareVersion});
+        publishFirmwareVersion(deviceKey, firmwareVersion);
+    });
+}
 
-        if (!message)
-        {
-            LOG(WARN) << "Failed to create firmware version message";
-            return;
-        }
+void FirmwareUpdateService::publishFirmwareVersions(const std::vector<std::string>& deviceKeys)
+{
+    addToCommandBuffer([=] {
+        const auto firmwareVersions = m_firmwareVersionProvider->getFirmwareVersions(deviceKeys);
 
-        if (!m_connectivityService.publish(message))
+        std::size_t published = 0;
+        for (const auto& deviceKey : deviceKeys)
         {
-            LOG(WARN) << "Failed to publish firmware version message";
-            return;
+            const auto versionIt = firmwareVersions.find(deviceKey);
+            if (versionIt == firmwareVersions.end() || versionIt->second.empty())
+            {
+                LOG(WARN) << "Failed to get firmware version for device " << deviceKey;
+                continue;
+            }
+
+            const auto publishedIt = m_publishedVersions.find(deviceKey);
+            if (publishedIt != m_publishedVersions.end() && publishedIt->second == versionIt->second)
+            {
+                continue;
+            }
+
+            if (publishFirmwareVersion(deviceKey, versionIt->second))
+            {
+                ++published;
+            }
         }
+
+        LOG(DEBUG) << "Published " << published << " changed firmware versions out of " << deviceKeys.size();
     });
 }
 
-void FirmwareUpdateService::handleFirmwareUpdateCommand(const FirmwareUpdateInstall& command)
+std::size_t FirmwareUpdateService::getInstallQueuePosition(const std::string& deviceKey) const
 {
-    if (command.getDeviceKeys().size() != 1 || command.getDeviceKeys().at(0).empty())
+    return m_installScheduler->getQueuePosition(deviceKey);
+}
+
+bool FirmwareUpdateService::isInstallationStalled(const std::string& deviceKey) const
+{
+    std::lock_guard<std::mutex> guard{m_progressLock};
+
+    auto it = m_progress.find(deviceKey);
+    if (it == m_progress.end())
     {
-        LOG(WARN) << "Unable to extract device key from firmware install command";
-        return;
+        return false;
     }
 
-    auto deviceKey = command.getDeviceKeys().at(0);
+    return std::chrono::steady_clock::now() - it->second.lastChange >= m_progressInterval * STALL_PROGRESS_INTERVALS;
+}
+
+void FirmwareUpdateService::executeFirmwareUpdateCommand(const FirmwareUpdateInstall& command)
+{
+    std::vector<std::string> deviceKeys;
+    for (const auto& deviceKey : command.getDeviceKeys())
+    {
+        if (!deviceKey.empty() && std::find(deviceKeys.begin(), deviceKeys.end(), deviceKey) == deviceKeys.end())
+        {
+            deviceKeys.push_back(deviceKey);
+        }
+    }
+
+    if (deviceKeys.empty())
+    {
+        LOG(WARN) << "Unable to extract device keys from firmware install command";
+        return;
+    }
 
     auto firmwareFile = command.getFileName();
 
@@ -115,61 +179,218 @@ void FirmwareUpdateService::handleFirmwareUpdateCommand(const FirmwareUpdateInst
     {
         LOG(WARN) << "Missing file path in firmware install command";
 
-        sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Error::FILE_SYSTEM_ERROR});
+        for (const auto& deviceKey : deviceKeys)
+        {
+            sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Error::FILE_SYSTEM_ERROR});
+        }
         return;
     }
 
-    if (!FileSystemUtils::isFilePresent(firmwareFile))
+    const auto image = m_imageCache.get(firmwareFile);
+    if (!image)
     {
-        LOG(WARN) << "Missing firmware file: " << firmwareFile;
+        LOG(WARN) << "Missing or unreadable firmware file: " << firmwareFile;
 
-        sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Error::FILE_SYSTEM_ERROR});
+        for (const auto& deviceKey : deviceKeys)
+        {
+            sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Error::FILE_SYSTEM_ERROR});
+        }
         return;
     }
 
-    install(deviceKey, firmwareFile);
+    LOG(INFO) << "Firmware file " << firmwareFile << ", size: " << image->getSize()
+              << ", SHA-256: " << image->getSha256();
+
+    install(deviceKeys, image);
 }
 
-void FirmwareUpdateService::handleFirmwareUpdateCommand(const FirmwareUpdateAbort& command)
+void FirmwareUpdateService::executeFirmwareUpdateCommand(const FirmwareUpdateAbort& command)
 {
-    if (command.getDeviceKeys().size() != 1 || command.getDeviceKeys().at(0).empty())
+    bool deviceKeyFound = false;
+    for (const auto& deviceKey : command.getDeviceKeys())
     {
-        LOG(WARN) << "Unable to extract device key from firmware abort command";
-        return;
+        if (!deviceKey.empty())
+        {
+            deviceKeyFound = true;
+            abort(deviceKey);
+        }
     }
 
-    auto deviceKey = command.getDeviceKeys().at(0);
+    if (!deviceKeyFound)
+    {
+        LOG(WARN) << "Unable to extract device keys from firmware abort command";
+    }
+}
 
-    abort(deviceKey);
+void FirmwareUpdateService::install(const std::vector<std::string>& deviceKeys,
+                                    std::shared_ptr<const FirmwareImage> image)
+{
+    std::vector<std::string> enqueued;
+    for (const auto& deviceKey : deviceKeys)
+    {
+        if (!m_installScheduler->enqueue(deviceKey))
+        {
+            LOG(WARN) << "Firmware installation already in progress for device: " << deviceKey;
+            continue;
+        }
+
+        m_installImages[deviceKey] = image;
+        enqueued.push_back(deviceKey);
+
+        sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Status::INSTALLATION});
+    }
+
+    startQueuedInstalls();
+
+    for (const auto& deviceKey : enqueued)
+    {
+        const auto position = m_installScheduler->getQueuePosition(deviceKey);
+        if (position != 0)
+        {
+            LOG(INFO) << "Firmware installation for device " << deviceKey << " queued at position " << position;
+        }
+    }
 }
 
-void FirmwareUpdateService::install(const std::string& deviceKey, const std::string& firmwareFilePath)
+void FirmwareUpdateService::startQueuedInstalls()
 {
-    sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Status::INSTALLATION});
+    const auto startable = m_installScheduler->takeStartable();
+    if (!startable.empty() && !m_progressTimer.isRunning())
+    {
+        m_progressTimer.run(m_progressInterval, [=] { addToCommandBuffer([=] { publishProgress(); }); });
+    }
 
+    for (const auto& deviceKey : startable)
+    {
+        startInstall(deviceKey, m_installImages[deviceKey]);
+    }
+}
+
+void FirmwareUpdateService::startInstall(const std::string& deviceKey, std::shared_ptr<const FirmwareImage> image)
+{
+    LOG(INFO) << "Starting firmware installation for device " << deviceKey;
+
+    {
+        std::lock_guard<std::mutex> guard{m_progressLock};
+        m_progress[deviceKey] = InstallProgress{0, false, std::chrono::steady_clock::now(), false};
+    }
+
+    // installer may report from its own threads, install state is only modified from command buffer
     m_firmwareInstaller->install(
-      deviceKey, firmwareFilePath, [=](const std::string& key) { installSucceeded(key); },
-      [=](const std::string& key) { installFailed(key); });
+      deviceKey, image, [=](const std::string& key) { addToCommandBuffer([=] { installSucceeded(key); }); },
+      [=](const std::string& key) { addToCommandBuffer([=] { installFailed(key); }); },
+      [=](const std::string& key, unsigned int percent) { progressReported(key, percent); });
 }
 
 void FirmwareUpdateService::installSucceeded(const std::string& deviceKey)
 {
     sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Status::COMPLETED});
     publishFirmwareVersion(deviceKey);
+
+    installFinished(deviceKey);
 }
 
 void FirmwareUpdateService::installFailed(const std::string& deviceKey)
 {
     sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Error::INSTALLATION_FAILED});
+
+    installFinished(deviceKey);
+}
+
+void FirmwareUpdateService::installFinished(const std::string& deviceKey)
+{
+    if (!m_installScheduler->isInstalling(deviceKey))
+    {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard{m_progressLock};
+        m_progress.erase(deviceKey);
+    }
+
+    m_installScheduler->finished(deviceKey);
+    m_installImages.erase(deviceKey);
+
+    if (m_installScheduler->getInstallingCount() == 0)
+    {
+        m_progressTimer.stop();
+    }
+
+    startQueuedInstalls();
+}
+
+void FirmwareUpdateService::progressReported(const std::string& deviceKey, unsigned int percent)
+{
+    std::lock_guard<std::mutex> guard{m_progressLock};
+
+    percent = std::min(percent, 100u);
+
+    auto it = m_progress.find(deviceKey);
+    if (it == m_progress.end() || it->second.percent == percent)
+    {
+        return;
+    }
+
+    it->second.percent = percent;
+    it->second.changed = true;
+    it->second.lastChange = std::chrono::steady_clock::now();
+    it->second.stallReported = false;
+}
+
+void FirmwareUpdateService::publishProgress()
+{
+    std::vector<std::pair<std::string, unsigned int>> changed;
+    {
+        std::lock_guard<std::mutex> guard{m_progressLock};
+
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& kvp : m_progress)
+        {
+            auto& progress = kvp.second;
+            if (progress.changed)
+            {
+                progress.changed = false;
+                changed.emplace_back(kvp.first, progress.percent);
+            }
+            else if (!progress.stallReported &&
+                     now - progress.lastChange >= m_progressInterval * STALL_PROGRESS_INTERVALS)
+            {
+                progress.stallReported = true;
+                LOG(WARN) << "No firmware installation progress for device " << kvp.first << " at "
+                          << progress.percent << "% since "
+                          << std::chrono::duration_cast<std::chrono::seconds>(now - progress.lastChange).count()
+                          << "s";
+            }
+        }
+    }
+
+    for (const auto& kvp : changed)
+    {
+        LOG(INFO) << "Firmware installation progress for device " << kvp.first << ": " << kvp.second << "%";
+        sendProgress(kvp.first, kvp.second);
+    }
 }
 
 void FirmwareUpdateService::abort(const std::string& deviceKey)
 {
     LOG(INFO) << "Abort firmware installation for device: " << deviceKey;
+
+    if (m_installScheduler->cancel(deviceKey))
+    {
+        m_installImages.erase(deviceKey);
+
+        LOG(INFO) << "Queued firmware installation aborted for device: " << deviceKey;
+        sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Status::ABORTED});
+        return;
+    }
+
     if (m_firmwareInstaller->abort(deviceKey))
     {
         LOG(INFO) << "Firmware installation aborted for device: " << deviceKey;
         sendStatus(FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Status::ABORTED});
+
+        installFinished(deviceKey);
     }
     else
     {
@@ -177,6 +398,27 @@ void FirmwareUpdateService::abort(const std::string& deviceKey)
     }
 }
 
+bool FirmwareUpdateService::publishFirmwareVersion(const std::string& deviceKey, const std::string& firmwareVersion)
+{
+    const std::shared_ptr<Message> message =
+      m_protocol.makeMessage(deviceKey, FirmwareVersion{deviceKey, firmwareVersion});
+
+    if (!message)
+    {
+        LOG(WARN) << "Failed to create firmware version message";
+        return false;
+    }
+
+    if (!m_connectivityService.publish(message))
+    {
+        LOG(WARN) << "Failed to publish firmware version message";
+        return false;
+    }
+
+    m_publishedVersions[deviceKey] = firmwareVersion;
+    return true;
+}
+
 void FirmwareUpdateService::sendStatus(const FirmwareUpdateStatus& response)
 {
     auto& deviceKey = response.getDeviceKeys().at(0);
@@ -194,6 +436,33 @@ void FirmwareUpdateService::sendStatus(const FirmwareUpdateStatus& response)
     }
 }
 
+void FirmwareUpdateService::sendProgress(const std::string& deviceKey, unsigned int percent)
+{
+    std::shared_ptr<Message> message =
+      m_protocol.makeMessage(deviceKey, FirmwareUpdateStatus{{deviceKey}, FirmwareUpdateStatus::Status::INSTALLATION});
+
+    if (!message)
+    {
+        LOG(WARN) << "Failed to create firmware update response";
+        return;
+    }
+
+    // status model has no progress field, percent is appended to status object
+    const auto& content = message->getContent();
+    const auto end = content.rfind('}');
+    if (end != std::string::npos)
+    {
+        const auto progressContent =
+          content.substr(0, end) + ",\"progress\":" + std::to_string(percent) + content.substr(end);
+        message = std::make_shared<Message>(progressContent, message->getChannel());
+    }
+
+    if (!m_connectivityService.publish(message))
+    {
+        LOG(WARN) << "Firmware update progress not published for device: " << deviceKey;
+    }
+}
+
 void FirmwareUpdateService::addToCommandBuffer(std::function<void()> command)
 {
     m_commandBuffer.pushCommand(std::make_shared<std::function<void()>>(command));
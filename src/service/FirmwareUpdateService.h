@@ -17,10 +17,17 @@
 #define FIRMWAREUPDATESERVICE_H
 
 #include "InboundGatewayMessageHandler.h"
+#include "service/FirmwareInstallScheduler.h"
+#include "utilities/FirmwareImageCache.h"
+#include "utilities/TaskTimer.h"
 
+#include <chrono>
+#include <cstddef>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
 namespace wolkabout
 {
@@ -33,31 +40,86 @@ class FirmwareUpdateResponse;
 class FirmwareUpdateStatus;
 class JsonDFUProtocol;
 
+/**
+ * @brief Installs firmware on devices listed in install command. Firmware image is opened and hashed once per
+ *        command and the same image is installed on every device, as admitted by install scheduler.
+ *        Device is reported as INSTALLATION once accepted, also while waiting for its turn; its position in
+ *        install queue is only available locally.<br>
+ *        While installing, progress reported by installer is published at most once per progress interval,
+ *        as INSTALLATION status carrying the latest percent.<br>
+ *        Last published firmware version of each device is cached so versions can be published in bulk
+ *        with only changed versions being sent.
+ */
 class FirmwareUpdateService : public MessageListener
 {
 public:
+    /**
+     * @param installScheduler Limits installations in progress, unlimited if not set
+     * @param progressInterval Minimum time between two progress publishes for a device
+     */
     FirmwareUpdateService(JsonDFUProtocol& protocol, std::shared_ptr<FirmwareInstaller> firmwareInstaller,
                           std::shared_ptr<FirmwareVersionProvider> firmwareVersionProvider,
-                          ConnectivityService& connectivityService);
+                          ConnectivityService& connectivityService,
+                          std::unique_ptr<FirmwareInstallScheduler> installScheduler = nullptr,
+                          std::chrono::milliseconds progressInterval = std::chrono::milliseconds{10000});
+
+    ~FirmwareUpdateService();
 
     void messageReceived(std::shared_ptr<Message> message) override;
     const Protocol& getProtocol() override;
 
+    /**
+     * @brief Handles command the same way as when it is received from platform, command is executed asynchronously
+     */
+    void handleFirmwareUpdateCommand(const FirmwareUpdateInstall& command);
+    void handleFirmwareUpdateCommand(const FirmwareUpdateAbort& command);
+
+    /**
+     * @brief Publishes firmware version of device even if it has not changed since last publish
+     */
     void publishFirmwareVersion(const std::string& deviceKey);
 
+    /**
+     * @brief Queries firmware versions of all devices with single provider call
+     *        and publishes only versions that changed since last publish
+     */
+    void publishFirmwareVersions(const std::vector<std::string>& deviceKeys);
+
+    /**
+     * @return Position of device in install queue starting from 1, 0 if device is not waiting to be installed
+     */
+    std::size_t getInstallQueuePosition(const std::string& deviceKey) const;
+
+    /**
+     * @return true if installer has not reported progress for device during last
+     *         STALL_PROGRESS_INTERVALS progress intervals
+     */
+    bool isInstallationStalled(const std::string& deviceKey) const;
+
 private:
-    void handleFirmwareUpdateCommand(const FirmwareUpdateInstall& command);
-    void handleFirmwareUpdateCommand(const FirmwareUpdateAbort& command);
+    void executeFirmwareUpdateCommand(const FirmwareUpdateInstall& command);
+    void executeFirmwareUpdateCommand(const FirmwareUpdateAbort& command);
+
+    void install(const std::vector<std::string>& deviceKeys, std::shared_ptr<const FirmwareImage> image);
 
-    void install(const std::string& deviceKey, const std::string& firmwareFilePath);
+    void startQueuedInstalls();
+    void startInstall(const std::string& deviceKey, std::shared_ptr<const FirmwareImage> image);
 
     void installSucceeded(const std::string& deviceKey);
 
     void installFailed(const std::string& deviceKey);
 
+    void installFinished(const std::string& deviceKey);
+
+    void progressReported(const std::string& deviceKey, unsigned int percent);
+    void publishProgress();
+
     void abort(const std::string& deviceKey);
 
+    bool publishFirmwareVersion(const std::string& deviceKey, const std::string& firmwareVersion);
+
     void sendStatus(const FirmwareUpdateStatus& status);
+    void sendProgress(const std::string& deviceKey, unsigned int percent);
 
     void addToCommandBuffer(std::function<void()> command);
 
@@ -68,7 +130,35 @@ private:
 
     ConnectivityService& m_connectivityService;
 
+    std::unique_ptr<FirmwareInstallScheduler> m_installScheduler;
+
+    // images of queued and installing devices
+    std::map<std::string, std::shared_ptr<const FirmwareImage>> m_installImages;
+
+    FirmwareImageCache m_imageCache;
+
+    // last successfully published firmware versions, only accessed from command buffer
+    std::map<std::string, std::string> m_publishedVersions;
+
+    struct InstallProgress
+    {
+        unsigned int percent;
+        bool changed;
+        std::chrono::steady_clock::time_point lastChange;
+        bool stallReported;
+    };
+
+    const std::chrono::milliseconds m_progressInterval;
+
+    // written by installer threads
+    mutable std::mutex m_progressLock;
+    std::map<std::string, InstallProgress> m_progress;
+
     CommandBuffer m_commandBuffer;
+
+    TaskTimer m_progressTimer;
+
+    static const constexpr unsigned int STALL_PROGRESS_INTERVALS = 3;
 };
 }    // namespace wolkabout
 
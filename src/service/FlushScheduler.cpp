@@ -0,0 +1,76 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/FlushScheduler.h"
+
+#include <utility>
+
+namespace wolkabout
+{
+FlushScheduler::FlushScheduler(const FlushPolicy& policy, std::function<void()> flush,
+                               std::function<void(std::function<void()>)> executor)
+: m_policy{policy}, m_flush{std::move(flush)}, m_executor{std::move(executor)}, m_itemsCount{0}, m_bytes{0}
+{
+}
+
+FlushScheduler::~FlushScheduler()
+{
+    stop();
+}
+
+void FlushScheduler::start()
+{
+    restartTimer();
+}
+
+void FlushScheduler::stop()
+{
+    m_timer.stop();
+}
+
+void FlushScheduler::added(std::size_t bytes)
+{
+    ++m_itemsCount;
+    m_bytes += bytes;
+
+    if ((m_policy.getItemsCount() != 0 && m_itemsCount >= m_policy.getItemsCount()) ||
+        (m_policy.getBytes() != 0 && m_bytes >= m_policy.getBytes()))
+    {
+        flush();
+    }
+}
+
+void FlushScheduler::flush()
+{
+    m_itemsCount = 0;
+    m_bytes = 0;
+
+    restartTimer();
+
+    m_flush();
+}
+
+void FlushScheduler::restartTimer()
+{
+    if (m_policy.getInterval().count() == 0)
+    {
+        return;
+    }
+
+    const auto executor = m_executor;
+    m_timer.start(m_policy.getInterval(), [=] { executor([=] { flush(); }); });
+}
+}    // namespace wolkabout
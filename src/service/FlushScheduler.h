@@ -0,0 +1,71 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FLUSHSCHEDULER_H
+#define FLUSHSCHEDULER_H
+
+#include "model/FlushPolicy.h"
+#include "utilities/TaskTimer.h"
+
+#include <cstddef>
+#include <functional>
+
+namespace wolkabout
+{
+/**
+ * @brief Triggers flush according to wolkabout::FlushPolicy.<br>
+ *        Flush is passed to executor; added and flush must be called from the thread executing it.
+ */
+class FlushScheduler
+{
+public:
+    FlushScheduler(const FlushPolicy& policy, std::function<void()> flush,
+                   std::function<void(std::function<void()>)> executor);
+    ~FlushScheduler();
+
+    /**
+     * @brief Starts interval timer
+     */
+    void start();
+
+    void stop();
+
+    /**
+     * @brief Accounts buffered item, flushing if items count or bytes limit is reached
+     */
+    void added(std::size_t bytes);
+
+    /**
+     * @brief Flushes and restarts interval timer
+     */
+    void flush();
+
+private:
+    void restartTimer();
+
+    const FlushPolicy m_policy;
+
+    std::function<void()> m_flush;
+    std::function<void(std::function<void()>)> m_executor;
+
+    std::size_t m_itemsCount;
+    std::size_t m_bytes;
+
+    TaskTimer m_timer;
+};
+}    // namespace wolkabout
+
+#endif    // FLUSHSCHEDULER_H
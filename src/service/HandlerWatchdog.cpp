@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/HandlerWatchdog.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace wolkabout
+{
+const constexpr unsigned int HandlerWatchdog::CHECKS_PER_TIMEOUT;
+const std::chrono::milliseconds HandlerWatchdog::MIN_CHECK_INTERVAL{10};
+
+HandlerWatchdog::HandlerWatchdog(std::chrono::milliseconds timeout, HandlerTimeoutHandler timeoutHandler,
+                                 QuarantineHandler quarantineHandler)
+: m_timeout{timeout}
+, m_timeoutHandler{std::move(timeoutHandler)}
+, m_quarantineHandler{std::move(quarantineHandler)}
+, m_nextOperation{0}
+, m_statistics{0, 0, 0, 0, 0, 0}
+{
+    m_timer.run(std::max(m_timeout / CHECKS_PER_TIMEOUT, MIN_CHECK_INTERVAL), [=] { check(); });
+}
+
+HandlerWatchdog::~HandlerWatchdog()
+{
+    m_timer.stop();
+}
+
+std::uint64_t HandlerWatchdog::start(const std::string& deviceKey, const std::string& reference)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    const auto operation = ++m_nextOperation;
+    m_operations.emplace(operation, Operation{deviceKey, reference, std::chrono::steady_clock::now(), false});
+
+    ++m_statistics.watched;
+
+    return operation;
+}
+
+bool HandlerWatchdog::finish(std::uint64_t operation)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    const auto it = m_operations.find(operation);
+    if (it == m_operations.end())
+    {
+        return false;
+    }
+
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                                it->second.started);
+    const auto durationMicroseconds = static_cast<std::uint64_t>(duration.count());
+
+    m_statistics.totalDurationMicroseconds += durationMicroseconds;
+    m_statistics.maxDurationMicroseconds = std::max(m_statistics.maxDurationMicroseconds, durationMicroseconds);
+
+    const bool inTime = !it->second.timedOut;
+    if (inTime)
+    {
+        setQuarantined(it->second.deviceKey, false);
+    }
+    else
+    {
+        ++m_statistics.lateCompletions;
+    }
+
+    m_operations.erase(it);
+
+    return inTime;
+}
+
+bool HandlerWatchdog::isQuarantined(const std::string& deviceKey) const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    return m_quarantinedDevices.find(deviceKey) != m_quarantinedDevices.end();
+}
+
+void HandlerWatchdog::removeDevice(const std::string& deviceKey)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    setQuarantined(deviceKey, false);
+
+    for (auto it = m_operations.begin(); it != m_operations.end();)
+    {
+        it = it->second.deviceKey == deviceKey ? m_operations.erase(it) : std::next(it);
+    }
+}
+
+HandlerWatchdogStatistics HandlerWatchdog::getStatistics() const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    auto statistics = m_statistics;
+    statistics.quarantinedDevices = m_quarantinedDevices.size();
+
+    return statistics;
+}
+
+void HandlerWatchdog::check()
+{
+    std::vector<std::pair<std::string, std::string>> timedOut;
+    {
+        std::lock_guard<std::mutex> guard{m_lock};
+
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& kvp : m_operations)
+        {
+            auto& operation = kvp.second;
+            if (operation.timedOut || now - operation.started < m_timeout)
+            {
+                continue;
+            }
+
+            operation.timedOut = true;
+            setQuarantined(operation.deviceKey, true);
+            ++m_statistics.timedOut;
+
+            timedOut.emplace_back(operation.deviceKey, operation.reference);
+        }
+    }
+
+    for (const auto& operation : timedOut)
+    {
+        m_timeoutHandler(operation.first, operation.second);
+    }
+}
+
+void HandlerWatchdog::setQuarantined(const std::string& deviceKey, bool quarantined)
+{
+    bool changed = false;
+    if (quarantined)
+    {
+        changed = m_quarantinedDevices.insert(deviceKey).second;
+    }
+    else
+    {
+        changed = m_quarantinedDevices.erase(deviceKey) != 0;
+    }
+
+    if (changed && m_quarantineHandler)
+    {
+        m_quarantineHandler(deviceKey, quarantined);
+    }
+}
+}    // namespace wolkabout
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef HANDLERWATCHDOG_H
+#define HANDLERWATCHDOG_H
+
+#include "utilities/TaskTimer.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace wolkabout
+{
+struct HandlerWatchdogStatistics
+{
+    std::uint64_t watched;
+    std::uint64_t timedOut;
+    std::uint64_t lateCompletions;
+    std::uint64_t totalDurationMicroseconds;
+    std::uint64_t maxDurationMicroseconds;
+    std::size_t quarantinedDevices;
+};
+
+typedef std::function<void(const std::string& deviceKey, const std::string& reference)> HandlerTimeoutHandler;
+typedef std::function<void(const std::string& deviceKey, bool quarantined)> QuarantineHandler;
+
+/**
+ * @brief Measures duration of handler and provider operations and reports operations that do not finish
+ *        within timeout. Timeout handler is called from watchdog thread, once per operation.<br>
+ *        Device with timed out operation is quarantined until one of its operations finishes in time.
+ *        Quarantine handler is called on every change, while watchdog is locked, and must not call watchdog.
+ */
+class HandlerWatchdog
+{
+public:
+    HandlerWatchdog(std::chrono::milliseconds timeout, HandlerTimeoutHandler timeoutHandler,
+                    QuarantineHandler quarantineHandler = nullptr);
+    ~HandlerWatchdog();
+
+    /**
+     * @return Id of operation, to be passed to finish
+     */
+    std::uint64_t start(const std::string& deviceKey, const std::string& reference);
+
+    /**
+     * @return false if operation has already timed out
+     */
+    bool finish(std::uint64_t operation);
+
+    bool isQuarantined(const std::string& deviceKey) const;
+
+    void removeDevice(const std::string& deviceKey);
+
+    HandlerWatchdogStatistics getStatistics() const;
+
+private:
+    struct Operation
+    {
+        std::string deviceKey;
+        std::string reference;
+        std::chrono::steady_clock::time_point started;
+        bool timedOut;
+    };
+
+    void check();
+    void setQuarantined(const std::string& deviceKey, bool quarantined);
+
+    const std::chrono::milliseconds m_timeout;
+    HandlerTimeoutHandler m_timeoutHandler;
+    QuarantineHandler m_quarantineHandler;
+
+    mutable std::mutex m_lock;
+    std::uint64_t m_nextOperation;
+    std::map<std::uint64_t, Operation> m_operations;
+    std::set<std::string> m_quarantinedDevices;
+    HandlerWatchdogStatistics m_statistics;
+
+    TaskTimer m_timer;
+
+    static const constexpr unsigned int CHECKS_PER_TIMEOUT = 4;
+    static const std::chrono::milliseconds MIN_CHECK_INTERVAL;
+};
+}    // namespace wolkabout
+
+#endif    // HANDLERWATCHDOG_H
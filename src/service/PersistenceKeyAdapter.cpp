@@ -0,0 +1,182 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/PersistenceKeyAdapter.h"
+
+#include <utility>
+
+namespace wolkabout
+{
+PersistenceKeyAdapter::PersistenceKeyAdapter(StringInterner& deviceKeys, StringInterner& references)
+: m_deviceKeys{deviceKeys}, m_references{references}
+{
+}
+
+bool PersistenceKeyAdapter::retainDevice(StringInterner::Id deviceKey)
+{
+    if (m_retainedDevices.count(deviceKey) != 0)
+    {
+        return true;
+    }
+
+    if (!m_deviceKeys.retain(deviceKey))
+    {
+        return false;
+    }
+
+    m_retainedDevices.insert(deviceKey);
+    return true;
+}
+
+StringInterner::Id PersistenceKeyAdapter::retainDevice(const std::string& deviceKey)
+{
+    const auto id = m_deviceKeys.retain(deviceKey);
+    if (!m_retainedDevices.insert(id).second)
+    {
+        m_deviceKeys.release(id);
+    }
+
+    return id;
+}
+
+const std::string& PersistenceKeyAdapter::encode(const PersistenceKey& key)
+{
+    auto it = m_encodedKeys.find(key.pack());
+    if (it == m_encodedKeys.end())
+    {
+        auto encoded = encode(m_deviceKeys.resolve(key.deviceKey), m_references.resolve(key.reference));
+        it = m_encodedKeys.emplace(key.pack(), std::move(encoded)).first;
+        m_decodedKeys.emplace(it->second, key);
+    }
+
+    return it->second;
+}
+
+bool PersistenceKeyAdapter::decode(const std::string& key, PersistenceKey& result)
+{
+    const auto it = m_decodedKeys.find(key);
+    if (it != m_decodedKeys.end())
+    {
+        result = it->second;
+        return true;
+    }
+
+    std::string deviceKey;
+    std::string reference;
+    if (!decode(key, deviceKey, reference))
+    {
+        return false;
+    }
+
+    result = PersistenceKey{retainDevice(deviceKey), m_references.intern(reference)};
+    m_decodedKeys.emplace(key, result);
+    return true;
+}
+
+void PersistenceKeyAdapter::removeDevice(StringInterner::Id deviceKey)
+{
+    for (auto it = m_decodedKeys.begin(); it != m_decodedKeys.end();)
+    {
+        if (it->second.deviceKey == deviceKey)
+        {
+            m_encodedKeys.erase(it->second.pack());
+            it = m_decodedKeys.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    if (m_retainedDevices.erase(deviceKey) != 0)
+    {
+        m_deviceKeys.release(deviceKey);
+    }
+}
+
+std::string PersistenceKeyAdapter::encode(const std::string& deviceKey, const std::string& reference)
+{
+    std::string key;
+    key.reserve(deviceKey.size() + reference.size() + 1);
+
+    escape(deviceKey, key);
+    key.push_back(DELIMITER);
+    escape(reference, key);
+
+    return key;
+}
+
+bool PersistenceKeyAdapter::decode(const std::string& key, std::string& deviceKey, std::string& reference)
+{
+    deviceKey.clear();
+    reference.clear();
+
+    std::string* output = &deviceKey;
+    bool delimiterFound = false;
+
+    for (std::size_t i = 0; i < key.size(); ++i)
+    {
+        const char c = key[i];
+        if (c == ESCAPE)
+        {
+            if (++i == key.size() || (key[i] != DELIMITER && key[i] != ESCAPE))
+            {
+                return decodeUnescaped(key, deviceKey, reference);
+            }
+
+            output->push_back(key[i]);
+        }
+        else if (c == DELIMITER && !delimiterFound)
+        {
+            delimiterFound = true;
+            output = &reference;
+        }
+        else
+        {
+            output->push_back(c);
+        }
+    }
+
+    return delimiterFound && !deviceKey.empty() && !reference.empty();
+}
+
+bool PersistenceKeyAdapter::decodeUnescaped(const std::string& key, std::string& deviceKey, std::string& reference)
+{
+    const auto pos = key.find(DELIMITER);
+    if (pos == std::string::npos)
+    {
+        return false;
+    }
+
+    deviceKey = key.substr(0, pos);
+    reference = key.substr(pos + 1);
+
+    return !deviceKey.empty() && !reference.empty();
+}
+
+void PersistenceKeyAdapter::escape(const std::string& value, std::string& output)
+{
+    for (const char c : value)
+    {
+        if (c == DELIMITER || c == ESCAPE)
+        {
+            output.push_back(ESCAPE);
+        }
+
+        output.push_back(c);
+    }
+}
+}    // namespace wolkabout
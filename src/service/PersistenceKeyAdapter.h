@@ -0,0 +1,88 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PERSISTENCEKEYADAPTER_H
+#define PERSISTENCEKEYADAPTER_H
+
+#include "model/PersistenceKey.h"
+#include "utilities/StringInterner.h"
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+namespace wolkabout
+{
+/**
+ * @brief Converts wolkabout::PersistenceKey to string keys used by wolkabout::Persistence implementations.<br>
+ *        Device key and reference are joined with '+', with '+' and '\' inside them escaped by '\'.
+ *        Keys without those characters are encoded the same as before escaping was introduced.<br>
+ *        Key with '\' which does not escape '+' or '\' was persisted before escaping was introduced,
+ *        and is decoded as before, split on its first '+'.<br>
+ *        Device keys are retained in device key interner while adapter caches keys of the device.
+ */
+class PersistenceKeyAdapter
+{
+public:
+    PersistenceKeyAdapter(StringInterner& deviceKeys, StringInterner& references);
+
+    /**
+     * @brief Retains device key until device is removed, ids of keys passed to encode must be retained
+     * @return false if device key was already freed
+     */
+    bool retainDevice(StringInterner::Id deviceKey);
+
+    StringInterner::Id retainDevice(const std::string& deviceKey);
+
+    /**
+     * @brief Returns encoded key, encoded and decoded forms are cached
+     */
+    const std::string& encode(const PersistenceKey& key);
+
+    /**
+     * @brief Decodes key, interning its parts and retaining its device key; decoded form is cached
+     * @return false if key is not a valid encoded key
+     */
+    bool decode(const std::string& key, PersistenceKey& result);
+
+    /**
+     * @brief Drops cached keys of device and releases its device key
+     */
+    void removeDevice(StringInterner::Id deviceKey);
+
+    static std::string encode(const std::string& deviceKey, const std::string& reference);
+
+    static bool decode(const std::string& key, std::string& deviceKey, std::string& reference);
+
+private:
+    static void escape(const std::string& value, std::string& output);
+
+    static bool decodeUnescaped(const std::string& key, std::string& deviceKey, std::string& reference);
+
+    StringInterner& m_deviceKeys;
+    StringInterner& m_references;
+    std::set<StringInterner::Id> m_retainedDevices;
+
+    std::unordered_map<std::uint64_t, std::string> m_encodedKeys;
+    std::unordered_map<std::string, PersistenceKey> m_decodedKeys;
+
+    static const char DELIMITER = '+';
+    static const char ESCAPE = '\\';
+};
+}    // namespace wolkabout
+
+#endif    // PERSISTENCEKEYADAPTER_H
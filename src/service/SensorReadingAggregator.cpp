@@ -0,0 +1,246 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/SensorReadingAggregator.h"
+
+#include "core/utilities/Logger.h"
+#include "core/utilities/StringUtils.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+
+namespace wolkabout
+{
+const constexpr unsigned int SensorReadingAggregator::FLUSH_CHECKS_PER_DURATION;
+const std::chrono::milliseconds SensorReadingAggregator::MIN_FLUSH_CHECK_INTERVAL{10};
+
+SensorReadingAggregator::SensorReadingAggregator(AggregateHandler aggregateHandler)
+: m_aggregateHandler{std::move(aggregateHandler)}
+{
+}
+
+SensorReadingAggregator::~SensorReadingAggregator()
+{
+    // command thread may start the timer, so it is stopped first
+    m_commandBuffer.stop();
+    m_flushTimer.stop();
+}
+
+void SensorReadingAggregator::setWindow(const std::string& reference, const AggregationWindow& window)
+{
+    if (window.getSamples() == 0)
+    {
+        LOG(ERROR) << "Aggregation window for sensor '" << reference << "' must hold at least one sample";
+        return;
+    }
+
+    for (const auto& output : window.getOutputs())
+    {
+        if (output.second == reference || isAggregated(output.second))
+        {
+            LOG(ERROR) << "Aggregation output '" << output.second << "' of sensor '" << reference
+                       << "' must not be aggregated itself";
+            return;
+        }
+    }
+
+    for (const auto& kvp : m_windows)
+    {
+        for (const auto& output : kvp.second.getOutputs())
+        {
+            if (output.second == reference)
+            {
+                LOG(ERROR) << "Sensor '" << reference << "' is aggregation output of sensor '" << kvp.first << "'";
+                return;
+            }
+        }
+    }
+
+    m_windows.erase(reference);
+    m_windows.emplace(reference, window);
+}
+
+bool SensorReadingAggregator::isAggregated(const std::string& reference) const
+{
+    return m_windows.find(reference) != m_windows.end();
+}
+
+void SensorReadingAggregator::addSample(const std::string& deviceKey, const std::string& reference,
+                                        std::vector<std::string> values, unsigned long long int rtc)
+{
+    addToCommandBuffer([=] { aggregate(deviceKey, reference, values, rtc); });
+}
+
+void SensorReadingAggregator::removeDevice(const std::string& deviceKey)
+{
+    addToCommandBuffer([=] {
+        for (auto it = m_buffers.begin(); it != m_buffers.end();)
+        {
+            it = it->first.first == deviceKey ? m_buffers.erase(it) : std::next(it);
+        }
+    });
+}
+
+void SensorReadingAggregator::aggregate(const std::string& deviceKey, const std::string& reference,
+                                        const std::vector<std::string>& values, unsigned long long int rtc)
+{
+    auto windowIt = m_windows.find(reference);
+    if (windowIt == m_windows.end() || values.empty())
+    {
+        return;
+    }
+
+    const AggregationWindow& window = windowIt->second;
+
+    auto key = std::make_pair(deviceKey, reference);
+    auto bufferIt = m_buffers.find(key);
+    if (bufferIt == m_buffers.end())
+    {
+        SampleBuffer buffer{window.getSamples(), values.size(), 0, 0, 0, {}, {}};
+        buffer.samples.resize(buffer.capacity * buffer.values);
+        bufferIt = m_buffers.emplace(key, std::move(buffer)).first;
+    }
+
+    SampleBuffer& buffer = bufferIt->second;
+
+    if (buffer.values != values.size())
+    {
+        LOG(WARN) << "Number of values changed for aggregated sensor: " << deviceKey << ", " << reference;
+
+        flush(deviceKey, reference, window, buffer);
+        buffer.values = values.size();
+        buffer.samples.assign(buffer.capacity * buffer.values, 0);
+    }
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        char* end = nullptr;
+        const double sample = std::strtod(values[i].c_str(), &end);
+        if (values[i].empty() || end != values[i].c_str() + values[i].size())
+        {
+            LOG(WARN) << "Non numeric value of aggregated sensor dropped: " << deviceKey << ", " << reference;
+            return;
+        }
+
+        buffer.samples[i * buffer.capacity + buffer.count] = sample;
+    }
+
+    if (buffer.count == 0)
+    {
+        buffer.firstRtc = rtc;
+        buffer.opened = std::chrono::steady_clock::now();
+
+        if (window.getDuration().count() != 0 && !m_flushTimer.isRunning())
+        {
+            startFlushTimer();
+        }
+    }
+
+    buffer.lastRtc = rtc;
+    ++buffer.count;
+
+    const auto duration = static_cast<unsigned long long int>(window.getDuration().count());
+    if (buffer.count == buffer.capacity || (duration != 0 && buffer.lastRtc >= buffer.firstRtc + duration))
+    {
+        flush(deviceKey, reference, window, buffer);
+    }
+}
+
+void SensorReadingAggregator::flush(const std::string& deviceKey, const std::string& reference,
+                                    const AggregationWindow& window, SampleBuffer& buffer)
+{
+    if (buffer.count == 0)
+    {
+        return;
+    }
+
+    std::map<AggregationWindow::Function, std::vector<std::string>> results;
+
+    for (std::size_t i = 0; i < buffer.values; ++i)
+    {
+        const double* samples = buffer.samples.data() + i * buffer.capacity;
+
+        double min = samples[0];
+        double max = samples[0];
+        double sum = 0;
+        double sumOfSquares = 0;
+        for (std::size_t j = 0; j < buffer.count; ++j)
+        {
+            min = std::min(min, samples[j]);
+            max = std::max(max, samples[j]);
+            sum += samples[j];
+            sumOfSquares += samples[j] * samples[j];
+        }
+
+        const auto count = static_cast<double>(buffer.count);
+        results[AggregationWindow::Function::MIN].push_back(StringUtils::toString(min));
+        results[AggregationWindow::Function::MAX].push_back(StringUtils::toString(max));
+        results[AggregationWindow::Function::MEAN].push_back(StringUtils::toString(sum / count));
+        results[AggregationWindow::Function::RMS].push_back(StringUtils::toString(std::sqrt(sumOfSquares / count)));
+    }
+
+    const auto rtc = buffer.lastRtc;
+    buffer.count = 0;
+
+    for (const auto& output : window.getOutputs())
+    {
+        m_aggregateHandler(deviceKey, output.second, results[output.first], rtc);
+    }
+}
+
+void SensorReadingAggregator::flushExpired()
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    for (auto& kvp : m_buffers)
+    {
+        const auto windowIt = m_windows.find(kvp.first.second);
+        if (windowIt == m_windows.end())
+        {
+            continue;
+        }
+
+        const auto duration = windowIt->second.getDuration();
+        if (kvp.second.count != 0 && duration.count() != 0 && now - kvp.second.opened >= duration)
+        {
+            flush(kvp.first.first, kvp.first.second, windowIt->second, kvp.second);
+        }
+    }
+}
+
+void SensorReadingAggregator::startFlushTimer()
+{
+    std::chrono::milliseconds shortestDuration{0};
+    for (const auto& kvp : m_windows)
+    {
+        const auto duration = kvp.second.getDuration();
+        if (duration.count() != 0 && (shortestDuration.count() == 0 || duration < shortestDuration))
+        {
+            shortestDuration = duration;
+        }
+    }
+
+    m_flushTimer.run(std::max(shortestDuration / FLUSH_CHECKS_PER_DURATION, MIN_FLUSH_CHECK_INTERVAL),
+                     [=] { addToCommandBuffer([=] { flushExpired(); }); });
+}
+
+void SensorReadingAggregator::addToCommandBuffer(std::function<void()> command)
+{
+    m_commandBuffer.pushCommand(std::make_shared<std::function<void()>>(command));
+}
+}    // namespace wolkabout
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSORREADINGAGGREGATOR_H
+#define SENSORREADINGAGGREGATOR_H
+
+#include "core/utilities/CommandBuffer.h"
+#include "model/AggregationWindow.h"
+#include "utilities/TaskTimer.h"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wolkabout
+{
+typedef std::function<void(const std::string&, const std::string&, const std::vector<std::string>&,
+                           unsigned long long int)>
+  AggregateHandler;
+
+/**
+ * @brief Aggregates samples of sensors with aggregation window on its own thread.<br>
+ *        Windows with duration are also closed by a timer once duration elapses since their first sample,
+ *        so the last window is published even if sensor stops sending samples.
+ */
+class SensorReadingAggregator
+{
+public:
+    explicit SensorReadingAggregator(AggregateHandler aggregateHandler);
+    ~SensorReadingAggregator();
+
+    /**
+     * @brief Registers aggregation window for sensor reference<br>
+     *        Must be called before samples are added
+     */
+    void setWindow(const std::string& reference, const AggregationWindow& window);
+
+    bool isAggregated(const std::string& reference) const;
+
+    /**
+     * @brief Queues sample for aggregation, aggregation itself is performed on aggregator's own thread<br>
+     *        This method is thread safe
+     */
+    void addSample(const std::string& deviceKey, const std::string& reference, std::vector<std::string> values,
+                   unsigned long long int rtc);
+
+    void removeDevice(const std::string& deviceKey);
+
+private:
+    /**
+     * Samples of each value are stored contiguously: value 'i' occupies [i * capacity, i * capacity + count)
+     */
+    struct SampleBuffer
+    {
+        std::size_t capacity;
+        std::size_t values;
+        std::size_t count;
+        unsigned long long int firstRtc;
+        unsigned long long int lastRtc;
+        std::chrono::steady_clock::time_point opened;
+        std::vector<double> samples;
+    };
+
+    void aggregate(const std::string& deviceKey, const std::string& reference, const std::vector<std::string>& values,
+                   unsigned long long int rtc);
+
+    void flush(const std::string& deviceKey, const std::string& reference, const AggregationWindow& window,
+               SampleBuffer& buffer);
+
+    void flushExpired();
+
+    void startFlushTimer();
+
+    void addToCommandBuffer(std::function<void()> command);
+
+    AggregateHandler m_aggregateHandler;
+
+    std::map<std::string, AggregationWindow> m_windows;
+
+    std::map<std::pair<std::string, std::string>, SampleBuffer> m_buffers;
+
+    CommandBuffer m_commandBuffer;
+
+    // closes windows whose duration elapsed, started by the first window with duration
+    TaskTimer m_flushTimer;
+
+    static const constexpr unsigned int FLUSH_CHECKS_PER_DURATION = 4;
+    static const std::chrono::milliseconds MIN_FLUSH_CHECK_INTERVAL;
+};
+}    // namespace wolkabout
+
+#endif    // SENSORREADINGAGGREGATOR_H
@@ -0,0 +1,175 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/SensorReadingFilter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace wolkabout
+{
+namespace
+{
+bool parseNumber(const std::string& value, double& number)
+{
+    if (value.empty())
+    {
+        return false;
+    }
+
+    char* end = nullptr;
+    number = std::strtod(value.c_str(), &end);
+    return end == value.c_str() + value.size();
+}
+}    // namespace
+
+SensorReadingFilter::SensorReadingFilter() : m_hasFilters{false}, m_accepted{0}, m_suppressed{0} {}
+
+void SensorReadingFilter::setFilter(const std::string& reference, const DeadbandFilter& filter)
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+
+    m_referenceFilters.erase(reference);
+    m_referenceFilters.emplace(reference, filter);
+    m_hasFilters = true;
+}
+
+void SensorReadingFilter::setFilter(const std::string& deviceKey, const std::string& reference,
+                                    const DeadbandFilter& filter)
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+
+    const auto key = std::make_pair(deviceKey, reference);
+    m_deviceFilters.erase(key);
+    m_deviceFilters.emplace(key, filter);
+    m_hasFilters = true;
+}
+
+void SensorReadingFilter::removeDevice(const std::string& deviceKey)
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+
+    for (auto it = m_lastReadings.begin(); it != m_lastReadings.end();)
+    {
+        it = it->first.first == deviceKey ? m_lastReadings.erase(it) : std::next(it);
+    }
+
+    for (auto it = m_deviceFilters.begin(); it != m_deviceFilters.end();)
+    {
+        it = it->first.first == deviceKey ? m_deviceFilters.erase(it) : std::next(it);
+    }
+}
+
+bool SensorReadingFilter::accept(const std::string& deviceKey, const std::string& reference,
+                                 const std::vector<std::string>& values, unsigned long long int rtc)
+{
+    if (!m_hasFilters)
+    {
+        return true;
+    }
+
+    const auto key = std::make_pair(deviceKey, reference);
+
+    std::lock_guard<std::mutex> lg{m_lock};
+
+    const DeadbandFilter* filter = findFilter(key);
+    if (!filter)
+    {
+        return true;
+    }
+
+    auto it = m_lastReadings.find(key);
+    if (it != m_lastReadings.end())
+    {
+        const auto maxSilence = static_cast<unsigned long long int>(filter->getMaxSilence().count());
+        const bool silenceExceeded = maxSilence != 0 && rtc >= it->second.rtc + maxSilence;
+
+        if (!silenceExceeded && isWithinDeadband(*filter, it->second.values, values))
+        {
+            ++m_suppressed;
+            return false;
+        }
+
+        it->second.values = values;
+        it->second.rtc = rtc;
+    }
+    else
+    {
+        m_lastReadings.emplace(key, LastReading{values, rtc});
+    }
+
+    ++m_accepted;
+    return true;
+}
+
+DeadbandFilterStatistics SensorReadingFilter::getStatistics() const
+{
+    return DeadbandFilterStatistics{m_accepted, m_suppressed};
+}
+
+const DeadbandFilter* SensorReadingFilter::findFilter(const std::pair<std::string, std::string>& key) const
+{
+    auto deviceFilterIt = m_deviceFilters.find(key);
+    if (deviceFilterIt != m_deviceFilters.end())
+    {
+        return &deviceFilterIt->second;
+    }
+
+    auto referenceFilterIt = m_referenceFilters.find(key.second);
+    if (referenceFilterIt != m_referenceFilters.end())
+    {
+        return &referenceFilterIt->second;
+    }
+
+    return nullptr;
+}
+
+bool SensorReadingFilter::isWithinDeadband(const DeadbandFilter& filter, const std::vector<std::string>& lastValues,
+                                           const std::vector<std::string>& values)
+{
+    if (lastValues.size() != values.size())
+    {
+        return false;
+    }
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (!isWithinDeadband(filter, lastValues[i], values[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SensorReadingFilter::isWithinDeadband(const DeadbandFilter& filter, const std::string& lastValue,
+                                           const std::string& value)
+{
+    double lastNumber = 0;
+    double number = 0;
+    if (!parseNumber(lastValue, lastNumber) || !parseNumber(value, number))
+    {
+        return lastValue == value;
+    }
+
+    const double threshold =
+      std::max(filter.getAbsoluteDeadband(), std::fabs(lastNumber) * filter.getPercentDeadband() / 100.0);
+
+    return std::fabs(number - lastNumber) <= threshold;
+}
+}    // namespace wolkabout
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SENSORREADINGFILTER_H
+#define SENSORREADINGFILTER_H
+
+#include "model/DeadbandFilter.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wolkabout
+{
+class SensorReadingFilter
+{
+public:
+    SensorReadingFilter();
+
+    /**
+     * @brief Sets filter for every device that has sensor with given reference
+     */
+    void setFilter(const std::string& reference, const DeadbandFilter& filter);
+
+    /**
+     * @brief Sets filter for sensor of a single device, overrides filter set for the reference
+     */
+    void setFilter(const std::string& deviceKey, const std::string& reference, const DeadbandFilter& filter);
+
+    void removeDevice(const std::string& deviceKey);
+
+    /**
+     * @brief Decides whether reading should be published, and if so remembers it as last accepted reading<br>
+     *        This method is thread safe
+     * @return true if reading should be published, false if it is suppressed
+     */
+    bool accept(const std::string& deviceKey, const std::string& reference, const std::vector<std::string>& values,
+                unsigned long long int rtc);
+
+    DeadbandFilterStatistics getStatistics() const;
+
+private:
+    struct LastReading
+    {
+        std::vector<std::string> values;
+        unsigned long long int rtc;
+    };
+
+    const DeadbandFilter* findFilter(const std::pair<std::string, std::string>& key) const;
+
+    static bool isWithinDeadband(const DeadbandFilter& filter, const std::vector<std::string>& lastValues,
+                                 const std::vector<std::string>& values);
+    static bool isWithinDeadband(const DeadbandFilter& filter, const std::string& lastValue, const std::string& value);
+
+    std::atomic_bool m_hasFilters;
+
+    mutable std::mutex m_lock;
+    std::map<std::string, DeadbandFilter> m_referenceFilters;
+    std::map<std::pair<std::string, std::string>, DeadbandFilter> m_deviceFilters;
+    std::map<std::pair<std::string, std::string>, LastReading> m_lastReadings;
+
+    std::atomic<std::uint64_t> m_accepted;
+    std::atomic<std::uint64_t> m_suppressed;
+};
+}    // namespace wolkabout
+
+#endif    // SENSORREADINGFILTER_H
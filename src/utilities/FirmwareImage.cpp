@@ -0,0 +1,140 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/FirmwareImage.h"
+
+#include "utilities/Sha256.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+const std::size_t HASH_READ_SIZE = 1024 * 1024;
+}
+
+namespace wolkabout
+{
+FirmwareImage::ChunkReader::ChunkReader(std::shared_ptr<const FirmwareImage> image, std::size_t chunkSize)
+: m_image{std::move(image)}, m_chunkSize{chunkSize != 0 ? chunkSize : 1}, m_offset{0}
+{
+}
+
+bool FirmwareImage::ChunkReader::next(const std::uint8_t*& data, std::size_t& size)
+{
+    if (m_offset >= m_image->getSize())
+    {
+        return false;
+    }
+
+    data = m_image->getData() + m_offset;
+    size = static_cast<std::size_t>(std::min<std::uint64_t>(m_chunkSize, m_image->getSize() - m_offset));
+    m_offset += size;
+
+    return true;
+}
+
+std::uint64_t FirmwareImage::ChunkReader::getOffset() const
+{
+    return m_offset;
+}
+
+FirmwareImage::FirmwareImage(std::string path, const std::uint8_t* data, std::size_t size, std::string sha256)
+: m_path{std::move(path)}, m_data{data}, m_size{size}, m_sha256{std::move(sha256)}
+{
+    if (!m_sha256.empty())
+    {
+        return;
+    }
+
+    Sha256 digest;
+
+    // large sequential reads, kernel reads ahead of the mapping with MADV_SEQUENTIAL
+    for (std::size_t offset = 0; offset < m_size; offset += HASH_READ_SIZE)
+    {
+        digest.update(m_data + offset, std::min(HASH_READ_SIZE, m_size - offset));
+    }
+
+    m_sha256 = digest.finish();
+}
+
+FirmwareImage::~FirmwareImage()
+{
+    if (m_size != 0)
+    {
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+}
+
+std::shared_ptr<FirmwareImage> FirmwareImage::open(const std::string& path, const std::string& sha256)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return nullptr;
+    }
+
+    struct stat fileStat;
+    if (fstat(fd, &fileStat) != 0 || !S_ISREG(fileStat.st_mode))
+    {
+        close(fd);
+        return nullptr;
+    }
+
+    const auto size = static_cast<std::size_t>(fileStat.st_size);
+    if (size == 0)
+    {
+        close(fd);
+        return std::shared_ptr<FirmwareImage>(new FirmwareImage(path, nullptr, 0, sha256));
+    }
+
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (mapping == MAP_FAILED)
+    {
+        return nullptr;
+    }
+
+    madvise(mapping, size, MADV_SEQUENTIAL);
+
+    return std::shared_ptr<FirmwareImage>(
+      new FirmwareImage(path, static_cast<const std::uint8_t*>(mapping), size, sha256));
+}
+
+const std::string& FirmwareImage::getPath() const
+{
+    return m_path;
+}
+
+std::uint64_t FirmwareImage::getSize() const
+{
+    return m_size;
+}
+
+const std::string& FirmwareImage::getSha256() const
+{
+    return m_sha256;
+}
+
+const std::uint8_t* FirmwareImage::getData() const
+{
+    return m_data;
+}
+}    // namespace wolkabout
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRMWAREIMAGE_H
+#define FIRMWAREIMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace wolkabout
+{
+/**
+ * @brief Read only firmware file mapped into memory, with SHA-256 digest computed when opened.<br>
+ *        Image content is paged in on demand, so it is never loaded into memory as a whole.
+ */
+class FirmwareImage
+{
+public:
+    /**
+     * @brief Iterates over image content in chunks of fixed size, last chunk may be shorter
+     */
+    class ChunkReader
+    {
+    public:
+        ChunkReader(std::shared_ptr<const FirmwareImage> image, std::size_t chunkSize);
+
+        /**
+         * @brief Points data to next chunk, valid while image is alive
+         * @return false when there are no more chunks
+         */
+        bool next(const std::uint8_t*& data, std::size_t& size);
+
+        std::uint64_t getOffset() const;
+
+    private:
+        std::shared_ptr<const FirmwareImage> m_image;
+        std::size_t m_chunkSize;
+        std::uint64_t m_offset;
+    };
+
+    ~FirmwareImage();
+
+    FirmwareImage(const FirmwareImage&) = delete;
+    FirmwareImage& operator=(const FirmwareImage&) = delete;
+
+    /**
+     * @param sha256 Known digest of file content, computed from file if empty
+     * @return nullptr if file can not be opened and mapped
+     */
+    static std::shared_ptr<FirmwareImage> open(const std::string& path, const std::string& sha256 = "");
+
+    const std::string& getPath() const;
+    std::uint64_t getSize() const;
+    const std::string& getSha256() const;
+
+    const std::uint8_t* getData() const;
+
+private:
+    FirmwareImage(std::string path, const std::uint8_t* data, std::size_t size, std::string sha256);
+
+    const std::string m_path;
+    const std::uint8_t* m_data;
+    const std::size_t m_size;
+    std::string m_sha256;
+};
+}    // namespace wolkabout
+
+#endif    // FIRMWAREIMAGE_H
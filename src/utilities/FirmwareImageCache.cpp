@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/FirmwareImageCache.h"
+
+#include <sys/stat.h>
+
+namespace wolkabout
+{
+std::shared_ptr<const FirmwareImage> FirmwareImageCache::get(const std::string& path)
+{
+    FileIdentity identity;
+    if (!getIdentity(path, identity))
+    {
+        m_entries.erase(path);
+        return nullptr;
+    }
+
+    auto it = m_entries.find(path);
+    if (it != m_entries.end() && it->second.identity == identity)
+    {
+        if (auto image = it->second.image.lock())
+        {
+            return image;
+        }
+
+        std::shared_ptr<const FirmwareImage> image = FirmwareImage::open(path, it->second.sha256);
+        it->second.image = image;
+        return image;
+    }
+
+    std::shared_ptr<const FirmwareImage> image = FirmwareImage::open(path);
+    if (!image)
+    {
+        m_entries.erase(path);
+        return nullptr;
+    }
+
+    m_entries[path] = Entry{identity, image->getSha256(), image};
+    return image;
+}
+
+bool FirmwareImageCache::FileIdentity::operator==(const FileIdentity& other) const
+{
+    return device == other.device && inode == other.inode && size == other.size &&
+           modificationSeconds == other.modificationSeconds &&
+           modificationNanoseconds == other.modificationNanoseconds;
+}
+
+bool FirmwareImageCache::getIdentity(const std::string& path, FileIdentity& identity)
+{
+    struct stat fileStat;
+    if (stat(path.c_str(), &fileStat) != 0)
+    {
+        return false;
+    }
+
+    identity = FileIdentity{static_cast<std::uint64_t>(fileStat.st_dev), static_cast<std::uint64_t>(fileStat.st_ino),
+                            static_cast<std::int64_t>(fileStat.st_size),
+                            static_cast<std::int64_t>(fileStat.st_mtim.tv_sec),
+                            static_cast<std::int64_t>(fileStat.st_mtim.tv_nsec)};
+    return true;
+}
+}    // namespace wolkabout
@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef FIRMWAREIMAGECACHE_H
+#define FIRMWAREIMAGECACHE_H
+
+#include "utilities/FirmwareImage.h"
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace wolkabout
+{
+/**
+ * @brief Opens firmware images, digest of each file is computed once and reused while file is unchanged.<br>
+ *        File is considered unchanged while its device, inode, size and modification time are the same.
+ *        Images are shared while in use, and unmapped once no longer referenced. Not thread safe.
+ */
+class FirmwareImageCache
+{
+public:
+    /**
+     * @return nullptr if file can not be opened
+     */
+    std::shared_ptr<const FirmwareImage> get(const std::string& path);
+
+private:
+    struct FileIdentity
+    {
+        std::uint64_t device;
+        std::uint64_t inode;
+        std::int64_t size;
+        std::int64_t modificationSeconds;
+        std::int64_t modificationNanoseconds;
+
+        bool operator==(const FileIdentity& other) const;
+    };
+
+    struct Entry
+    {
+        FileIdentity identity;
+        std::string sha256;
+        std::weak_ptr<const FirmwareImage> image;
+    };
+
+    static bool getIdentity(const std::string& path, FileIdentity& identity);
+
+    std::map<std::string, Entry> m_entries;
+};
+}    // namespace wolkabout
+
+#endif    // FIRMWAREIMAGECACHE_H
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/LogRateLimiter.h"
+
+#include <utility>
+
+namespace wolkabout
+{
+LogRateLimiter::LogRateLimiter(double messagesPerSecond, double burst, TokenBucketClock clock)
+: m_bucket{messagesPerSecond, burst, std::move(clock)}, m_suppressed{0}
+{
+}
+
+bool LogRateLimiter::tryAcquire(std::uint64_t& suppressed)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    if (!m_bucket.tryConsume(1))
+    {
+        ++m_suppressed;
+        return false;
+    }
+
+    suppressed = m_suppressed;
+    m_suppressed = 0;
+    return true;
+}
+}    // namespace wolkabout
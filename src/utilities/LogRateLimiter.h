@@ -0,0 +1,55 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LOGRATELIMITER_H
+#define LOGRATELIMITER_H
+
+#include "utilities/TokenBucket.h"
+
+#include <cstdint>
+#include <mutex>
+
+namespace wolkabout
+{
+/**
+ * @brief Limits number of log messages per second, counting messages that were suppressed.<br>
+ *        This class is thread safe.
+ */
+class LogRateLimiter
+{
+public:
+    /**
+     * @param messagesPerSecond Sustained number of messages logged per second
+     * @param burst Number of messages that can be logged at once
+     * @param clock Source of time, steady clock if not set
+     */
+    LogRateLimiter(double messagesPerSecond, double burst, TokenBucketClock clock = nullptr);
+
+    /**
+     * @param suppressed Set to number of messages suppressed since last permitted message
+     * @return true if message should be logged
+     */
+    bool tryAcquire(std::uint64_t& suppressed);
+
+private:
+    std::mutex m_lock;
+
+    TokenBucket m_bucket;
+    std::uint64_t m_suppressed;
+};
+}    // namespace wolkabout
+
+#endif    // LOGRATELIMITER_H
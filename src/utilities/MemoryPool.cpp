@@ -0,0 +1,112 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/MemoryPool.h"
+
+#include <algorithm>
+#include <new>
+
+namespace wolkabout
+{
+const constexpr std::size_t MemoryPool::MAX_BLOCK_SIZE;
+
+MemoryPool::MemoryPool(std::size_t blocksPerSlab)
+: m_blocksPerSlab{blocksPerSlab != 0 ? blocksPerSlab : 1}
+, m_reservedBytes{0}
+, m_blocksInUse{0}
+, m_allocations{0}
+, m_reused{0}
+{
+}
+
+void* MemoryPool::allocate(std::size_t size)
+{
+    const auto blockSize = getBlockSize(size);
+    if (blockSize > MAX_BLOCK_SIZE)
+    {
+        return ::operator new(size);
+    }
+
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    ++m_allocations;
+    ++m_blocksInUse;
+
+    auto& freeList = m_freeLists[blockSize];
+    if (freeList != nullptr)
+    {
+        ++m_reused;
+
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        return block;
+    }
+
+    std::unique_ptr<char[]> slab{new char[blockSize * m_blocksPerSlab]};
+    char* first = slab.get();
+
+    // first block is returned, the rest are chained into free list
+    for (std::size_t i = m_blocksPerSlab - 1; i > 0; --i)
+    {
+        auto block = reinterpret_cast<FreeBlock*>(first + i * blockSize);
+        block->next = freeList;
+        freeList = block;
+    }
+
+    m_slabs.push_back(std::move(slab));
+    m_reservedBytes += blockSize * m_blocksPerSlab;
+
+    return first;
+}
+
+void MemoryPool::deallocate(void* block, std::size_t size)
+{
+    if (block == nullptr)
+    {
+        return;
+    }
+
+    const auto blockSize = getBlockSize(size);
+    if (blockSize > MAX_BLOCK_SIZE)
+    {
+        ::operator delete(block);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    auto freeBlock = static_cast<FreeBlock*>(block);
+    auto& freeList = m_freeLists[blockSize];
+    freeBlock->next = freeList;
+    freeList = freeBlock;
+
+    --m_blocksInUse;
+}
+
+MemoryPoolStatistics MemoryPool::getStatistics() const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    return MemoryPoolStatistics{m_slabs.size(), m_reservedBytes, m_blocksInUse, m_allocations, m_reused};
+}
+
+std::size_t MemoryPool::getBlockSize(std::size_t size)
+{
+    const std::size_t alignment = alignof(std::max_align_t);
+    const auto blockSize = std::max(size, sizeof(FreeBlock));
+    return (blockSize + alignment - 1) / alignment * alignment;
+}
+}    // namespace wolkabout
@@ -0,0 +1,77 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef MEMORYPOOL_H
+#define MEMORYPOOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace wolkabout
+{
+struct MemoryPoolStatistics
+{
+    std::size_t slabs;
+    std::size_t reservedBytes;
+    std::size_t blocksInUse;
+    std::uint64_t allocations;
+    std::uint64_t reused;
+};
+
+/**
+ * @brief Allocates fixed size blocks from slabs, freed blocks are kept in per size free lists and reused.<br>
+ *        Slabs are released only when the pool is destroyed, so reserved memory stays at its peak usage.
+ *        Blocks larger than MAX_BLOCK_SIZE are allocated with operator new. This class is thread safe.
+ */
+class MemoryPool
+{
+public:
+    explicit MemoryPool(std::size_t blocksPerSlab = 64);
+
+    void* allocate(std::size_t size);
+    void deallocate(void* block, std::size_t size);
+
+    MemoryPoolStatistics getStatistics() const;
+
+    static const constexpr std::size_t MAX_BLOCK_SIZE = 512;
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    static std::size_t getBlockSize(std::size_t size);
+
+    const std::size_t m_blocksPerSlab;
+
+    mutable std::mutex m_lock;
+
+    std::map<std::size_t, FreeBlock*> m_freeLists;
+    std::vector<std::unique_ptr<char[]>> m_slabs;
+
+    std::size_t m_reservedBytes;
+    std::size_t m_blocksInUse;
+    std::uint64_t m_allocations;
+    std::uint64_t m_reused;
+};
+}    // namespace wolkabout
+
+#endif    // MEMORYPOOL_H
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef POOLALLOCATOR_H
+#define POOLALLOCATOR_H
+
+#include "utilities/MemoryPool.h"
+
+#include <cstddef>
+#include <memory>
+
+namespace wolkabout
+{
+/**
+ * @brief Standard allocator backed by wolkabout::MemoryPool, intended for std::allocate_shared.<br>
+ *        Allocator shares ownership of the pool, so pooled objects may outlive their creator.
+ */
+template <typename T> class PoolAllocator
+{
+public:
+    typedef T value_type;
+
+    explicit PoolAllocator(std::shared_ptr<MemoryPool> pool) : m_pool{std::move(pool)} {}
+
+    template <typename U> PoolAllocator(const PoolAllocator<U>& other) : m_pool{other.getPool()} {}
+
+    T* allocate(std::size_t n) { return static_cast<T*>(m_pool->allocate(n * sizeof(T))); }
+
+    void deallocate(T* p, std::size_t n) { m_pool->deallocate(p, n * sizeof(T)); }
+
+    const std::shared_ptr<MemoryPool>& getPool() const { return m_pool; }
+
+private:
+    std::shared_ptr<MemoryPool> m_pool;
+};
+
+template <typename T, typename U> bool operator==(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+    return lhs.getPool() == rhs.getPool();
+}
+
+template <typename T, typename U> bool operator!=(const PoolAllocator<T>& lhs, const PoolAllocator<U>& rhs)
+{
+    return !(lhs == rhs);
+}
+}    // namespace wolkabout
+
+#endif    // POOLALLOCATOR_H
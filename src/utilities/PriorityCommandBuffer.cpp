@@ -0,0 +1,252 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/PriorityCommandBuffer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace wolkabout
+{
+const constexpr std::size_t PriorityCommandBuffer::CONTROL_BURST;
+
+PriorityCommandBuffer::PriorityCommandBuffer()
+: m_isRunning{true}
+, m_controlLane{{}, 0, 0, 0, 0, 0, 0, 0, AdmissionPolicy::REJECT, std::chrono::milliseconds{0}, false}
+, m_telemetryLane{{}, 0, 0, 0, 0, 0, 0, 0, AdmissionPolicy::REJECT, std::chrono::milliseconds{0}, false}
+, m_controlStreak{0}
+{
+    m_worker = std::thread(&PriorityCommandBuffer::run, this);
+}
+
+PriorityCommandBuffer::~PriorityCommandBuffer()
+{
+    stop();
+}
+
+bool PriorityCommandBuffer::pushCommand(std::function<void()> command, CommandLane lane, bool bypassCapacity)
+{
+    bool becameSaturated = false;
+
+    {
+        std::unique_lock<std::mutex> lock{m_lock};
+        Lane& commandLane = getLane(lane);
+
+        if (!bypassCapacity && commandLane.capacity != 0 && commandLane.admitted >= commandLane.capacity)
+        {
+            becameSaturated = !commandLane.saturated;
+            commandLane.saturated = true;
+
+            const bool isWorker = std::this_thread::get_id() == m_worker.get_id();
+            if (commandLane.policy == AdmissionPolicy::BLOCK && !isWorker)
+            {
+                m_spaceAvailable.wait_for(lock, commandLane.blockTimeout, [&] {
+                    return !m_isRunning || commandLane.admitted < commandLane.capacity;
+                });
+            }
+
+            if (commandLane.admitted >= commandLane.capacity && !isWorker)
+            {
+                if (commandLane.policy == AdmissionPolicy::DROP_OLDEST)
+                {
+                    // commands which bypassed capacity are system work (drains, completions) and are never dropped
+                    const auto oldest = std::find_if(commandLane.commands.begin(), commandLane.commands.end(),
+                                                     [](const Command& waiting) { return !waiting.bypassCapacity; });
+                    commandLane.commands.erase(oldest);
+                    --commandLane.admitted;
+                    ++commandLane.dropped;
+                }
+                else
+                {
+                    ++commandLane.rejected;
+
+                    lock.unlock();
+                    if (becameSaturated)
+                    {
+                        notifySaturation(lane, true);
+                    }
+                    return false;
+                }
+            }
+        }
+
+        commandLane.commands.push_back(Command{std::move(command), std::chrono::steady_clock::now(), bypassCapacity});
+        if (!bypassCapacity)
+        {
+            ++commandLane.admitted;
+        }
+    }
+
+    m_condition.notify_one();
+
+    if (becameSaturated)
+    {
+        notifySaturation(lane, true);
+    }
+
+    return true;
+}
+
+void PriorityCommandBuffer::setCapacity(CommandLane lane, std::size_t capacity, AdmissionPolicy policy,
+                                        std::chrono::milliseconds blockTimeout)
+{
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+
+        Lane& commandLane = getLane(lane);
+        commandLane.capacity = capacity;
+        commandLane.policy = policy;
+        commandLane.blockTimeout = blockTimeout;
+    }
+
+    m_spaceAvailable.notify_all();
+}
+
+void PriorityCommandBuffer::setSaturationHandler(std::function<void(CommandLane, bool)> handler)
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+    m_saturationHandler = std::move(handler);
+}
+
+void PriorityCommandBuffer::stop()
+{
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_isRunning = false;
+    }
+
+    m_condition.notify_all();
+    m_spaceAvailable.notify_all();
+
+    if (m_worker.joinable() && m_worker.get_id() != std::this_thread::get_id())
+    {
+        m_worker.join();
+    }
+}
+
+CommandLaneStatistics PriorityCommandBuffer::getStatistics(CommandLane lane) const
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+
+    const Lane& commandLane = getLane(lane);
+    return CommandLaneStatistics{commandLane.commands.size(), commandLane.executed, commandLane.totalWaitMicroseconds,
+                                 commandLane.maxWaitMicroseconds, commandLane.rejected, commandLane.dropped};
+}
+
+void PriorityCommandBuffer::run()
+{
+    std::unique_lock<std::mutex> lock{m_lock};
+
+    while (true)
+    {
+        m_condition.wait(lock, [&] {
+            return !m_isRunning || !m_controlLane.commands.empty() || !m_telemetryLane.commands.empty();
+        });
+
+        if (!m_isRunning)
+        {
+            return;
+        }
+
+        const CommandLane laneId = nextLane();
+        Lane& lane = getLane(laneId);
+
+        Command command = std::move(lane.commands.front());
+        lane.commands.pop_front();
+        if (!command.bypassCapacity)
+        {
+            --lane.admitted;
+        }
+
+        const auto wait = static_cast<std::uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - command.enqueued)
+            .count());
+        ++lane.executed;
+        lane.totalWaitMicroseconds += wait;
+        lane.maxWaitMicroseconds = std::max(lane.maxWaitMicroseconds, wait);
+
+        bool becameDrained = false;
+        if (lane.capacity != 0)
+        {
+            m_spaceAvailable.notify_one();
+
+            if (lane.saturated && lane.admitted <= lane.capacity / 2)
+            {
+                lane.saturated = false;
+                becameDrained = true;
+            }
+        }
+
+        lock.unlock();
+
+        if (becameDrained)
+        {
+            notifySaturation(laneId, false);
+        }
+
+        command.function();
+        lock.lock();
+    }
+}
+
+CommandLane PriorityCommandBuffer::nextLane()
+{
+    if (m_controlLane.commands.empty())
+    {
+        m_controlStreak = 0;
+        return CommandLane::TELEMETRY;
+    }
+
+    if (m_telemetryLane.commands.empty())
+    {
+        m_controlStreak = 0;
+        return CommandLane::CONTROL;
+    }
+
+    if (m_controlStreak >= CONTROL_BURST)
+    {
+        m_controlStreak = 0;
+        return CommandLane::TELEMETRY;
+    }
+
+    ++m_controlStreak;
+    return CommandLane::CONTROL;
+}
+
+void PriorityCommandBuffer::notifySaturation(CommandLane lane, bool saturated)
+{
+    std::function<void(CommandLane, bool)> handler;
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        handler = m_saturationHandler;
+    }
+
+    if (handler)
+    {
+        handler(lane, saturated);
+    }
+}
+
+PriorityCommandBuffer::Lane& PriorityCommandBuffer::getLane(CommandLane lane)
+{
+    return lane == CommandLane::CONTROL ? m_controlLane : m_telemetryLane;
+}
+
+const PriorityCommandBuffer::Lane& PriorityCommandBuffer::getLane(CommandLane lane) const
+{
+    return lane == CommandLane::CONTROL ? m_controlLane : m_telemetryLane;
+}
+}    // namespace wolkabout
@@ -0,0 +1,147 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PRIORITYCOMMANDBUFFER_H
+#define PRIORITYCOMMANDBUFFER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace wolkabout
+{
+enum class CommandLane
+{
+    CONTROL,
+    TELEMETRY
+};
+
+enum class AdmissionPolicy
+{
+    BLOCK,
+    REJECT,
+    DROP_OLDEST
+};
+
+struct CommandLaneStatistics
+{
+    std::size_t depth;
+    std::uint64_t executed;
+    std::uint64_t totalWaitMicroseconds;
+    std::uint64_t maxWaitMicroseconds;
+    std::uint64_t rejected;
+    std::uint64_t dropped;
+};
+
+/**
+ * @brief Executes commands on a single thread, commands in CONTROL lane are executed before
+ *        commands waiting in TELEMETRY lane. Order of commands within a lane is preserved.<br>
+ *        To keep TELEMETRY lane from starving, one of its commands is executed after every
+ *        CONTROL_BURST consecutive CONTROL commands executed while it was waiting.<br>
+ *        Lanes are unbounded unless capacity is set. Commands pushed from the executing thread itself
+ *        are never blocked, since that thread is the one freeing the space.<br>
+ *        Commands pushed with bypassCapacity do not count towards capacity and are never dropped.
+ */
+class PriorityCommandBuffer
+{
+public:
+    PriorityCommandBuffer();
+    ~PriorityCommandBuffer();
+
+    /**
+     * @brief Pushes command to lane
+     * @param bypassCapacity Admits command even if lane is full
+     * @return false if command was not admitted because the lane is full
+     */
+    bool pushCommand(std::function<void()> command, CommandLane lane, bool bypassCapacity = false);
+
+    /**
+     * @brief Limits number of commands waiting in lane
+     * @param lane Command lane
+     * @param capacity Maximum number of waiting commands, 0 for unbounded
+     * @param policy Applied when lane is full
+     * @param blockTimeout Maximum time pushCommand waits for space with AdmissionPolicy::BLOCK
+     */
+    void setCapacity(CommandLane lane, std::size_t capacity, AdmissionPolicy policy,
+                     std::chrono::milliseconds blockTimeout = std::chrono::milliseconds{0});
+
+    /**
+     * @brief Handler is called with true when lane becomes full, and with false once it drains to half of its capacity
+     */
+    void setSaturationHandler(std::function<void(CommandLane lane, bool saturated)> handler);
+
+    void stop();
+
+    CommandLaneStatistics getStatistics(CommandLane lane) const;
+
+private:
+    struct Command
+    {
+        std::function<void()> function;
+        std::chrono::steady_clock::time_point enqueued;
+        bool bypassCapacity;
+    };
+
+    struct Lane
+    {
+        std::deque<Command> commands;
+        // number of waiting commands subject to capacity
+        std::size_t admitted;
+        std::uint64_t executed;
+        std::uint64_t totalWaitMicroseconds;
+        std::uint64_t maxWaitMicroseconds;
+        std::uint64_t rejected;
+        std::uint64_t dropped;
+
+        std::size_t capacity;
+        AdmissionPolicy policy;
+        std::chrono::milliseconds blockTimeout;
+        bool saturated;
+    };
+
+    void run();
+
+    CommandLane nextLane();
+
+    void notifySaturation(CommandLane lane, bool saturated);
+
+    Lane& getLane(CommandLane lane);
+    const Lane& getLane(CommandLane lane) const;
+
+    mutable std::mutex m_lock;
+    std::condition_variable m_condition;
+    std::condition_variable m_spaceAvailable;
+
+    bool m_isRunning;
+
+    Lane m_controlLane;
+    Lane m_telemetryLane;
+
+    // CONTROL commands executed in a row while TELEMETRY lane was waiting
+    std::size_t m_controlStreak;
+    static const constexpr std::size_t CONTROL_BURST = 16;
+
+    std::function<void(CommandLane, bool)> m_saturationHandler;
+
+    std::thread m_worker;
+};
+}    // namespace wolkabout
+
+#endif    // PRIORITYCOMMANDBUFFER_H
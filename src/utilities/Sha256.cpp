@@ -0,0 +1,164 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/Sha256.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+const std::uint32_t ROUND_CONSTANTS[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+inline std::uint32_t rotateRight(std::uint32_t value, unsigned int count)
+{
+    return (value >> count) | (value << (32 - count));
+}
+}    // namespace
+
+namespace wolkabout
+{
+Sha256::Sha256()
+: m_state{{0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19}}
+, m_buffer()
+, m_bufferSize{0}
+, m_totalSize{0}
+{
+}
+
+void Sha256::update(const std::uint8_t* data, std::size_t size)
+{
+    m_totalSize += size;
+
+    if (m_bufferSize != 0)
+    {
+        const std::size_t count = std::min(size, m_buffer.size() - m_bufferSize);
+        std::memcpy(m_buffer.data() + m_bufferSize, data, count);
+        m_bufferSize += count;
+        data += count;
+        size -= count;
+
+        if (m_bufferSize < m_buffer.size())
+        {
+            return;
+        }
+
+        processBlock(m_buffer.data());
+        m_bufferSize = 0;
+    }
+
+    // whole blocks are processed in place, without copying
+    while (size >= m_buffer.size())
+    {
+        processBlock(data);
+        data += m_buffer.size();
+        size -= m_buffer.size();
+    }
+
+    std::memcpy(m_buffer.data(), data, size);
+    m_bufferSize = size;
+}
+
+std::string Sha256::finish()
+{
+    const std::uint64_t totalBits = m_totalSize * 8;
+
+    std::uint8_t padding[72] = {0x80};
+    const std::size_t paddingSize = (m_bufferSize < 56 ? 56 : 120) - m_bufferSize;
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        padding[paddingSize + i] = static_cast<std::uint8_t>(totalBits >> (56 - 8 * i));
+    }
+
+    update(padding, paddingSize + 8);
+
+    static const char* HEX_DIGITS = "0123456789abcdef";
+
+    std::string digest;
+    digest.reserve(64);
+    for (const auto word : m_state)
+    {
+        for (int shift = 28; shift >= 0; shift -= 4)
+        {
+            digest.push_back(HEX_DIGITS[(word >> shift) & 0xf]);
+        }
+    }
+
+    return digest;
+}
+
+void Sha256::processBlock(const std::uint8_t* block)
+{
+    std::uint32_t w[64];
+    for (std::size_t i = 0; i < 16; ++i)
+    {
+        w[i] = (static_cast<std::uint32_t>(block[i * 4]) << 24) | (static_cast<std::uint32_t>(block[i * 4 + 1]) << 16) |
+               (static_cast<std::uint32_t>(block[i * 4 + 2]) << 8) | static_cast<std::uint32_t>(block[i * 4 + 3]);
+    }
+
+    for (std::size_t i = 16; i < 64; ++i)
+    {
+        const std::uint32_t s0 = rotateRight(w[i - 15], 7) ^ rotateRight(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const std::uint32_t s1 = rotateRight(w[i - 2], 17) ^ rotateRight(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    std::uint32_t a = m_state[0];
+    std::uint32_t b = m_state[1];
+    std::uint32_t c = m_state[2];
+    std::uint32_t d = m_state[3];
+    std::uint32_t e = m_state[4];
+    std::uint32_t f = m_state[5];
+    std::uint32_t g = m_state[6];
+    std::uint32_t h = m_state[7];
+
+    for (std::size_t i = 0; i < 64; ++i)
+    {
+        const std::uint32_t s1 = rotateRight(e, 6) ^ rotateRight(e, 11) ^ rotateRight(e, 25);
+        const std::uint32_t choice = (e & f) ^ (~e & g);
+        const std::uint32_t temp1 = h + s1 + choice + ROUND_CONSTANTS[i] + w[i];
+        const std::uint32_t s0 = rotateRight(a, 2) ^ rotateRight(a, 13) ^ rotateRight(a, 22);
+        const std::uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        const std::uint32_t temp2 = s0 + majority;
+
+        h = g;
+        g = f;
+        f = e;
+        e = d + temp1;
+        d = c;
+        c = b;
+        b = a;
+        a = temp1 + temp2;
+    }
+
+    m_state[0] += a;
+    m_state[1] += b;
+    m_state[2] += c;
+    m_state[3] += d;
+    m_state[4] += e;
+    m_state[5] += f;
+    m_state[6] += g;
+    m_state[7] += h;
+}
+}    // namespace wolkabout
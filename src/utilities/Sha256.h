@@ -0,0 +1,53 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SHA256_H
+#define SHA256_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace wolkabout
+{
+/**
+ * @brief Computes SHA-256 digest of data supplied in one or more parts
+ */
+class Sha256
+{
+public:
+    Sha256();
+
+    void update(const std::uint8_t* data, std::size_t size);
+
+    /**
+     * @brief Completes digest, object must not be updated afterwards
+     * @return Digest as lowercase hex string
+     */
+    std::string finish();
+
+private:
+    void processBlock(const std::uint8_t* block);
+
+    std::array<std::uint32_t, 8> m_state;
+    std::array<std::uint8_t, 64> m_buffer;
+    std::size_t m_bufferSize;
+    std::uint64_t m_totalSize;
+};
+}    // namespace wolkabout
+
+#endif    // SHA256_H
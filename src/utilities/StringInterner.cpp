@@ -0,0 +1,109 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/StringInterner.h"
+
+namespace wolkabout
+{
+StringInterner::Id StringInterner::intern(const std::string& value)
+{
+    std::lock_guard<std::mutex> lg{m_mutex};
+
+    return internUnlocked(value);
+}
+
+bool StringInterner::find(const std::string& value, Id& id) const
+{
+    std::lock_guard<std::mutex> lg{m_mutex};
+
+    const auto it = m_ids.find(value);
+    if (it == m_ids.end())
+    {
+        return false;
+    }
+
+    id = it->second;
+    return true;
+}
+
+const std::string& StringInterner::resolve(Id id) const
+{
+    std::lock_guard<std::mutex> lg{m_mutex};
+
+    return m_strings.at(id).value;
+}
+
+StringInterner::Id StringInterner::retain(const std::string& value)
+{
+    std::lock_guard<std::mutex> lg{m_mutex};
+
+    const auto id = internUnlocked(value);
+    ++m_strings[id].retainCount;
+
+    return id;
+}
+
+bool StringInterner::retain(Id id)
+{
+    std::lock_guard<std::mutex> lg{m_mutex};
+
+    auto& entry = m_strings.at(id);
+    if (entry.isFreed)
+    {
+        return false;
+    }
+
+    ++entry.retainCount;
+    return true;
+}
+
+void StringInterner::release(Id id)
+{
+    std::lock_guard<std::mutex> lg{m_mutex};
+
+    auto& entry = m_strings.at(id);
+    if (entry.retainCount == 0 || --entry.retainCount != 0)
+    {
+        return;
+    }
+
+    m_ids.erase(entry.value);
+    std::string{}.swap(entry.value);
+    entry.isFreed = true;
+}
+
+std::size_t StringInterner::size() const
+{
+    std::lock_guard<std::mutex> lg{m_mutex};
+
+    return m_ids.size();
+}
+
+StringInterner::Id StringInterner::internUnlocked(const std::string& value)
+{
+    const auto it = m_ids.find(value);
+    if (it != m_ids.end())
+    {
+        return it->second;
+    }
+
+    const auto id = static_cast<Id>(m_strings.size());
+    m_strings.push_back(Entry{value, 0, false});
+    m_ids.emplace(value, id);
+
+    return id;
+}
+}    // namespace wolkabout
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace wolkabout
+{
+/**
+ * @brief Maps strings to stable integer ids, each distinct string is stored once.<br>
+ *        Retained strings are freed once released as many times as retained, freed ids are never reused
+ *        so a stale id resolves to an empty string instead of to another string. Thread safe.
+ */
+class StringInterner
+{
+public:
+    typedef std::uint32_t Id;
+
+    /**
+     * @brief Interns value, string stays interned until it is retained and released again
+     */
+    Id intern(const std::string& value);
+
+    /**
+     * @return false if value is not interned
+     */
+    bool find(const std::string& value, Id& id) const;
+
+    /**
+     * @brief Returns interned string or empty string if it was freed, reference stays valid while id is retained
+     */
+    const std::string& resolve(Id id) const;
+
+    /**
+     * @brief Interns value and keeps it until matching release
+     */
+    Id retain(const std::string& value);
+
+    /**
+     * @return false if string was already freed
+     */
+    bool retain(Id id);
+
+    void release(Id id);
+
+    std::size_t size() const;
+
+private:
+    struct Entry
+    {
+        std::string value;
+        std::uint32_t retainCount;
+        bool isFreed;
+    };
+
+    Id internUnlocked(const std::string& value);
+
+    mutable std::mutex m_mutex;
+
+    std::unordered_map<std::string, Id> m_ids;
+    std::deque<Entry> m_strings;
+};
+}    // namespace wolkabout
+
+#endif    // STRINGINTERNER_H
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/TaskTimer.h"
+
+#include <utility>
+
+namespace wolkabout
+{
+TaskTimer::TaskTimer()
+: m_isRunning{false}
+, m_isExecuting{false}
+, m_isShutdown{false}
+, m_generation{0}
+, m_periodic{false}
+, m_interval{0}
+{
+}
+
+TaskTimer::~TaskTimer()
+{
+    std::thread worker;
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_isShutdown = true;
+        m_isRunning = false;
+        ++m_generation;
+
+        worker = std::move(m_worker);
+    }
+
+    m_condition.notify_all();
+
+    if (!worker.joinable())
+    {
+        return;
+    }
+
+    if (worker.get_id() == std::this_thread::get_id())
+    {
+        // destroyed from the callback itself
+        worker.detach();
+    }
+    else
+    {
+        worker.join();
+    }
+}
+
+void TaskTimer::start(std::chrono::milliseconds delay, std::function<void()> callback)
+{
+    schedule(delay, false, std::move(callback));
+}
+
+void TaskTimer::run(std::chrono::milliseconds interval, std::function<void()> callback)
+{
+    schedule(interval, true, std::move(callback));
+}
+
+void TaskTimer::stop()
+{
+    std::unique_lock<std::mutex> lock{m_lock};
+    m_isRunning = false;
+    ++m_generation;
+    m_callback = nullptr;
+
+    m_condition.notify_all();
+
+    if (m_worker.get_id() != std::this_thread::get_id())
+    {
+        m_condition.wait(lock, [&] { return !m_isExecuting; });
+    }
+}
+
+bool TaskTimer::isRunning() const
+{
+    std::lock_guard<std::mutex> lg{m_lock};
+    return m_isRunning;
+}
+
+void TaskTimer::schedule(std::chrono::milliseconds delay, bool periodic, std::function<void()> callback)
+{
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        if (m_isShutdown)
+        {
+            return;
+        }
+
+        m_isRunning = true;
+        ++m_generation;
+
+        m_periodic = periodic;
+        m_interval = delay;
+        m_deadline = std::chrono::steady_clock::now() + delay;
+        m_callback = std::move(callback);
+
+        if (!m_worker.joinable())
+        {
+            m_worker = std::thread(&TaskTimer::work, this);
+        }
+    }
+
+    m_condition.notify_all();
+}
+
+void TaskTimer::work()
+{
+    std::unique_lock<std::mutex> lock{m_lock};
+
+    while (!m_isShutdown)
+    {
+        if (!m_isRunning)
+        {
+            m_condition.wait(lock, [&] { return m_isShutdown || m_isRunning; });
+            continue;
+        }
+
+        const auto generation = m_generation;
+        if (m_condition.wait_until(lock, m_deadline, [&] { return m_isShutdown || m_generation != generation; }))
+        {
+            continue;
+        }
+
+        const auto callback = m_callback;
+        m_isExecuting = true;
+
+        lock.unlock();
+        callback();
+        lock.lock();
+
+        m_isExecuting = false;
+
+        // callback may have restarted or stopped the timer
+        if (m_generation == generation)
+        {
+            if (m_periodic)
+            {
+                m_deadline = std::chrono::steady_clock::now() + m_interval;
+            }
+            else
+            {
+                m_isRunning = false;
+            }
+        }
+
+        m_condition.notify_all();
+    }
+}
+}    // namespace wolkabout
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TASKTIMER_H
+#define TASKTIMER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace wolkabout
+{
+/**
+ * @brief Calls callback from its own thread, once after a delay or periodically.<br>
+ *        Starting the timer again cancels the previous callback if it was not called yet.<br>
+ *        Single worker thread is started on first use and kept until timer is destroyed.<br>
+ *        All state shared with the worker thread, including the worker itself, is accessed under a single lock.
+ */
+class TaskTimer
+{
+public:
+    TaskTimer();
+    ~TaskTimer();
+
+    void start(std::chrono::milliseconds delay, std::function<void()> callback);
+
+    void run(std::chrono::milliseconds interval, std::function<void()> callback);
+
+    /**
+     * @brief Cancels callback, and waits for it to return if it is being called from other thread
+     */
+    void stop();
+
+    bool isRunning() const;
+
+private:
+    void schedule(std::chrono::milliseconds delay, bool periodic, std::function<void()> callback);
+
+    void work();
+
+    mutable std::mutex m_lock;
+    std::condition_variable m_condition;
+
+    bool m_isRunning;
+    bool m_isExecuting;
+    bool m_isShutdown;
+    std::uint64_t m_generation;
+
+    bool m_periodic;
+    std::chrono::milliseconds m_interval;
+    std::chrono::steady_clock::time_point m_deadline;
+    std::function<void()> m_callback;
+
+    std::thread m_worker;
+};
+}    // namespace wolkabout
+
+#endif    // TASKTIMER_H
@@ -0,0 +1,91 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/TokenBucket.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace wolkabout
+{
+TokenBucket::TokenBucket(double rate, double capacity, TokenBucketClock clock)
+: m_rate{rate}
+, m_capacity{std::max(capacity, rate)}
+, m_tokens{m_capacity}
+, m_clock{clock ? std::move(clock) : TokenBucketClock{[] { return std::chrono::steady_clock::now(); }}}
+, m_lastRefill{m_clock()}
+{
+}
+
+bool TokenBucket::isLimited() const
+{
+    return m_rate > 0;
+}
+
+void TokenBucket::consume(double tokens)
+{
+    if (!isLimited())
+    {
+        return;
+    }
+
+    refill();
+    m_tokens -= tokens;
+}
+
+bool TokenBucket::tryConsume(double tokens)
+{
+    if (!isLimited())
+    {
+        return true;
+    }
+
+    refill();
+    if (m_tokens < tokens)
+    {
+        return false;
+    }
+
+    m_tokens -= tokens;
+    return true;
+}
+
+std::chrono::milliseconds TokenBucket::timeUntilAvailable(double tokens)
+{
+    if (!isLimited())
+    {
+        return std::chrono::milliseconds{0};
+    }
+
+    refill();
+    if (m_tokens >= tokens)
+    {
+        return std::chrono::milliseconds{0};
+    }
+
+    return std::chrono::milliseconds{static_cast<long long>(std::ceil((tokens - m_tokens) * 1000 / m_rate))};
+}
+
+void TokenBucket::refill()
+{
+    const auto now = m_clock();
+    const auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(now - m_lastRefill).count();
+    m_lastRefill = now;
+
+    m_tokens = std::min(m_capacity, m_tokens + elapsed * m_rate);
+}
+}    // namespace wolkabout
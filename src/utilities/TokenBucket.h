@@ -0,0 +1,66 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TOKENBUCKET_H
+#define TOKENBUCKET_H
+
+#include <chrono>
+#include <functional>
+
+namespace wolkabout
+{
+typedef std::function<std::chrono::steady_clock::time_point()> TokenBucketClock;
+
+/**
+ * @brief Limits rate of consumption to rate tokens per second, allowing bursts of up to capacity tokens.<br>
+ *        Rate of 0 means unlimited. Not thread safe.
+ */
+class TokenBucket
+{
+public:
+    /**
+     * @param clock Source of time used to refill tokens, steady clock if not set
+     */
+    TokenBucket(double rate = 0, double capacity = 0, TokenBucketClock clock = nullptr);
+
+    bool isLimited() const;
+
+    /**
+     * @brief Consumes tokens even if there are not enough of them, subsequent consumers wait until debt is repaid
+     */
+    void consume(double tokens);
+
+    bool tryConsume(double tokens);
+
+    /**
+     * @return Time until there are at least given number of tokens available
+     */
+    std::chrono::milliseconds timeUntilAvailable(double tokens);
+
+private:
+    void refill();
+
+    double m_rate;
+    double m_capacity;
+    double m_tokens;
+
+    TokenBucketClock m_clock;
+
+    std::chrono::steady_clock::time_point m_lastRefill;
+};
+}    // namespace wolkabout
+
+#endif    // TOKENBUCKET_H
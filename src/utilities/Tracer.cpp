@@ -0,0 +1,240 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/Tracer.h"
+
+#include <algorithm>
+#include <atomic>
+
+namespace wolkabout
+{
+namespace
+{
+struct InboundMarks
+{
+    std::chrono::steady_clock::time_point received;
+    std::chrono::steady_clock::time_point dispatched;
+    bool isReceived;
+    bool isDispatched;
+};
+
+thread_local InboundMarks inboundMarks{{}, {}, false, false};
+
+std::atomic<std::size_t> tracers{0};
+
+const char* stageName(TraceStage stage)
+{
+    switch (stage)
+    {
+    case TraceStage::INBOUND_QUEUE:
+        return "INBOUND_QUEUE";
+    case TraceStage::PARSE:
+        return "PARSE";
+    case TraceStage::COMMAND_QUEUE:
+        return "COMMAND_QUEUE";
+    case TraceStage::ACTUATION:
+        return "ACTUATION";
+    case TraceStage::STATUS:
+        return "STATUS";
+    case TraceStage::PUBLISH:
+        return "PUBLISH";
+    }
+
+    return "";
+}
+
+std::string escape(const std::string& value)
+{
+    std::string escaped;
+    for (const char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped += '\\';
+            escaped += c;
+        }
+        else if (static_cast<unsigned char>(c) < 0x20)
+        {
+            escaped += ' ';
+        }
+        else
+        {
+            escaped += c;
+        }
+    }
+
+    return escaped;
+}
+}    // namespace
+
+const std::size_t Tracer::STAGES;
+
+Tracer::Tracer(const std::string& exportPath, std::chrono::milliseconds maxAge)
+: m_maxAge{maxAge}, m_nextTrace{0}, m_expired{0}
+{
+    ++tracers;
+
+    for (auto& statistics : m_statistics)
+    {
+        statistics.count = 0;
+        statistics.totalMicroseconds = 0;
+        statistics.maxMicroseconds = 0;
+        statistics.histogram.fill(0);
+    }
+
+    if (!exportPath.empty())
+    {
+        // closing bracket is optional in Chrome trace format, so events can be appended until the end
+        m_export.open(exportPath, std::ios::out | std::ios::trunc);
+        m_export << "[\n";
+    }
+}
+
+Tracer::~Tracer()
+{
+    --tracers;
+}
+
+bool Tracer::isEnabled()
+{
+    return tracers != 0;
+}
+
+void Tracer::markReceived(std::chrono::steady_clock::time_point received)
+{
+    inboundMarks = InboundMarks{received, {}, true, false};
+}
+
+void Tracer::markDispatched()
+{
+    inboundMarks.dispatched = std::chrono::steady_clock::now();
+    inboundMarks.isDispatched = true;
+}
+
+Tracer::TraceId Tracer::begin(const std::string& deviceKey, const std::string& reference)
+{
+    const auto now = std::chrono::steady_clock::now();
+    const auto marks = inboundMarks;
+    inboundMarks.isReceived = false;
+    inboundMarks.isDispatched = false;
+
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    expire(now);
+
+    const auto trace = ++m_nextTrace;
+    const auto& context = m_traces.emplace(trace, Trace{deviceKey, reference, now, now}).first->second;
+
+    if (marks.isReceived && marks.isDispatched)
+    {
+        record(trace, context, TraceStage::INBOUND_QUEUE, marks.received, marks.dispatched);
+        record(trace, context, TraceStage::PARSE, marks.dispatched, now);
+    }
+
+    return trace;
+}
+
+void Tracer::mark(TraceId trace, TraceStage stage)
+{
+    const auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    const auto it = m_traces.find(trace);
+    if (it == m_traces.end())
+    {
+        return;
+    }
+
+    record(trace, it->second, stage, it->second.lastMark, now);
+    it->second.lastMark = now;
+}
+
+void Tracer::end(TraceId trace)
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    m_traces.erase(trace);
+
+    if (m_export.is_open())
+    {
+        m_export.flush();
+    }
+}
+
+TraceStageStatistics Tracer::getStatistics(TraceStage stage) const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    return m_statistics[static_cast<std::size_t>(stage)];
+}
+
+std::size_t Tracer::getActiveCount() const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    return m_traces.size();
+}
+
+std::uint64_t Tracer::getExpiredCount() const
+{
+    std::lock_guard<std::mutex> guard{m_lock};
+
+    return m_expired;
+}
+
+void Tracer::expire(std::chrono::steady_clock::time_point now)
+{
+    while (!m_traces.empty() && now - m_traces.begin()->second.started >= m_maxAge)
+    {
+        m_traces.erase(m_traces.begin());
+        ++m_expired;
+    }
+}
+
+void Tracer::record(TraceId trace, const Trace& context, TraceStage stage, std::chrono::steady_clock::time_point start,
+                    std::chrono::steady_clock::time_point end)
+{
+    const auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    const auto microseconds = static_cast<std::uint64_t>(std::max<std::int64_t>(duration.count(), 0));
+
+    auto& statistics = m_statistics[static_cast<std::size_t>(stage)];
+    ++statistics.count;
+    statistics.totalMicroseconds += microseconds;
+    statistics.maxMicroseconds = std::max(statistics.maxMicroseconds, microseconds);
+
+    std::size_t bucket = 0;
+    while (bucket + 1 < statistics.histogram.size() && microseconds >= (std::uint64_t{1} << bucket))
+    {
+        ++bucket;
+    }
+    ++statistics.histogram[bucket];
+
+    if (m_export.is_open())
+    {
+        exportEvent(trace, context, stage,
+                    std::chrono::duration_cast<std::chrono::microseconds>(start.time_since_epoch()), duration);
+    }
+}
+
+void Tracer::exportEvent(TraceId trace, const Trace& context, TraceStage stage, std::chrono::microseconds start,
+                         std::chrono::microseconds duration)
+{
+    m_export << "{\"name\":\"" << stageName(stage) << "\",\"cat\":\"actuation\",\"ph\":\"X\",\"ts\":" << start.count()
+             << ",\"dur\":" << duration.count() << ",\"pid\":1,\"tid\":" << trace << ",\"args\":{\"deviceKey\":\""
+             << escape(context.deviceKey) << "\",\"reference\":\"" << escape(context.reference) << "\"}},\n";
+}
+}    // namespace wolkabout
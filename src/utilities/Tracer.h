@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace wolkabout
+{
+/**
+ * @brief Stages of actuation round trip, each stage lasts from the end of the previous one
+ */
+enum class TraceStage
+{
+    INBOUND_QUEUE = 0,    // from arrival of message until it is dispatched to service
+    PARSE,                // until command is handed to Wolk
+    COMMAND_QUEUE,        // until command is executed by Wolk command buffer
+    ACTUATION,            // until actuation handler completes
+    STATUS,               // until actuator status provider completes
+    PUBLISH               // until actuator status is handed to connectivity service
+};
+
+struct TraceStageStatistics
+{
+    std::uint64_t count;
+    std::uint64_t totalMicroseconds;
+    std::uint64_t maxMicroseconds;
+
+    // bucket i counts durations below 2^i microseconds not counted in previous buckets, last bucket counts the rest
+    std::array<std::uint64_t, 24> histogram;
+};
+
+/**
+ * @brief Measures stages of actuation round trips with monotonic timestamps and keeps per stage histograms.<br>
+ *        Arrival of inbound message is marked on the thread that dispatches it and picked up by begin on the same
+ *        thread. Optionally, every stage is written to file as Chrome trace event, one row per actuation.<br>
+ *        Trace that is not ended within max age, e.g. because its handler never completed, is dropped without
+ *        recording further stages when a later trace begins.<br>
+ *        This class is thread safe.
+ */
+class Tracer
+{
+public:
+    typedef std::uint64_t TraceId;
+
+    /**
+     * @param exportPath Chrome trace file, nothing is exported if empty
+     * @param maxAge Time after which trace that has not ended is dropped
+     */
+    explicit Tracer(const std::string& exportPath = "",
+                    std::chrono::milliseconds maxAge = std::chrono::milliseconds{60000});
+
+    ~Tracer();
+
+    /**
+     * @brief Inbound messages need to be marked only while some tracer exists
+     * @return true if tracer exists
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Marks arrival and dispatch of inbound message handled by calling thread
+     */
+    static void markReceived(std::chrono::steady_clock::time_point received);
+    static void markDispatched();
+
+    /**
+     * @brief Starts trace, stages of inbound message marked on calling thread are recorded
+     * @return Id of trace, never 0
+     */
+    TraceId begin(const std::string& deviceKey, const std::string& reference);
+
+    /**
+     * @brief Records stage of trace ending now
+     */
+    void mark(TraceId trace, TraceStage stage);
+
+    void end(TraceId trace);
+
+    TraceStageStatistics getStatistics(TraceStage stage) const;
+
+    /**
+     * @return Number of traces that have begun and have neither ended nor expired
+     */
+    std::size_t getActiveCount() const;
+
+    std::uint64_t getExpiredCount() const;
+
+    static const std::size_t STAGES = 6;
+
+private:
+    struct Trace
+    {
+        std::string deviceKey;
+        std::string reference;
+        std::chrono::steady_clock::time_point started;
+        std::chrono::steady_clock::time_point lastMark;
+    };
+
+    void expire(std::chrono::steady_clock::time_point now);
+
+    void record(TraceId trace, const Trace& context, TraceStage stage, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+
+    void exportEvent(TraceId trace, const Trace& context, TraceStage stage, std::chrono::microseconds start,
+                     std::chrono::microseconds duration);
+
+    const std::chrono::milliseconds m_maxAge;
+
+    mutable std::mutex m_lock;
+
+    TraceId m_nextTrace;
+    // ordered by id, which is also order of beginning
+    std::map<TraceId, Trace> m_traces;
+    std::uint64_t m_expired;
+
+    std::array<TraceStageStatistics, STAGES> m_statistics;
+
+    std::ofstream m_export;
+};
+}    // namespace wolkabout
+
+#endif    // TRACER_H
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "ActuatorStatusProviderPerDevice.h"
+#include "AsyncActuatorStatusProviderPerDevice.h"
+
+#include <gtest/gtest.h>
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+typedef std::map<std::string, std::map<std::string, wolkabout::ActuatorStatus>> Statuses;
+
+class AsyncActuatorStatusProviderPerDevice : public wolkabout::AsyncActuatorStatusProviderPerDevice
+{
+public:
+    void getActuatorStatus(const std::string& deviceKey, const std::string& reference,
+                           std::function<void(const wolkabout::ActuatorStatus&)> onStatus) override
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_requests.emplace_back(deviceKey + ":" + reference, onStatus);
+    }
+
+    /**
+     * Completes pending requests in reverse order, with request as actuator value
+     */
+    void completeAll()
+    {
+        std::vector<std::pair<std::string, std::function<void(const wolkabout::ActuatorStatus&)>>> requests;
+        {
+            std::lock_guard<std::mutex> lg{m_lock};
+            requests.swap(m_requests);
+        }
+
+        for (auto it = requests.rbegin(); it != requests.rend(); ++it)
+        {
+            it->second(wolkabout::ActuatorStatus{it->first, wolkabout::ActuatorStatus::State::READY});
+        }
+    }
+
+    std::size_t getPendingCount()
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        return m_requests.size();
+    }
+
+private:
+    std::mutex m_lock;
+    std::vector<std::pair<std::string, std::function<void(const wolkabout::ActuatorStatus&)>>> m_requests;
+};
+
+class ActuatorStatusProviderPerDevice : public wolkabout::ActuatorStatusProviderPerDevice
+{
+public:
+    wolkabout::ActuatorStatus getActuatorStatus(const std::string& deviceKey, const std::string& reference) override
+    {
+        return wolkabout::ActuatorStatus{deviceKey + ":" + reference, wolkabout::ActuatorStatus::State::READY};
+    }
+
+    using wolkabout::ActuatorStatusProviderPerDevice::getActuatorStatus;
+};
+}    // namespace
+
+TEST(AsyncActuatorStatusProviderPerDevice, Given_LateStatuses_When_BulkIsRequested_Then_CompletesOnceAllStatusesArrive)
+{
+    // Given
+    AsyncActuatorStatusProviderPerDevice provider;
+
+    int completions = 0;
+    Statuses statuses;
+
+    // When
+    provider.getActuatorStatuses({{"DEVICE1", {"A", "B"}}, {"DEVICE2", {"C"}}}, [&](const Statuses& result) {
+        ++completions;
+        statuses = result;
+    });
+
+    // Then
+    ASSERT_EQ(provider.getPendingCount(), 3u);
+    ASSERT_EQ(completions, 0);
+
+    provider.completeAll();
+
+    ASSERT_EQ(completions, 1);
+    ASSERT_EQ(statuses.size(), 2u);
+    ASSERT_EQ(statuses["DEVICE1"].size(), 2u);
+    ASSERT_EQ(statuses["DEVICE1"]["B"].getValue(), "DEVICE1:B");
+    ASSERT_EQ(statuses["DEVICE2"]["C"].getValue(), "DEVICE2:C");
+}
+
+TEST(AsyncActuatorStatusProviderPerDevice, Given_StatusesFromWorker_When_BulkIsRequested_Then_CompletesOnWorker)
+{
+    // Given
+    AsyncActuatorStatusProviderPerDevice provider;
+
+    std::mutex lock;
+    int completions = 0;
+    std::thread::id completionThread;
+    Statuses statuses;
+
+    provider.getActuatorStatuses({{"DEVICE1", {"A", "B"}}}, [&](const Statuses& result) {
+        std::lock_guard<std::mutex> lg{lock};
+        ++completions;
+        completionThread = std::this_thread::get_id();
+        statuses = result;
+    });
+
+    // When
+    std::thread worker{[&] { provider.completeAll(); }};
+    const auto workerId = worker.get_id();
+    worker.join();
+
+    // Then
+    std::lock_guard<std::mutex> lg{lock};
+    ASSERT_EQ(completions, 1);
+    ASSERT_EQ(completionThread, workerId);
+    ASSERT_EQ(statuses["DEVICE1"]["A"].getValue(), "DEVICE1:A");
+}
+
+TEST(AsyncActuatorStatusProviderPerDevice, Given_NoReferences_When_BulkIsRequested_Then_CompletesImmediately)
+{
+    // Given
+    AsyncActuatorStatusProviderPerDevice provider;
+
+    int completions = 0;
+
+    // When
+    provider.getActuatorStatuses({}, [&](const Statuses& result) {
+        ++completions;
+        ASSERT_TRUE(result.empty());
+    });
+
+    // Then
+    ASSERT_EQ(completions, 1);
+    ASSERT_EQ(provider.getPendingCount(), 0u);
+}
+
+TEST(AsyncActuatorStatusProviderPerDevice, Given_SyncProvider_When_UsedAsAsync_Then_CompletesImmediately)
+{
+    // Given
+    const std::shared_ptr<wolkabout::AsyncActuatorStatusProviderPerDevice> provider =
+      std::make_shared<ActuatorStatusProviderPerDevice>();
+
+    Statuses statuses;
+    wolkabout::ActuatorStatus status;
+
+    // When
+    provider->getActuatorStatus("DEVICE1", "A", [&](const wolkabout::ActuatorStatus& result) { status = result; });
+    provider->getActuatorStatuses({{"DEVICE1", {"A", "B"}}}, [&](const Statuses& result) { statuses = result; });
+
+    // Then
+    ASSERT_EQ(status.getValue(), "DEVICE1:A");
+    ASSERT_EQ(statuses["DEVICE1"].size(), 2u);
+    ASSERT_EQ(statuses["DEVICE1"]["B"].getValue(), "DEVICE1:B");
+}
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/connectivity/ConnectivityService.h"
+#include "core/model/Message.h"
+#include "service/AsyncPublisher.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+class ConnectivityService : public wolkabout::ConnectivityService
+{
+public:
+    bool connect() override { return true; }
+    void disconnect() override {}
+
+    bool reconnect() override { return true; }
+
+    bool isConnected() override { return true; }
+
+    bool publish(std::shared_ptr<wolkabout::Message> message, bool persistent) override
+    {
+        std::unique_lock<std::mutex> lock{m_lock};
+        m_threads.push_back(std::this_thread::get_id());
+        m_condition.wait(lock, [&] { return !m_blocked; });
+
+        if (!m_publishSucceeds)
+        {
+            return false;
+        }
+
+        m_channels.push_back(message->getChannel());
+        return true;
+    }
+
+    void setUncontrolledDisonnectMessage(std::shared_ptr<wolkabout::Message> outboundMessage, bool persistent) override
+    {
+    }
+
+    void block()
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_blocked = true;
+    }
+
+    void unblock()
+    {
+        {
+            std::lock_guard<std::mutex> lg{m_lock};
+            m_blocked = false;
+        }
+
+        m_condition.notify_all();
+    }
+
+    bool waitForPublishCalls(std::size_t count)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            {
+                std::lock_guard<std::mutex> lg{m_lock};
+                if (m_threads.size() >= count)
+                {
+                    return true;
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        return false;
+    }
+
+    void setPublishSucceeds(bool publishSucceeds)
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_publishSucceeds = publishSucceeds;
+    }
+
+    std::vector<std::string> getChannels() const
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        return m_channels;
+    }
+
+    std::vector<std::thread::id> getThreads() const
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        return m_threads;
+    }
+
+private:
+    mutable std::mutex m_lock;
+    std::condition_variable m_condition;
+
+    bool m_blocked = false;
+    bool m_publishSucceeds = true;
+
+    std::vector<std::string> m_channels;
+    std::vector<std::thread::id> m_threads;
+};
+
+class AsyncPublisher : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        connectivityService = std::unique_ptr<ConnectivityService>(new ConnectivityService());
+        publisher = std::unique_ptr<wolkabout::AsyncPublisher>(new wolkabout::AsyncPublisher(*connectivityService, 4));
+    }
+
+    void TearDown() override
+    {
+        connectivityService->unblock();
+        publisher->stop();
+    }
+
+    std::shared_ptr<wolkabout::Message> makeMessage(const std::string& channel)
+    {
+        return std::make_shared<wolkabout::Message>("", channel);
+    }
+
+    std::unique_ptr<ConnectivityService> connectivityService;
+    std::unique_ptr<wolkabout::AsyncPublisher> publisher;
+};
+}    // namespace
+
+TEST_F(AsyncPublisher, Given_QueuedMessages_When_TheyArePublished_Then_TheyAreSentInOrderFromOneThread)
+{
+    // Given
+    std::promise<void> lastCompleted;
+
+    connectivityService->block();
+    ASSERT_TRUE(publisher->publish(makeMessage("1"), nullptr));
+    ASSERT_TRUE(connectivityService->waitForPublishCalls(1));
+
+    ASSERT_TRUE(publisher->publish(makeMessage("2"), nullptr));
+    ASSERT_TRUE(publisher->publish(makeMessage("3"), nullptr));
+    ASSERT_TRUE(publisher->publish(makeMessage("4"), [&](bool) { lastCompleted.set_value(); }));
+
+    // When
+    connectivityService->unblock();
+
+    // Then
+    ASSERT_EQ(lastCompleted.get_future().wait_for(std::chrono::seconds{1}), std::future_status::ready);
+    ASSERT_EQ(connectivityService->getChannels(), (std::vector<std::string>{"1", "2", "3", "4"}));
+
+    const auto threads = connectivityService->getThreads();
+    for (const auto& thread : threads)
+    {
+        ASSERT_EQ(thread, threads.front());
+    }
+}
+
+TEST_F(AsyncPublisher, Given_FullWindow_When_MessageIsPublished_Then_MessageIsRejected)
+{
+    // Given
+    connectivityService->block();
+    ASSERT_TRUE(publisher->publish(makeMessage("1"), nullptr));
+    ASSERT_TRUE(connectivityService->waitForPublishCalls(1));
+
+    ASSERT_TRUE(publisher->publish(makeMessage("2"), nullptr));
+    ASSERT_TRUE(publisher->publish(makeMessage("3"), nullptr));
+    ASSERT_TRUE(publisher->publish(makeMessage("4"), nullptr));
+
+    // When
+    const bool accepted = publisher->publish(makeMessage("5"), nullptr);
+
+    // Then
+    ASSERT_FALSE(accepted);
+    ASSERT_EQ(publisher->getInFlightCount(), 4u);
+}
+
+TEST_F(AsyncPublisher, Given_FailedPublish_When_MessagesAreQueued_Then_TheyAreCompletedWithoutBeingSent)
+{
+    // Given
+    std::mutex resultsLock;
+    std::vector<bool> results;
+    std::promise<void> lastCompleted;
+
+    const auto onCompleted = [&](bool published) {
+        std::lock_guard<std::mutex> lg{resultsLock};
+        results.push_back(published);
+    };
+
+    connectivityService->block();
+    connectivityService->setPublishSucceeds(false);
+    ASSERT_TRUE(publisher->publish(makeMessage("1"), onCompleted));
+    ASSERT_TRUE(connectivityService->waitForPublishCalls(1));
+
+    ASSERT_TRUE(publisher->publish(makeMessage("2"), onCompleted));
+    ASSERT_TRUE(publisher->publish(makeMessage("3"), [&](bool published) {
+        onCompleted(published);
+        lastCompleted.set_value();
+    }));
+
+    // When
+    connectivityService->unblock();
+
+    // Then
+    ASSERT_EQ(lastCompleted.get_future().wait_for(std::chrono::seconds{1}), std::future_status::ready);
+    ASSERT_EQ(connectivityService->getThreads().size(), 1u);
+
+    std::lock_guard<std::mutex> lg{resultsLock};
+    ASSERT_EQ(results, (std::vector<bool>{false, false, false}));
+}
+
+TEST_F(AsyncPublisher, Given_QueuedMessages_When_PendingAreDiscarded_Then_OnlyMessageBeingSentIsPublished)
+{
+    // Given
+    std::promise<void> firstCompleted;
+
+    connectivityService->block();
+    ASSERT_TRUE(publisher->publish(makeMessage("1"), [&](bool) { firstCompleted.set_value(); }));
+    ASSERT_TRUE(connectivityService->waitForPublishCalls(1));
+
+    ASSERT_TRUE(publisher->publish(makeMessage("2"), nullptr));
+    ASSERT_TRUE(publisher->publish(makeMessage("3"), nullptr));
+
+    // When
+    publisher->discardPending();
+    connectivityService->unblock();
+
+    // Then
+    ASSERT_EQ(firstCompleted.get_future().wait_for(std::chrono::seconds{1}), std::future_status::ready);
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ASSERT_EQ(connectivityService->getChannels(), std::vector<std::string>{"1"});
+    ASSERT_EQ(publisher->getInFlightCount(), 0u);
+}
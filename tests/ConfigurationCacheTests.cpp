@@ -0,0 +1,81 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/ConfigurationCache.h"
+
+#include <gtest/gtest.h>
+
+TEST(ConfigurationCache, Given_NoCachedConfiguration_When_Diffed_Then_AllItemsAreChanged)
+{
+    wolkabout::ConfigurationCache cache;
+
+    const std::vector<wolkabout::ConfigurationItem> configuration{{{"1"}, "A"}, {{"2"}, "B"}};
+
+    EXPECT_EQ(cache.diff("DEVICE_KEY", configuration).size(), 2u);
+
+    std::vector<wolkabout::ConfigurationItem> cached;
+    EXPECT_FALSE(cache.get("DEVICE_KEY", cached));
+}
+
+TEST(ConfigurationCache, Given_CachedConfiguration_When_Updated_Then_OnlyChangedItemsAreReturned)
+{
+    wolkabout::ConfigurationCache cache;
+    cache.update("DEVICE_KEY", {{{"1"}, "A"}, {{"2"}, "B"}});
+
+    const auto changed = cache.update("DEVICE_KEY", {{{"1"}, "A"}, {{"3"}, "B"}, {{"4", "5"}, "C"}});
+
+    ASSERT_EQ(changed.size(), 2u);
+    EXPECT_EQ(changed[0].getReference(), "B");
+    EXPECT_EQ(changed[1].getReference(), "C");
+
+    std::vector<wolkabout::ConfigurationItem> cached;
+    ASSERT_TRUE(cache.get("DEVICE_KEY", cached));
+    ASSERT_EQ(cached.size(), 3u);
+    EXPECT_EQ(cached[1].getValues(), (std::vector<std::string>{"3"}));
+
+    cache.invalidate("DEVICE_KEY");
+    EXPECT_EQ(cache.diff("DEVICE_KEY", {{{"1"}, "A"}}).size(), 1u);
+}
+
+TEST(ConfigurationCache, Given_CachedConfiguration_When_UpdatedWithReferences_Then_ReferencedItemsAreReturned)
+{
+    wolkabout::ConfigurationCache cache;
+    cache.update("DEVICE_KEY", {{{"1"}, "A"}, {{"2"}, "B"}, {{"3"}, "C"}});
+
+    const auto items = cache.update("DEVICE_KEY", {{{"1"}, "A"}, {{"2"}, "B"}, {{"4"}, "C"}}, {"A"});
+
+    ASSERT_EQ(items.size(), 2u);
+    EXPECT_EQ(items[0].getReference(), "A");
+    EXPECT_EQ(items[1].getReference(), "C");
+
+    std::vector<wolkabout::ConfigurationItem> cached;
+    ASSERT_TRUE(cache.get("DEVICE_KEY", cached));
+    EXPECT_EQ(cached[2].getValues(), (std::vector<std::string>{"4"}));
+}
+
+TEST(ConfigurationCache, Given_CachedConfigurations_When_AllAreInvalidated_Then_NoConfigurationIsCached)
+{
+    wolkabout::ConfigurationCache cache;
+    cache.update("DEVICE_KEY", {{{"1"}, "A"}});
+    cache.update("OTHER_KEY", {{{"2"}, "B"}});
+
+    cache.invalidateAll();
+
+    std::vector<wolkabout::ConfigurationItem> cached;
+    EXPECT_FALSE(cache.get("DEVICE_KEY", cached));
+    EXPECT_FALSE(cache.get("OTHER_KEY", cached));
+    EXPECT_EQ(cache.diff("DEVICE_KEY", {{{"1"}, "A"}}).size(), 1u);
+}
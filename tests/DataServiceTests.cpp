@@ -18,6 +18,7 @@
 #include "MockPersistance.h"
 #include "core/connectivity/ConnectivityService.h"
 #include "core/model/Message.h"
+#include "service/AsyncPublisher.h"
 
 #define private public
 #define protected public
@@ -27,8 +28,14 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <tuple>
 #include <vector>
 
@@ -46,6 +53,11 @@ public:
 
     bool publish(std::shared_ptr<wolkabout::Message> message, bool persistent) override
     {
+        if (!m_publishSucceeds)
+        {
+            return false;
+        }
+
         m_messages.push_back(message);
         return true;
     }
@@ -56,8 +68,11 @@ public:
 
     const std::vector<std::shared_ptr<wolkabout::Message>>& getMessages() const { return m_messages; }
 
+    void setPublishSucceeds(bool publishSucceeds) { m_publishSucceeds = publishSucceeds; }
+
 private:
     std::vector<std::shared_ptr<wolkabout::Message>> m_messages;
+    bool m_publishSucceeds = true;
 };
 
 class DataService : public ::testing::Test
@@ -380,6 +395,29 @@ TEST_F(DataService, Given_Configuration_When_AddConfigurationIsCalled_Then_Confi
     dataService->addConfiguration(key, values);
 }
 
+TEST_F(DataService, Given_PendingConfiguration_When_AddConfigurationIsCalled_Then_ItemsAreMerged)
+{
+    // Given
+    const std::string key = "DEVICE_KEY";
+    auto pending = std::make_shared<std::vector<wolkabout::ConfigurationItem>>(
+      std::initializer_list<wolkabout::ConfigurationItem>{{{"OLD_A"}, "A"}, {{"OLD_B"}, "B"}});
+
+    ON_CALL(*persistence, getConfiguration(key)).WillByDefault(testing::Return(pending));
+
+    std::shared_ptr<std::vector<wolkabout::ConfigurationItem>> stored;
+    EXPECT_CALL(*persistence, putConfiguration(key, testing::_))
+      .Times(1)
+      .WillOnce(testing::DoAll(testing::SaveArg<1>(&stored), testing::Return(true)));
+
+    // When
+    dataService->addConfiguration(key, {{{"NEW_B"}, "B"}});
+
+    // Then
+    ASSERT_EQ(stored->size(), 2u);
+    EXPECT_EQ(stored->at(0).getValues(), (std::vector<std::string>{"NEW_B"}));
+    EXPECT_EQ(stored->at(1).getValues(), (std::vector<std::string>{"OLD_A"}));
+}
+
 TEST_F(
   DataService,
   Given_PersistedSensorReadings_When_PublishSensorReadingsForAllIsCalled_Then_ReadingsArePublishedAndPersistenceIsEmptied)
@@ -939,3 +977,324 @@ TEST_F(
 
     ASSERT_EQ(connectivityService->getMessages().size(), 1);
 }
+
+TEST_F(
+  DataService,
+  Given_AddedActuatorStatuses_When_PublishPendingActuatorStatusesIsCalled_Then_ChangedKeysArePublishedInOneMessagePerDevice)
+{
+    // Given
+    const std::shared_ptr<wolkabout::ActuatorStatus> status1 =
+      std::make_shared<wolkabout::ActuatorStatus>("VAL", "REF1", wolkabout::ActuatorStatus::State::READY);
+
+    const std::shared_ptr<wolkabout::ActuatorStatus> status2 =
+      std::make_shared<wolkabout::ActuatorStatus>("VAL", "REF2", wolkabout::ActuatorStatus::State::READY);
+
+    ON_CALL(*persistence, putActuatorStatus(testing::_, testing::_)).WillByDefault(testing::Return(true));
+    EXPECT_CALL(*persistence, putActuatorStatus(testing::_, testing::_)).Times(3);
+
+    EXPECT_CALL(*persistence, getActuatorStatusesKeys()).Times(0);
+
+    EXPECT_CALL(*persistence, getActuatorStatus("KEY1+REF1")).Times(1).WillOnce(testing::Return(status1));
+    EXPECT_CALL(*persistence, getActuatorStatus("KEY1+REF2")).Times(1).WillOnce(testing::Return(status2));
+
+    EXPECT_CALL(*persistence, removeActuatorStatus("KEY1+REF1")).Times(1);
+    EXPECT_CALL(*persistence, removeActuatorStatus("KEY1+REF2")).Times(1);
+
+    EXPECT_CALL(
+      *dataProtocol,
+      makeMessageProxy(testing::_,
+                       testing::Matcher<const std::vector<std::shared_ptr<wolkabout::ActuatorStatus>>&>(testing::_)))
+      .Times(1)
+      .WillRepeatedly(testing::InvokeWithoutArgs([&] { return new wolkabout::Message("", ""); }));
+
+    dataService->addActuatorStatus("KEY1", "REF1", "VAL", wolkabout::ActuatorStatus::State::BUSY);
+    dataService->addActuatorStatus("KEY1", "REF1", "VAL", wolkabout::ActuatorStatus::State::READY);
+    dataService->addActuatorStatus("KEY1", "REF2", "VAL", wolkabout::ActuatorStatus::State::READY);
+
+    // When
+    dataService->publishPendingActuatorStatuses();
+    dataService->publishPendingActuatorStatuses();
+
+    // Then
+    ASSERT_EQ(connectivityService->getMessages().size(), 1);
+}
+
+TEST_F(DataService,
+       Given_PendingActuatorStatus_When_Published_Then_OnlySuccessfullyPublishedReferencesAreReturned)
+{
+    // Given
+    const auto status =
+      std::make_shared<wolkabout::ActuatorStatus>("VAL", "REF1", wolkabout::ActuatorStatus::State::READY);
+
+    ON_CALL(*persistence, putActuatorStatus(testing::_, testing::_)).WillByDefault(testing::Return(true));
+    ON_CALL(*persistence, getActuatorStatus("KEY1+REF1")).WillByDefault(testing::Return(status));
+
+    ON_CALL(
+      *dataProtocol,
+      makeMessageProxy(testing::_,
+                       testing::Matcher<const std::vector<std::shared_ptr<wolkabout::ActuatorStatus>>&>(testing::_)))
+      .WillByDefault(testing::InvokeWithoutArgs([&] { return new wolkabout::Message("", ""); }));
+
+    dataService->addActuatorStatus("KEY1", "REF1", "VAL", wolkabout::ActuatorStatus::State::READY);
+    connectivityService->setPublishSucceeds(false);
+
+    // When
+    const auto notPublished = dataService->publishPendingActuatorStatuses();
+
+    connectivityService->setPublishSucceeds(true);
+    dataService->addActuatorStatus("KEY1", "REF1", "VAL", wolkabout::ActuatorStatus::State::READY);
+    const auto published = dataService->publishPendingActuatorStatuses();
+
+    // Then
+    ASSERT_TRUE(notPublished.empty());
+    ASSERT_EQ(published.size(), 1u);
+    ASSERT_EQ(published.at("KEY1"), std::vector<std::string>{"REF1"});
+}
+
+TEST_F(DataService,
+       Given_AsyncPublisher_When_PublishSensorReadingsIsCalled_Then_BatchesAreRemovedFromPersistenceOnAcknowledgement)
+{
+    // Given
+    const auto key = "KEY+REF";
+
+    std::deque<std::shared_ptr<wolkabout::SensorReading>> readings;
+    for (int i = 0; i < 120; ++i)
+    {
+        readings.push_back(std::make_shared<wolkabout::SensorReading>(std::to_string(i), "REF"));
+    }
+
+    std::mutex completionsLock;
+    std::condition_variable completionAdded;
+    std::deque<std::function<void()>> completions;
+
+    auto publisher = std::make_shared<wolkabout::AsyncPublisher>(*connectivityService, 1);
+    dataService->setAsyncPublisher(publisher, [&](std::function<void()> completion) {
+        std::lock_guard<std::mutex> lg{completionsLock};
+        completions.push_back(completion);
+        completionAdded.notify_one();
+    });
+
+    EXPECT_CALL(
+      *dataProtocol,
+      makeMessageProxy(testing::_,
+                       testing::Matcher<const std::vector<std::shared_ptr<wolkabout::SensorReading>>&>(testing::_)))
+      .Times(3)
+      .WillRepeatedly(testing::InvokeWithoutArgs([&] { return new wolkabout::Message("", ""); }));
+
+    EXPECT_CALL(*persistence, getSensorReadingsKeys()).WillOnce(testing::Return(std::vector<std::string>{key}));
+
+    EXPECT_CALL(*persistence, getSensorReadings(key, testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string&, std::uint_fast64_t count) {
+          const auto end = readings.begin() + static_cast<long>(std::min<std::size_t>(count, readings.size()));
+          return std::vector<std::shared_ptr<wolkabout::SensorReading>>(readings.begin(), end);
+      }));
+
+    EXPECT_CALL(*persistence, removeSensorReadings(key, testing::_))
+      .Times(3)
+      .WillRepeatedly(testing::Invoke([&](const std::string&, std::uint_fast64_t count) {
+          readings.erase(readings.begin(), readings.begin() + static_cast<long>(count));
+      }));
+
+    // When
+    dataService->publishSensorReadings();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        std::function<void()> completion;
+        {
+            std::unique_lock<std::mutex> lock{completionsLock};
+            ASSERT_TRUE(completionAdded.wait_for(lock, std::chrono::seconds(1), [&] { return !completions.empty(); }));
+            completion = completions.front();
+            completions.pop_front();
+        }
+
+        completion();
+    }
+
+    publisher->stop();
+
+    // Then
+    ASSERT_TRUE(readings.empty());
+    ASSERT_EQ(connectivityService->getMessages().size(), 3);
+}
+
+TEST_F(DataService, Given_DrainedSensorReadings_When_NewReadingIsAdded_Then_OnlyItsKeyIsPublishedWithoutScanningKeys)
+{
+    // Given
+    std::map<std::string, std::vector<std::shared_ptr<wolkabout::SensorReading>>> readings;
+    readings["KEY+REF1"] = {std::make_shared<wolkabout::SensorReading>("VAL", "REF1")};
+    readings["KEY+REF2"] = {std::make_shared<wolkabout::SensorReading>("VAL", "REF2")};
+
+    EXPECT_CALL(*persistence, getSensorReadingsKeys())
+      .Times(1)
+      .WillOnce(testing::Return(std::vector<std::string>{"KEY+REF1", "KEY+REF2"}));
+
+    ON_CALL(*persistence, putSensorReading(testing::_, testing::_))
+      .WillByDefault(testing::Invoke([&](const std::string& key, std::shared_ptr<wolkabout::SensorReading> reading) {
+          readings[key].push_back(reading);
+          return true;
+      }));
+
+    EXPECT_CALL(*persistence, getSensorReadings(testing::_, testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t) { return readings[key]; }));
+
+    EXPECT_CALL(*persistence, removeSensorReadings(testing::_, testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t) { readings[key].clear(); }));
+
+    EXPECT_CALL(
+      *dataProtocol,
+      makeMessageProxy(testing::_,
+                       testing::Matcher<const std::vector<std::shared_ptr<wolkabout::SensorReading>>&>(testing::_)))
+      .Times(3)
+      .WillRepeatedly(testing::InvokeWithoutArgs([&] { return new wolkabout::Message("", ""); }));
+
+    dataService->publishSensorReadings();
+
+    // When
+    dataService->addSensorReading("KEY", "REF2", "VAL2", 0);
+    dataService->publishSensorReadings();
+
+    // Then
+    ASSERT_EQ(connectivityService->getMessages().size(), 3);
+    ASSERT_TRUE(dataService->getDirtyKeys(wolkabout::DataService::BatchType::SENSOR_READINGS).empty());
+}
+
+TEST_F(DataService, Given_DirtyDevice_When_PublishBatchFails_Then_DeviceStaysDirtyUntilPublished)
+{
+    // Given
+    std::map<std::string, std::vector<std::shared_ptr<wolkabout::SensorReading>>> readings;
+
+    EXPECT_CALL(*persistence, getSensorReadingsKeys()).WillRepeatedly(testing::Return(std::vector<std::string>{}));
+
+    ON_CALL(*persistence, putSensorReading(testing::_, testing::_))
+      .WillByDefault(testing::Invoke([&](const std::string& key, std::shared_ptr<wolkabout::SensorReading> reading) {
+          readings[key].push_back(reading);
+          return true;
+      }));
+
+    EXPECT_CALL(*persistence, getSensorReadings(testing::_, testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t) { return readings[key]; }));
+
+    EXPECT_CALL(*persistence, removeSensorReadings(testing::_, testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t) { readings[key].clear(); }));
+
+    EXPECT_CALL(
+      *dataProtocol,
+      makeMessageProxy(testing::_,
+                       testing::Matcher<const std::vector<std::shared_ptr<wolkabout::SensorReading>>&>(testing::_)))
+      .WillRepeatedly(testing::InvokeWithoutArgs([&] { return new wolkabout::Message("", ""); }));
+
+    dataService->addSensorReading("KEY", "REF", "VAL", 0);
+
+    // When
+    connectivityService->setPublishSucceeds(false);
+    ASSERT_EQ(dataService->publishBatch("KEY"), 0u);
+
+    // Then
+    ASSERT_EQ(dataService->getDirtyTelemetryDeviceKeys(), std::vector<std::string>{"KEY"});
+    ASSERT_TRUE(dataService->hasPendingTelemetry("KEY"));
+
+    connectivityService->setPublishSucceeds(true);
+    ASSERT_NE(dataService->publishBatch("KEY"), 0u);
+    ASSERT_EQ(dataService->publishBatch("KEY"), 0u);
+    ASSERT_TRUE(dataService->getDirtyTelemetryDeviceKeys().empty());
+    ASSERT_FALSE(dataService->hasPendingTelemetry("KEY"));
+}
+
+TEST_F(DataService, Given_PersistedDataUnderUnparsableKey_When_TelemetryDevicesAreListed_Then_DataIsDiscarded)
+{
+    // Given
+    std::map<std::string, std::vector<std::shared_ptr<wolkabout::SensorReading>>> readings;
+    for (int i = 0; i < 120; ++i)
+    {
+        readings["BROKEN_KEY"].push_back(std::make_shared<wolkabout::SensorReading>(std::to_string(i), "REF"));
+    }
+    readings["KEY+REF"].push_back(std::make_shared<wolkabout::SensorReading>("VAL", "REF"));
+
+    EXPECT_CALL(*persistence, getSensorReadingsKeys())
+      .WillOnce(testing::Return(std::vector<std::string>{"BROKEN_KEY", "KEY+REF"}));
+    EXPECT_CALL(*persistence, getAlarmsKeys()).WillOnce(testing::Return(std::vector<std::string>{}));
+
+    EXPECT_CALL(*persistence, getSensorReadings("BROKEN_KEY", testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t count) {
+          auto& keyReadings = readings[key];
+          const auto end = keyReadings.begin() + static_cast<long>(std::min<std::size_t>(count, keyReadings.size()));
+          return std::vector<std::shared_ptr<wolkabout::SensorReading>>(keyReadings.begin(), end);
+      }));
+
+    EXPECT_CALL(*persistence, removeSensorReadings("BROKEN_KEY", testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t count) {
+          readings[key].erase(readings[key].begin(), readings[key].begin() + static_cast<long>(count));
+      }));
+
+    // When
+    const auto deviceKeys = dataService->getTelemetryDeviceKeys();
+
+    // Then
+    ASSERT_EQ(deviceKeys, std::vector<std::string>{"KEY"});
+    ASSERT_TRUE(readings["BROKEN_KEY"].empty());
+    ASSERT_TRUE(dataService->hasPendingTelemetry("KEY"));
+    ASSERT_FALSE(dataService->hasPendingTelemetry("BROKEN_KEY"));
+}
+
+TEST_F(DataService, Given_RemovedDevice_When_ItsTelemetryIsPublished_Then_DeviceKeyIsReleased)
+{
+    // Given
+    std::map<std::string, std::vector<std::shared_ptr<wolkabout::SensorReading>>> readings;
+
+    EXPECT_CALL(*persistence, getSensorReadingsKeys()).WillRepeatedly(testing::Return(std::vector<std::string>{}));
+
+    ON_CALL(*persistence, putSensorReading(testing::_, testing::_))
+      .WillByDefault(testing::Invoke([&](const std::string& key, std::shared_ptr<wolkabout::SensorReading> reading) {
+          readings[key].push_back(reading);
+          return true;
+      }));
+
+    EXPECT_CALL(*persistence, getSensorReadings(testing::_, testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t) { return readings[key]; }));
+
+    EXPECT_CALL(*persistence, removeSensorReadings(testing::_, testing::_))
+      .WillRepeatedly(testing::Invoke([&](const std::string& key, std::uint_fast64_t) { readings[key].clear(); }));
+
+    EXPECT_CALL(
+      *dataProtocol,
+      makeMessageProxy(testing::_,
+                       testing::Matcher<const std::vector<std::shared_ptr<wolkabout::SensorReading>>&>(testing::_)))
+      .WillRepeatedly(testing::InvokeWithoutArgs([&] { return new wolkabout::Message("", ""); }));
+
+    dataService->addSensorReading("KEY", "REF", "VAL", 0);
+
+    // When
+    dataService->removeDevice("KEY");
+    ASSERT_EQ(dataService->getDirtyTelemetryDeviceKeys(), std::vector<std::string>{"KEY"});
+
+    ASSERT_NE(dataService->publishBatch("KEY"), 0u);
+    ASSERT_EQ(dataService->publishBatch("KEY"), 0u);
+
+    // Then
+    ASSERT_TRUE(dataService->getDirtyTelemetryDeviceKeys().empty());
+
+    dataService->addSensorReading("OTHER_KEY", "REF", "VAL", 0);
+    ASSERT_EQ(readings.count("OTHER_KEY+REF"), 1u);
+    ASSERT_EQ(dataService->getDirtyTelemetryDeviceKeys(), std::vector<std::string>{"OTHER_KEY"});
+    ASSERT_EQ(dataService->getDeviceKeyInterner()->size(), 1u);
+}
+
+TEST_F(DataService, Given_FreedDeviceKey_When_SensorReadingIsAddedById_Then_ReadingIsDropped)
+{
+    // Given
+    EXPECT_CALL(*persistence, getSensorReadingsKeys()).WillRepeatedly(testing::Return(std::vector<std::string>{}));
+
+    auto deviceKeys = dataService->getDeviceKeyInterner();
+    const wolkabout::PersistenceKey ids{deviceKeys->retain("KEY"),
+                                        dataService->getReferenceInterner()->intern("REF")};
+    deviceKeys->release(ids.deviceKey);
+
+    // Then
+    EXPECT_CALL(*persistence, putSensorReading(testing::_, testing::_)).Times(0);
+
+    // When
+    dataService->addSensorReading(ids, "VAL", 0);
+
+    ASSERT_TRUE(dataService->getDirtyTelemetryDeviceKeys().empty());
+}
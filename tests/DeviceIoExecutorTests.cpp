@@ -0,0 +1,266 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/DeviceIoExecutor.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+class DeviceIoExecutor : public ::testing::Test
+{
+public:
+    void record(const std::string& call)
+    {
+        std::lock_guard<std::mutex> lg{lock};
+        calls.push_back(call);
+        condition.notify_all();
+    }
+
+    /**
+     * Waits until given number of calls was executed, and returns calls in execution order
+     */
+    std::vector<std::string> waitForCalls(std::size_t count)
+    {
+        std::unique_lock<std::mutex> callsLock{lock};
+        condition.wait_for(callsLock, std::chrono::seconds{1}, [&] { return calls.size() >= count; });
+        return calls;
+    }
+
+    std::mutex lock;
+    std::condition_variable condition;
+    std::vector<std::string> calls;
+};
+}    // namespace
+
+TEST_F(DeviceIoExecutor, Given_CallsOfDevice_When_Executed_Then_OrderIsPreserved)
+{
+    // Given
+    wolkabout::DeviceIoExecutor executor{4, 0, std::chrono::seconds{1}};
+
+    // When
+    for (int i = 0; i < 20; ++i)
+    {
+        executor.execute("DEVICE1", [=] { record(std::to_string(i)); });
+    }
+
+    // Then
+    const auto executed = waitForCalls(20);
+    ASSERT_EQ(executed.size(), 20u);
+    for (int i = 0; i < 20; ++i)
+    {
+        ASSERT_EQ(executed[static_cast<std::size_t>(i)], std::to_string(i));
+    }
+}
+
+TEST_F(DeviceIoExecutor, Given_HangingCall_When_OtherDevicesAreCalled_Then_TheyAreExecuted)
+{
+    // Given
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    wolkabout::DeviceIoExecutor executor{2, 0, std::chrono::seconds{1}};
+    executor.execute("DEVICE1", [=] {
+        record("DEVICE1");
+        released.wait();
+    });
+    ASSERT_EQ(waitForCalls(1).size(), 1u);
+
+    // When
+    executor.execute("DEVICE1", [=] { record("DEVICE1"); });
+    executor.execute("DEVICE2", [=] { record("DEVICE2"); });
+    executor.execute("DEVICE3", [=] { record("DEVICE3"); });
+
+    // Then
+    ASSERT_EQ(waitForCalls(3), std::vector<std::string>({"DEVICE1", "DEVICE2", "DEVICE3"}));
+    ASSERT_EQ(executor.getPendingCount(), 1u);
+
+    release.set_value();
+    ASSERT_EQ(waitForCalls(4).back(), "DEVICE1");
+}
+
+TEST_F(DeviceIoExecutor, Given_PendingCalls_When_Destroyed_Then_RunningCallCompletesAndOthersAreDiscarded)
+{
+    // Given
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    std::unique_ptr<wolkabout::DeviceIoExecutor> executor{
+      new wolkabout::DeviceIoExecutor(1, 0, std::chrono::seconds{1})};
+    executor->execute("DEVICE1", [=] {
+        record("DEVICE1");
+        released.wait();
+    });
+    executor->execute("DEVICE2", [=] { record("DEVICE2"); });
+    ASSERT_EQ(waitForCalls(1).size(), 1u);
+
+    // When
+    auto destroyed = std::async(std::launch::async, [&] { executor.reset(); });
+    ASSERT_EQ(destroyed.wait_for(std::chrono::milliseconds{50}), std::future_status::timeout);
+    release.set_value();
+
+    // Then
+    ASSERT_EQ(destroyed.wait_for(std::chrono::seconds{1}), std::future_status::ready);
+    ASSERT_EQ(waitForCalls(1), std::vector<std::string>{"DEVICE1"});
+}
+
+TEST_F(DeviceIoExecutor, Given_CallSpanningDevices_When_Executed_Then_ItIsOrderedWithCallsOfEachDevice)
+{
+    // Given
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    wolkabout::DeviceIoExecutor executor{4, 0, std::chrono::seconds{1}};
+    executor.execute("DEVICE1", [=] {
+        record("DEVICE1");
+        released.wait();
+    });
+    ASSERT_EQ(waitForCalls(1).size(), 1u);
+
+    // When
+    executor.execute(std::vector<std::string>{"DEVICE1", "DEVICE2"}, [=] { record("BULK"); });
+    executor.execute("DEVICE2", [=] { record("DEVICE2"); });
+    executor.execute("DEVICE3", [=] { record("DEVICE3"); });
+
+    // Then
+    ASSERT_EQ(waitForCalls(2), std::vector<std::string>({"DEVICE1", "DEVICE3"}));
+    ASSERT_EQ(executor.getPendingCount(), 2u);
+
+    release.set_value();
+    ASSERT_EQ(waitForCalls(4), std::vector<std::string>({"DEVICE1", "DEVICE3", "BULK", "DEVICE2"}));
+}
+
+TEST_F(DeviceIoExecutor, Given_DeviceWithMaxPendingCalls_When_CallIsAdded_Then_ItIsRejected)
+{
+    // Given
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    wolkabout::DeviceIoExecutor executor{2, 2, std::chrono::seconds{1}};
+    ASSERT_TRUE(executor.execute("DEVICE1", [=] {
+        record("DEVICE1");
+        released.wait();
+    }));
+    ASSERT_EQ(waitForCalls(1).size(), 1u);
+
+    ASSERT_TRUE(executor.execute("DEVICE1", [=] { record("DEVICE1"); }));
+    ASSERT_TRUE(executor.execute("DEVICE1", [=] { record("DEVICE1"); }));
+
+    // When
+    const bool accepted = executor.execute("DEVICE1", [=] { record("DEVICE1"); });
+
+    // Then
+    ASSERT_FALSE(accepted);
+    ASSERT_TRUE(executor.execute("DEVICE2", [=] { record("DEVICE2"); }));
+
+    release.set_value();
+    ASSERT_EQ(waitForCalls(4).size(), 4u);
+}
+
+TEST_F(DeviceIoExecutor, Given_HangingCalls_When_DevicesAreQuarantined_Then_WorkersAreReplaced)
+{
+    // Given
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    wolkabout::DeviceIoExecutor executor{2, 0, std::chrono::seconds{1}};
+    for (const auto& deviceKey : {"DEVICE1", "DEVICE2"})
+    {
+        const std::string key = deviceKey;
+        executor.execute(key, [=] {
+            record(key);
+            released.wait();
+        });
+    }
+    ASSERT_EQ(waitForCalls(2).size(), 2u);
+
+    // When
+    executor.setQuarantined("DEVICE1", true);
+    executor.setQuarantined("DEVICE2", true);
+    executor.execute("DEVICE3", [=] { record("DEVICE3"); });
+
+    // Then
+    ASSERT_EQ(waitForCalls(3).back(), "DEVICE3");
+    ASSERT_EQ(executor.getWorkerCount(), 4u);
+
+    release.set_value();
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+    while (executor.getWorkerCount() != 2 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    ASSERT_EQ(executor.getWorkerCount(), 2u);
+}
+
+TEST_F(DeviceIoExecutor, Given_CallsOfQuarantinedDevices_When_Executed_Then_OnlyOneRunsAtATime)
+{
+    // Given
+    std::promise<void> release;
+    auto released = release.get_future().share();
+
+    wolkabout::DeviceIoExecutor executor{4, 0, std::chrono::seconds{1}};
+    executor.setQuarantined("DEVICE1", true);
+    executor.setQuarantined("DEVICE2", true);
+
+    executor.execute("DEVICE1", [=] {
+        record("DEVICE1");
+        released.wait();
+    });
+    ASSERT_EQ(waitForCalls(1).size(), 1u);
+
+    // When
+    executor.execute("DEVICE2", [=] { record("DEVICE2"); });
+    executor.execute("DEVICE3", [=] { record("DEVICE3"); });
+
+    // Then
+    ASSERT_EQ(waitForCalls(2), std::vector<std::string>({"DEVICE1", "DEVICE3"}));
+    ASSERT_EQ(executor.getPendingCount(), 1u);
+
+    release.set_value();
+    ASSERT_EQ(waitForCalls(3).back(), "DEVICE2");
+}
+
+TEST_F(DeviceIoExecutor, Given_CallThatDoesNotReturn_When_Destroyed_Then_DestructorReturnsAfterShutdownTimeout)
+{
+    // Given
+    auto release = std::make_shared<std::promise<void>>();
+    auto released = release->get_future().share();
+
+    std::unique_ptr<wolkabout::DeviceIoExecutor> executor{
+      new wolkabout::DeviceIoExecutor(1, 0, std::chrono::milliseconds{50})};
+    executor->execute("DEVICE1", [=] {
+        record("DEVICE1");
+        released.wait();
+    });
+    ASSERT_EQ(waitForCalls(1).size(), 1u);
+
+    // When
+    auto destroyed = std::async(std::launch::async, [&] { executor.reset(); });
+
+    // Then
+    ASSERT_EQ(destroyed.wait_for(std::chrono::seconds{1}), std::future_status::ready);
+    release->set_value();
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/model/DeviceTemplate.h"
+#include "core/model/SensorTemplate.h"
+#include "service/DeviceRegistry.h"
+
+#include <gtest/gtest.h>
+
+namespace
+{
+wolkabout::Device makeDevice(const std::string& key, const std::vector<wolkabout::SensorTemplate>& sensors)
+{
+    return wolkabout::Device{"NAME", key, wolkabout::DeviceTemplate{{}, sensors, {}, {}, "DFU"}};
+}
+
+const wolkabout::SensorTemplate temperatureSensor{"Temperature", "T", wolkabout::ReadingType::Name::TEMPERATURE,
+                                                  wolkabout::ReadingType::MeasurmentUnit::CELSIUS, ""};
+}    // namespace
+
+TEST(DeviceRegistry, Given_AddedDevice_When_SensorIsChecked_Then_OnlyDefinedSensorsAreFound)
+{
+    wolkabout::DeviceRegistry registry;
+
+    EXPECT_TRUE(registry.addDevice(makeDevice("DEVICE_KEY", {temperatureSensor})));
+    EXPECT_FALSE(registry.addDevice(makeDevice("DEVICE_KEY", {})));
+
+    EXPECT_TRUE(registry.deviceExists("DEVICE_KEY"));
+    EXPECT_TRUE(registry.sensorDefinedForDevice("DEVICE_KEY", "T"));
+    EXPECT_FALSE(registry.sensorDefinedForDevice("DEVICE_KEY", "P"));
+    EXPECT_FALSE(registry.sensorDefinedForDevice("OTHER_KEY", "T"));
+}
+
+TEST(DeviceRegistry, Given_Snapshot_When_DeviceIsRemoved_Then_SnapshotIsUnchanged)
+{
+    wolkabout::DeviceRegistry registry;
+    registry.addDevice(makeDevice("DEVICE_KEY", {temperatureSensor}));
+
+    const auto snapshot = registry.getSnapshot();
+    EXPECT_TRUE(registry.removeDevice("DEVICE_KEY"));
+
+    EXPECT_FALSE(registry.deviceExists("DEVICE_KEY"));
+    EXPECT_EQ(snapshot->size(), 1u);
+    EXPECT_EQ(snapshot->at("DEVICE_KEY").getKey(), "DEVICE_KEY");
+}
+
+TEST(DeviceRegistry, Given_AddedDevice_When_SensorReadingIsValidated_Then_InternedIdsAreReturned)
+{
+    auto deviceKeys = std::make_shared<wolkabout::StringInterner>();
+    auto references = std::make_shared<wolkabout::StringInterner>();
+    wolkabout::DeviceRegistry registry{deviceKeys, references};
+    registry.addDevice(makeDevice("DEVICE_KEY", {temperatureSensor}));
+
+    wolkabout::PersistenceKey ids{0, 0};
+    EXPECT_EQ(registry.validateSensorReading("OTHER_KEY", "T", ids), wolkabout::IngestionStatus::UNKNOWN_DEVICE);
+    EXPECT_EQ(registry.validateSensorReading("DEVICE_KEY", "P", ids), wolkabout::IngestionStatus::UNKNOWN_REFERENCE);
+    ASSERT_EQ(registry.validateSensorReading("DEVICE_KEY", "T", ids), wolkabout::IngestionStatus::ACCEPTED);
+
+    EXPECT_EQ(deviceKeys->resolve(ids.deviceKey), "DEVICE_KEY");
+    EXPECT_EQ(references->resolve(ids.reference), "T");
+}
+
+TEST(DeviceRegistry, Given_AddedDevice_When_DeviceIsRemoved_Then_DeviceKeyIsFreed)
+{
+    auto deviceKeys = std::make_shared<wolkabout::StringInterner>();
+    wolkabout::DeviceRegistry registry{deviceKeys};
+    registry.addDevice(makeDevice("DEVICE_KEY", {temperatureSensor}));
+
+    wolkabout::PersistenceKey ids{0, 0};
+    ASSERT_EQ(registry.validateSensorReading("DEVICE_KEY", "T", ids), wolkabout::IngestionStatus::ACCEPTED);
+
+    registry.removeDevice("DEVICE_KEY");
+
+    EXPECT_FALSE(deviceKeys->retain(ids.deviceKey));
+    EXPECT_EQ(deviceKeys->size(), 0u);
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/DrainScheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+class DrainScheduler : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        drainScheduler = std::unique_ptr<wolkabout::DrainScheduler>(new wolkabout::DrainScheduler(
+          [&](const std::string& deviceKey) -> wolkabout::DeviceBatchResult {
+              if (failures[deviceKey] != 0)
+              {
+                  --failures[deviceKey];
+                  return wolkabout::DeviceBatchResult{0, true};
+              }
+
+              if (batches[deviceKey] == 0)
+              {
+                  return wolkabout::DeviceBatchResult{0, false};
+              }
+
+              --batches[deviceKey];
+              published.push_back(deviceKey);
+              return wolkabout::DeviceBatchResult{100, batches[deviceKey] != 0};
+          },
+          [] { return true; },
+          [&](std::function<void()> step) {
+              std::lock_guard<std::mutex> lg{stepsLock};
+              steps.push_back(step);
+              stepAdded.notify_one();
+          }));
+    }
+
+    void TearDown() override { drainScheduler->stop(); }
+
+    /**
+     * Runs steps until scheduler stops draining, including steps delayed by the scheduler's timer
+     */
+    void runSteps()
+    {
+        while (true)
+        {
+            std::function<void()> step;
+            {
+                std::unique_lock<std::mutex> lock{stepsLock};
+                if (!stepAdded.wait_for(lock, std::chrono::seconds{2}, [&] { return !steps.empty(); }))
+                {
+                    return;
+                }
+
+                step = steps.front();
+                steps.pop_front();
+            }
+
+            step();
+
+            if (!drainScheduler->isDraining())
+            {
+                return;
+            }
+        }
+    }
+
+    std::unique_ptr<wolkabout::DrainScheduler> drainScheduler;
+
+    std::map<std::string, int> batches;
+    std::map<std::string, int> failures;
+    std::vector<std::string> published;
+
+    std::mutex stepsLock;
+    std::condition_variable stepAdded;
+    std::deque<std::function<void()>> steps;
+};
+}    // namespace
+
+TEST_F(DrainScheduler, Given_DevicesWithBacklog_When_Drained_Then_DevicesArePublishedInRotation)
+{
+    batches["CHATTY"] = 4;
+    batches["QUIET"] = 1;
+
+    drainScheduler->drain({"CHATTY", "QUIET"});
+    runSteps();
+
+    EXPECT_EQ(published, std::vector<std::string>({"CHATTY", "QUIET", "CHATTY", "CHATTY", "CHATTY"}));
+    EXPECT_FALSE(drainScheduler->isDraining());
+}
+
+TEST_F(DrainScheduler, Given_WeightedDevice_When_Drained_Then_DevicePublishesWeightBatchesPerRotation)
+{
+    batches["A"] = 3;
+    batches["B"] = 3;
+    drainScheduler->setWeight("A", 2);
+
+    drainScheduler->drain({"A", "B"});
+    runSteps();
+
+    EXPECT_EQ(published, std::vector<std::string>({"A", "A", "B", "A", "B", "B"}));
+}
+
+TEST_F(DrainScheduler, Given_FailingDevice_When_Drained_Then_DeviceStaysInRotationUntilPublished)
+{
+    batches["FAILING"] = 1;
+    batches["OTHER"] = 2;
+    failures["FAILING"] = 2;
+
+    drainScheduler->drain({"FAILING", "OTHER"});
+    runSteps();
+
+    EXPECT_EQ(published, std::vector<std::string>({"OTHER", "OTHER", "FAILING"}));
+    EXPECT_FALSE(drainScheduler->isDraining());
+}
+
+TEST_F(DrainScheduler, Given_FailingDevice_When_PublishIsRetried_Then_RetriesAreDelayedWithBackoff)
+{
+    batches["FAILING"] = 1;
+    failures["FAILING"] = 2;
+
+    const auto start = std::chrono::steady_clock::now();
+    drainScheduler->drain({"FAILING"});
+    runSteps();
+
+    // retried after 100 ms, then after 200 ms
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds{300});
+    EXPECT_EQ(published, std::vector<std::string>({"FAILING"}));
+    EXPECT_FALSE(drainScheduler->isDraining());
+}
@@ -0,0 +1,69 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/FirmwareImage.h"
+#include "utilities/FirmwareImageCache.h"
+#include "utilities/Sha256.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+TEST(Sha256, Given_KnownInput_When_DigestIsComputed_Then_DigestMatches)
+{
+    const std::string input = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    wolkabout::Sha256 whole;
+    whole.update(reinterpret_cast<const std::uint8_t*>(input.data()), input.size());
+    EXPECT_EQ(whole.finish(), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    wolkabout::Sha256 parts;
+    parts.update(reinterpret_cast<const std::uint8_t*>(input.data()), 5);
+    parts.update(reinterpret_cast<const std::uint8_t*>(input.data()) + 5, input.size() - 5);
+    EXPECT_EQ(parts.finish(), "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+
+    EXPECT_EQ(wolkabout::Sha256().finish(), "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+}
+
+TEST(FirmwareImage, Given_ImageFile_When_ReadInChunks_Then_ContentIsReturnedAndDigestIsCached)
+{
+    const std::string path = "firmware_image_test.bin";
+    {
+        std::ofstream file{path, std::ios::binary};
+        file << "abc";
+    }
+
+    wolkabout::FirmwareImageCache cache;
+    const auto image = cache.get(path);
+    ASSERT_NE(image, nullptr);
+    EXPECT_EQ(image->getSha256(), "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    EXPECT_EQ(cache.get(path), image);
+
+    wolkabout::FirmwareImage::ChunkReader reader{image, 2};
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+
+    ASSERT_TRUE(reader.next(data, size));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(data), size), "ab");
+    ASSERT_TRUE(reader.next(data, size));
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(data), size), "c");
+    EXPECT_FALSE(reader.next(data, size));
+
+    std::remove(path.c_str());
+    EXPECT_EQ(cache.get(path), nullptr);
+}
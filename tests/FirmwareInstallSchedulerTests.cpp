@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/FirmwareInstallScheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+TEST(FirmwareInstallScheduler, Given_GroupAtLimit_When_StartableAreTaken_Then_OtherGroupsAreStarted)
+{
+    wolkabout::FirmwareInstallScheduler scheduler{3, 1, [](const std::string& deviceKey) {
+                                                      return deviceKey.substr(0, 1);
+                                                  }};
+
+    for (const auto& deviceKey : {"A1", "A2", "B1", "C1", "D1"})
+    {
+        EXPECT_TRUE(scheduler.enqueue(deviceKey));
+    }
+    EXPECT_FALSE(scheduler.enqueue("A1"));
+
+    EXPECT_EQ(scheduler.takeStartable(), (std::vector<std::string>{"A1", "B1", "C1"}));
+    EXPECT_EQ(scheduler.getQueuePosition("A2"), 1u);
+    EXPECT_EQ(scheduler.getQueuePosition("D1"), 2u);
+
+    scheduler.finished("B1");
+    EXPECT_EQ(scheduler.takeStartable(), (std::vector<std::string>{"D1"}));
+
+    scheduler.finished("C1");
+    EXPECT_TRUE(scheduler.takeStartable().empty());
+
+    scheduler.finished("A1");
+    EXPECT_EQ(scheduler.takeStartable(), (std::vector<std::string>{"A2"}));
+    EXPECT_EQ(scheduler.getInstallingCount(), 2u);
+}
+
+TEST(FirmwareInstallScheduler, Given_QueuedDevice_When_Cancelled_Then_DeviceIsNotStarted)
+{
+    wolkabout::FirmwareInstallScheduler scheduler{1};
+
+    scheduler.enqueue("DEVICE_1");
+    scheduler.enqueue("DEVICE_2");
+    EXPECT_EQ(scheduler.takeStartable(), (std::vector<std::string>{"DEVICE_1"}));
+
+    EXPECT_TRUE(scheduler.cancel("DEVICE_2"));
+    EXPECT_FALSE(scheduler.cancel("DEVICE_1"));
+
+    scheduler.finished("DEVICE_1");
+    EXPECT_TRUE(scheduler.takeStartable().empty());
+}
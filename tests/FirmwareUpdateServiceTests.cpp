@@ -0,0 +1,475 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "FirmwareInstaller.h"
+#include "FirmwareVersionProvider.h"
+#include "core/connectivity/ConnectivityService.h"
+#include "core/model/FirmwareUpdateAbort.h"
+#include "core/model/FirmwareUpdateInstall.h"
+#include "core/model/Message.h"
+#include "core/protocol/json/JsonDFUProtocol.h"
+#include "service/FirmwareInstallScheduler.h"
+#include "service/FirmwareUpdateService.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+class ConnectivityService : public wolkabout::ConnectivityService
+{
+public:
+    bool connect() override { return true; }
+    void disconnect() override {}
+
+    bool reconnect() override { return true; }
+
+    bool isConnected() override { return true; }
+
+    bool publish(std::shared_ptr<wolkabout::Message> message, bool persistent) override
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_messages.push_back(message);
+        return true;
+    }
+
+    void setUncontrolledDisonnectMessage(std::shared_ptr<wolkabout::Message> outboundMessage, bool persistent) override
+    {
+    }
+
+    /**
+     * Returns published firmware update statuses of device, in publish order
+     */
+    std::vector<std::string> getStatuses(const std::string& deviceKey) const
+    {
+        static const std::string STATUS_FIELD = "\"status\":\"";
+
+        std::lock_guard<std::mutex> lg{m_lock};
+
+        std::vector<std::string> statuses;
+        for (const auto& message : m_messages)
+        {
+            const auto& channel = message->getChannel();
+            const auto& content = message->getContent();
+
+            const auto statusPos = content.find(STATUS_FIELD);
+            if (statusPos == std::string::npos || channel.size() < deviceKey.size() ||
+                channel.compare(channel.size() - deviceKey.size(), deviceKey.size(), deviceKey) != 0)
+            {
+                continue;
+            }
+
+            const auto begin = statusPos + STATUS_FIELD.size();
+            statuses.push_back(content.substr(begin, content.find('"', begin) - begin));
+        }
+
+        return statuses;
+    }
+
+    /**
+     * Returns progress published for device, in publish order
+     */
+    std::vector<unsigned int> getProgress(const std::string& deviceKey) const
+    {
+        static const std::string PROGRESS_FIELD = "\"progress\":";
+
+        std::lock_guard<std::mutex> lg{m_lock};
+
+        std::vector<unsigned int> progress;
+        for (const auto& message : m_messages)
+        {
+            const auto& content = message->getContent();
+
+            const auto progressPos = content.find(PROGRESS_FIELD);
+            if (progressPos != std::string::npos && message->getChannel().find(deviceKey) != std::string::npos)
+            {
+                progress.push_back(
+                  static_cast<unsigned int>(std::stoul(content.substr(progressPos + PROGRESS_FIELD.size()))));
+            }
+        }
+
+        return progress;
+    }
+
+    bool hasPublished(const std::string& deviceKey) const
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        return std::any_of(m_messages.begin(), m_messages.end(), [&](const std::shared_ptr<wolkabout::Message>& m) {
+            return m->getChannel().find(deviceKey) != std::string::npos;
+        });
+    }
+
+private:
+    mutable std::mutex m_lock;
+    std::vector<std::shared_ptr<wolkabout::Message>> m_messages;
+};
+
+class FirmwareInstaller : public wolkabout::FirmwareInstaller
+{
+public:
+    struct Install
+    {
+        std::shared_ptr<const wolkabout::FirmwareImage> image;
+        std::function<void(const std::string&)> onSuccess;
+        std::function<void(const std::string&)> onFail;
+        std::function<void(const std::string&, unsigned int)> onProgress;
+    };
+
+    void install(const std::string& deviceKey, const std::string& firmwareFile,
+                 std::function<void(const std::string& deviceKey)> onSuccess,
+                 std::function<void(const std::string& deviceKey)> onFail) override
+    {
+        onFail(deviceKey);
+    }
+
+    void install(const std::string& deviceKey, std::shared_ptr<const wolkabout::FirmwareImage> image,
+                 std::function<void(const std::string& deviceKey)> onSuccess,
+                 std::function<void(const std::string& deviceKey)> onFail,
+                 std::function<void(const std::string& deviceKey, unsigned int percent)> onProgress) override
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_installs[deviceKey] = Install{image, onSuccess, onFail, onProgress};
+        m_started.push_back(deviceKey);
+        m_condition.notify_all();
+    }
+
+    bool abort(const std::string& deviceKey) override
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        m_aborted.push_back(deviceKey);
+        return m_installs.erase(deviceKey) != 0;
+    }
+
+    /**
+     * Waits until given number of installs was started, and returns keys of devices in start order
+     */
+    std::vector<std::string> waitForStarted(std::size_t count)
+    {
+        std::unique_lock<std::mutex> lock{m_lock};
+        m_condition.wait_for(lock, std::chrono::seconds{1}, [&] { return m_started.size() >= count; });
+        return m_started;
+    }
+
+    Install take(const std::string& deviceKey)
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        const auto install = m_installs.at(deviceKey);
+        m_installs.erase(deviceKey);
+        return install;
+    }
+
+    Install get(const std::string& deviceKey)
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        return m_installs.at(deviceKey);
+    }
+
+    std::vector<std::string> getAborted()
+    {
+        std::lock_guard<std::mutex> lg{m_lock};
+        return m_aborted;
+    }
+
+private:
+    std::mutex m_lock;
+    std::condition_variable m_condition;
+
+    std::map<std::string, Install> m_installs;
+    std::vector<std::string> m_started;
+    std::vector<std::string> m_aborted;
+};
+
+class FirmwareVersionProvider : public wolkabout::FirmwareVersionProvider
+{
+public:
+    std::string getFirmwareVersion(const std::string& deviceKey) override { return "2.0.0"; }
+};
+
+class FirmwareUpdateService : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        std::ofstream file{FIRMWARE_FILE, std::ios::binary};
+        file << "firmware";
+
+        installer = std::make_shared<FirmwareInstaller>();
+        versionProvider = std::make_shared<FirmwareVersionProvider>();
+        connectivityService = std::unique_ptr<ConnectivityService>(new ConnectivityService());
+    }
+
+    void TearDown() override
+    {
+        service.reset();
+        std::remove(FIRMWARE_FILE.c_str());
+    }
+
+    void createService(std::size_t maxParallelInstalls,
+                       std::chrono::milliseconds progressInterval = std::chrono::milliseconds{10000})
+    {
+        service = std::unique_ptr<wolkabout::FirmwareUpdateService>(new wolkabout::FirmwareUpdateService(
+          protocol, installer, versionProvider, *connectivityService,
+          std::unique_ptr<wolkabout::FirmwareInstallScheduler>(
+            new wolkabout::FirmwareInstallScheduler(maxParallelInstalls)),
+          progressInterval));
+    }
+
+    void install(const std::vector<std::string>& deviceKeys)
+    {
+        service->handleFirmwareUpdateCommand(wolkabout::FirmwareUpdateInstall{deviceKeys, FIRMWARE_FILE});
+    }
+
+    void abort(const std::vector<std::string>& deviceKeys)
+    {
+        service->handleFirmwareUpdateCommand(wolkabout::FirmwareUpdateAbort{deviceKeys});
+    }
+
+    /**
+     * Waits until statuses of device match expected ones
+     */
+    std::vector<std::string> waitForStatuses(const std::string& deviceKey, const std::vector<std::string>& expected,
+                                             std::chrono::milliseconds timeout = std::chrono::milliseconds{1000})
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        auto statuses = connectivityService->getStatuses(deviceKey);
+        while (statuses != expected && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+            statuses = connectivityService->getStatuses(deviceKey);
+        }
+
+        return statuses;
+    }
+
+    /**
+     * Waits until previously pushed commands are executed, firmware version publish is executed after them
+     */
+    void sync()
+    {
+        service->publishFirmwareVersion(SYNC_DEVICE_KEY);
+
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{1000};
+        while (!connectivityService->hasPublished(SYNC_DEVICE_KEY) && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+    }
+
+    static const std::string FIRMWARE_FILE;
+    static const std::string SYNC_DEVICE_KEY;
+
+    wolkabout::JsonDFUProtocol protocol;
+    std::shared_ptr<FirmwareInstaller> installer;
+    std::shared_ptr<FirmwareVersionProvider> versionProvider;
+    std::unique_ptr<ConnectivityService> connectivityService;
+
+    std::unique_ptr<wolkabout::FirmwareUpdateService> service;
+};
+
+const std::string FirmwareUpdateService::FIRMWARE_FILE = "firmware_update_service_test.bin";
+const std::string FirmwareUpdateService::SYNC_DEVICE_KEY = "SYNC";
+}    // namespace
+
+TEST_F(FirmwareUpdateService, Given_MultiDeviceCommand_When_Received_Then_SameImageIsInstalledOnEveryDevice)
+{
+    // Given
+    createService(0);
+
+    // When
+    install({"DEVICE1", "DEVICE2", "DEVICE3"});
+
+    // Then
+    const auto started = installer->waitForStarted(3);
+    ASSERT_EQ(started, std::vector<std::string>({"DEVICE1", "DEVICE2", "DEVICE3"}));
+
+    const auto image = installer->get("DEVICE1").image;
+    ASSERT_NE(image, nullptr);
+    ASSERT_EQ(installer->get("DEVICE2").image, image);
+    ASSERT_EQ(installer->get("DEVICE3").image, image);
+
+    for (const auto& deviceKey : started)
+    {
+        ASSERT_EQ(waitForStatuses(deviceKey, {"INSTALLATION"}), std::vector<std::string>{"INSTALLATION"});
+    }
+}
+
+TEST_F(FirmwareUpdateService, Given_ParallelismLimit_When_CommandIsReceived_Then_RemainingDevicesAreQueued)
+{
+    // Given
+    createService(2);
+
+    // When
+    install({"DEVICE1", "DEVICE2", "DEVICE3"});
+
+    // Then
+    ASSERT_EQ(installer->waitForStarted(2).size(), 2u);
+    ASSERT_EQ(waitForStatuses("DEVICE3", {"INSTALLATION"}), std::vector<std::string>{"INSTALLATION"});
+    ASSERT_EQ(service->getInstallQueuePosition("DEVICE3"), 1u);
+    ASSERT_EQ(installer->waitForStarted(3).size(), 2u);
+
+    installer->take("DEVICE1").onSuccess("DEVICE1");
+
+    ASSERT_EQ(installer->waitForStarted(3), std::vector<std::string>({"DEVICE1", "DEVICE2", "DEVICE3"}));
+    ASSERT_EQ(service->getInstallQueuePosition("DEVICE3"), 0u);
+    ASSERT_EQ(waitForStatuses("DEVICE1", {"INSTALLATION", "COMPLETED"}),
+              std::vector<std::string>({"INSTALLATION", "COMPLETED"}));
+    ASSERT_EQ(waitForStatuses("DEVICE3", {"INSTALLATION"}), std::vector<std::string>{"INSTALLATION"});
+}
+
+TEST_F(FirmwareUpdateService, Given_QueuedDevice_When_Aborted_Then_ItIsRemovedFromQueueWithoutCallingInstaller)
+{
+    // Given
+    createService(1);
+    install({"DEVICE1", "DEVICE2"});
+    ASSERT_EQ(installer->waitForStarted(1).size(), 1u);
+
+    // When
+    abort({"DEVICE2"});
+
+    // Then
+    ASSERT_EQ(waitForStatuses("DEVICE2", {"INSTALLATION", "ABORTED"}),
+              std::vector<std::string>({"INSTALLATION", "ABORTED"}));
+    ASSERT_TRUE(installer->getAborted().empty());
+
+    installer->take("DEVICE1").onFail("DEVICE1");
+    ASSERT_EQ(waitForStatuses("DEVICE1", {"INSTALLATION", "ERROR"}),
+              std::vector<std::string>({"INSTALLATION", "ERROR"}));
+    sync();
+    ASSERT_EQ(installer->waitForStarted(2).size(), 1u);
+}
+
+TEST_F(FirmwareUpdateService, Given_InstallingDevice_When_Aborted_Then_InstallerAbortsAndNextDeviceStarts)
+{
+    // Given
+    createService(1);
+    install({"DEVICE1", "DEVICE2"});
+    ASSERT_EQ(installer->waitForStarted(1).size(), 1u);
+
+    // When
+    abort({"DEVICE1"});
+
+    // Then
+    ASSERT_EQ(waitForStatuses("DEVICE1", {"INSTALLATION", "ABORTED"}),
+              std::vector<std::string>({"INSTALLATION", "ABORTED"}));
+    ASSERT_EQ(installer->getAborted(), std::vector<std::string>{"DEVICE1"});
+    ASSERT_EQ(installer->waitForStarted(2), std::vector<std::string>({"DEVICE1", "DEVICE2"}));
+}
+
+TEST_F(FirmwareUpdateService, Given_DuplicateDevices_When_CommandsAreReceived_Then_DeviceIsInstalledOnce)
+{
+    // Given
+    createService(0);
+
+    // When
+    install({"DEVICE1", "DEVICE1", ""});
+    ASSERT_EQ(installer->waitForStarted(1).size(), 1u);
+    install({"DEVICE1"});
+
+    // Then
+    sync();
+    ASSERT_EQ(installer->waitForStarted(2).size(), 1u);
+    ASSERT_EQ(connectivityService->getStatuses("DEVICE1"), std::vector<std::string>{"INSTALLATION"});
+}
+
+TEST_F(FirmwareUpdateService, Given_Installation_When_ProgressIsReportedManyTimes_Then_LatestProgressIsPublishedOnce)
+{
+    // Given
+    createService(0, std::chrono::milliseconds{200});
+    install({"DEVICE1"});
+    ASSERT_EQ(installer->waitForStarted(1).size(), 1u);
+    const auto onProgress = installer->get("DEVICE1").onProgress;
+
+    // When
+    for (unsigned int percent = 1; percent <= 50; ++percent)
+    {
+        onProgress("DEVICE1", percent);
+    }
+
+    // Then
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds{1000};
+    while (connectivityService->getProgress("DEVICE1").empty() && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    const auto progress = connectivityService->getProgress("DEVICE1");
+    ASSERT_FALSE(progress.empty());
+    ASSERT_LE(progress.size(), 2u);
+    ASSERT_EQ(progress.back(), 50u);
+    ASSERT_EQ(connectivityService->getStatuses("DEVICE1"),
+              std::vector<std::string>(progress.size() + 1, "INSTALLATION"));
+}
+
+TEST_F(FirmwareUpdateService, Given_Installation_When_ProgressIsReportedContinuously_Then_PublishesAreThrottled)
+{
+    // Given
+    createService(0, std::chrono::milliseconds{100});
+    install({"DEVICE1"});
+    ASSERT_EQ(installer->waitForStarted(1).size(), 1u);
+    const auto onProgress = installer->get("DEVICE1").onProgress;
+
+    // When
+    for (unsigned int percent = 1; percent <= 100; ++percent)
+    {
+        onProgress("DEVICE1", percent);
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds{250});
+
+    // Then
+    const auto progress = connectivityService->getProgress("DEVICE1");
+    ASSERT_GE(progress.size(), 2u);
+    ASSERT_LE(progress.size(), 10u);
+    ASSERT_EQ(progress.back(), 100u);
+    ASSERT_TRUE(std::is_sorted(progress.begin(), progress.end()));
+}
+
+TEST_F(FirmwareUpdateService, Given_Installation_When_ProgressIsNotReported_Then_InstallationIsStalledUntilProgress)
+{
+    // Given
+    createService(0, std::chrono::milliseconds{20});
+    install({"DEVICE1"});
+    ASSERT_EQ(installer->waitForStarted(1).size(), 1u);
+    ASSERT_FALSE(service->isInstallationStalled("DEVICE1"));
+
+    // When
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+
+    // Then
+    ASSERT_TRUE(service->isInstallationStalled("DEVICE1"));
+
+    installer->get("DEVICE1").onProgress("DEVICE1", 10);
+    ASSERT_FALSE(service->isInstallationStalled("DEVICE1"));
+
+    installer->take("DEVICE1").onSuccess("DEVICE1");
+    sync();
+    ASSERT_FALSE(service->isInstallationStalled("DEVICE1"));
+    ASSERT_TRUE(connectivityService->getProgress("DEVICE1").empty() ||
+                connectivityService->getProgress("DEVICE1").back() == 10u);
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/FlushScheduler.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <functional>
+
+TEST(FlushScheduler, Given_ItemsCountLimit_When_LimitIsReached_Then_FlushIsTriggered)
+{
+    int flushes = 0;
+    wolkabout::FlushScheduler scheduler(wolkabout::FlushPolicy(std::chrono::milliseconds{0}, 3), [&] { ++flushes; },
+                                        [](std::function<void()> flush) { flush(); });
+
+    scheduler.added(10);
+    scheduler.added(10);
+    EXPECT_EQ(flushes, 0);
+
+    scheduler.added(10);
+    EXPECT_EQ(flushes, 1);
+
+    scheduler.added(10);
+    EXPECT_EQ(flushes, 1);
+}
+
+TEST(FlushScheduler, Given_BytesLimit_When_LimitIsReached_Then_FlushIsTriggered)
+{
+    int flushes = 0;
+    wolkabout::FlushScheduler scheduler(wolkabout::FlushPolicy(std::chrono::milliseconds{0}, 0, 100),
+                                        [&] { ++flushes; }, [](std::function<void()> flush) { flush(); });
+
+    scheduler.added(60);
+    EXPECT_EQ(flushes, 0);
+
+    scheduler.added(60);
+    EXPECT_EQ(flushes, 1);
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/HandlerWatchdog.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(HandlerWatchdog, Given_OperationFinishedInTime_When_Checked_Then_DeviceIsNotQuarantined)
+{
+    std::vector<std::string> timedOut;
+    wolkabout::HandlerWatchdog watchdog{std::chrono::milliseconds{200},
+                                        [&](const std::string& deviceKey, const std::string& reference) {
+                                            timedOut.push_back(deviceKey + "+" + reference);
+                                        }};
+
+    const auto operation = watchdog.start("DEVICE_KEY", "REF");
+    EXPECT_TRUE(watchdog.finish(operation));
+    EXPECT_FALSE(watchdog.finish(operation));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{300});
+
+    EXPECT_TRUE(timedOut.empty());
+    EXPECT_FALSE(watchdog.isQuarantined("DEVICE_KEY"));
+    EXPECT_EQ(watchdog.getStatistics().watched, 1u);
+}
+
+TEST(HandlerWatchdog, Given_HangingOperation_When_TimeoutPasses_Then_DeviceIsQuarantinedUntilOperationInTime)
+{
+    std::mutex lock;
+    std::vector<std::string> timedOut;
+    wolkabout::HandlerWatchdog watchdog{std::chrono::milliseconds{50},
+                                        [&](const std::string& deviceKey, const std::string& reference) {
+                                            std::lock_guard<std::mutex> guard{lock};
+                                            timedOut.push_back(deviceKey + "+" + reference);
+                                        }};
+
+    const auto hanging = watchdog.start("DEVICE_KEY", "REF");
+    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+
+    {
+        std::lock_guard<std::mutex> guard{lock};
+        EXPECT_EQ(timedOut, std::vector<std::string>{"DEVICE_KEY+REF"});
+    }
+    EXPECT_TRUE(watchdog.isQuarantined("DEVICE_KEY"));
+    EXPECT_FALSE(watchdog.finish(hanging));
+    EXPECT_TRUE(watchdog.isQuarantined("DEVICE_KEY"));
+
+    EXPECT_TRUE(watchdog.finish(watchdog.start("DEVICE_KEY", "REF")));
+    EXPECT_FALSE(watchdog.isQuarantined("DEVICE_KEY"));
+
+    const auto statistics = watchdog.getStatistics();
+    EXPECT_EQ(statistics.timedOut, 1u);
+    EXPECT_EQ(statistics.lateCompletions, 1u);
+    EXPECT_GE(statistics.maxDurationMicroseconds, 50000u);
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/LogRateLimiter.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+
+TEST(LogRateLimiter, Given_BurstExceeded_When_MessageIsPermitted_Then_SuppressedCountIsReported)
+{
+    auto now = std::chrono::steady_clock::time_point{};
+    wolkabout::LogRateLimiter limiter{2, 2, [&] { return now; }};
+
+    std::uint64_t suppressed = 0;
+    EXPECT_TRUE(limiter.tryAcquire(suppressed));
+    EXPECT_TRUE(limiter.tryAcquire(suppressed));
+    EXPECT_EQ(suppressed, 0u);
+
+    EXPECT_FALSE(limiter.tryAcquire(suppressed));
+
+    now += std::chrono::milliseconds(499);
+    EXPECT_FALSE(limiter.tryAcquire(suppressed));
+
+    now += std::chrono::milliseconds(2);
+    EXPECT_TRUE(limiter.tryAcquire(suppressed));
+    EXPECT_EQ(suppressed, 2u);
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "core/model/SensorReading.h"
+#include "utilities/MemoryPool.h"
+#include "utilities/PoolAllocator.h"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+std::size_t getResidentBytes()
+{
+    std::ifstream statm{"/proc/self/statm"};
+
+    std::size_t size = 0;
+    std::size_t resident = 0;
+    if (!(statm >> size >> resident))
+    {
+        return 0;
+    }
+
+    return resident * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+}
+}    // namespace
+
+TEST(MemoryPool, Given_FreedBlock_When_SameSizeIsAllocated_Then_BlockIsReused)
+{
+    wolkabout::MemoryPool pool{4};
+
+    void* first = pool.allocate(40);
+    pool.deallocate(first, 40);
+    void* second = pool.allocate(40);
+
+    EXPECT_EQ(first, second);
+
+    const auto statistics = pool.getStatistics();
+    EXPECT_EQ(statistics.slabs, 1u);
+    EXPECT_EQ(statistics.blocksInUse, 1u);
+    EXPECT_EQ(statistics.allocations, 2u);
+    EXPECT_EQ(statistics.reused, 1u);
+
+    pool.deallocate(second, 40);
+}
+
+TEST(MemoryPool, Given_PooledSharedObject_When_Released_Then_BlockIsReturnedToPool)
+{
+    auto pool = std::make_shared<wolkabout::MemoryPool>();
+
+    auto value = std::allocate_shared<std::string>(wolkabout::PoolAllocator<std::string>(pool), "VALUE");
+    EXPECT_EQ(*value, "VALUE");
+    EXPECT_EQ(pool->getStatistics().blocksInUse, 1u);
+
+    value.reset();
+    EXPECT_EQ(pool->getStatistics().blocksInUse, 0u);
+}
+
+TEST(MemoryPool, Given_SteadyLoad_When_SensorReadingsAreRepeatedlyAllocated_Then_PoolStopsGrowing)
+{
+    auto pool = std::make_shared<wolkabout::MemoryPool>();
+    wolkabout::MemoryPoolStatistics firstRound{0, 0, 0, 0, 0};
+    std::size_t firstRoundResidentBytes = 0;
+
+    std::vector<std::shared_ptr<wolkabout::SensorReading>> readings;
+    for (int round = 0; round < 100; ++round)
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            readings.push_back(std::allocate_shared<wolkabout::SensorReading>(
+              wolkabout::PoolAllocator<wolkabout::SensorReading>(pool), std::to_string(i), "REFERENCE", i));
+        }
+
+        readings.clear();
+
+        if (round == 0)
+        {
+            firstRound = pool->getStatistics();
+            firstRoundResidentBytes = getResidentBytes();
+        }
+    }
+
+    const auto statistics = pool->getStatistics();
+    const auto residentBytes = getResidentBytes();
+
+    RecordProperty("reservedBytes", std::to_string(statistics.reservedBytes));
+    RecordProperty("residentBytesAfterFirstRound", std::to_string(firstRoundResidentBytes));
+    RecordProperty("residentBytes", std::to_string(residentBytes));
+
+    EXPECT_EQ(statistics.slabs, firstRound.slabs);
+    EXPECT_EQ(statistics.reservedBytes, firstRound.reservedBytes);
+    EXPECT_EQ(statistics.blocksInUse, 0u);
+    EXPECT_EQ(statistics.allocations, 100000u);
+    EXPECT_EQ(statistics.reused, statistics.allocations - firstRound.allocations + firstRound.reused);
+}
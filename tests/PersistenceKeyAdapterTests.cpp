@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/PersistenceKeyAdapter.h"
+#include "utilities/StringInterner.h"
+
+#include <gtest/gtest.h>
+
+TEST(PersistenceKeyAdapter, Given_PlainKeys_When_Encoded_Then_DelimitedKeyIsReturned)
+{
+    EXPECT_EQ(wolkabout::PersistenceKeyAdapter::encode("DEVICE_KEY", "REF"), "DEVICE_KEY+REF");
+
+    std::string deviceKey;
+    std::string reference;
+    ASSERT_TRUE(wolkabout::PersistenceKeyAdapter::decode("DEVICE_KEY+REF", deviceKey, reference));
+    EXPECT_EQ(deviceKey, "DEVICE_KEY");
+    EXPECT_EQ(reference, "REF");
+
+    EXPECT_FALSE(wolkabout::PersistenceKeyAdapter::decode("DEVICE_KEY", deviceKey, reference));
+}
+
+TEST(PersistenceKeyAdapter, Given_KeysWithDelimiter_When_EncodedAndDecoded_Then_KeysAreRestored)
+{
+    wolkabout::StringInterner deviceKeys;
+    wolkabout::StringInterner references;
+    wolkabout::PersistenceKeyAdapter adapter{deviceKeys, references};
+
+    const wolkabout::PersistenceKey key{adapter.retainDevice("DEVICE+KEY\\"), references.intern("R+E+F")};
+    const auto encoded = adapter.encode(key);
+
+    wolkabout::PersistenceKey decoded{0, 0};
+    ASSERT_TRUE(adapter.decode(encoded, decoded));
+    EXPECT_EQ(decoded, key);
+    EXPECT_EQ(references.resolve(decoded.reference), "R+E+F");
+}
+
+TEST(PersistenceKeyAdapter, Given_KeyPersistedBeforeEscaping_When_Decoded_Then_KeyIsSplitOnFirstDelimiter)
+{
+    std::string deviceKey;
+    std::string reference;
+
+    ASSERT_TRUE(wolkabout::PersistenceKeyAdapter::decode("C:\\DEVICE+REF+1", deviceKey, reference));
+    EXPECT_EQ(deviceKey, "C:\\DEVICE");
+    EXPECT_EQ(reference, "REF+1");
+
+    ASSERT_TRUE(wolkabout::PersistenceKeyAdapter::decode("DEVICE+REF\\", deviceKey, reference));
+    EXPECT_EQ(deviceKey, "DEVICE");
+    EXPECT_EQ(reference, "REF\\");
+}
+
+TEST(PersistenceKeyAdapter, Given_DecodedKey_When_DeviceIsRemoved_Then_DeviceKeyIsReleased)
+{
+    wolkabout::StringInterner deviceKeys;
+    wolkabout::StringInterner references;
+    wolkabout::PersistenceKeyAdapter adapter{deviceKeys, references};
+
+    const auto id = deviceKeys.retain("DEVICE_KEY");
+
+    wolkabout::PersistenceKey decoded{0, 0};
+    ASSERT_TRUE(adapter.decode("DEVICE_KEY+REF", decoded));
+    EXPECT_EQ(decoded.deviceKey, id);
+
+    deviceKeys.release(id);
+    EXPECT_EQ(deviceKeys.resolve(id), "DEVICE_KEY");
+
+    adapter.removeDevice(id);
+    EXPECT_EQ(deviceKeys.resolve(id), "");
+    EXPECT_EQ(deviceKeys.size(), 0u);
+}
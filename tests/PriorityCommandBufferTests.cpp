@@ -0,0 +1,269 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/PriorityCommandBuffer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace
+{
+class PriorityCommandBuffer : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        commandBuffer = std::unique_ptr<wolkabout::PriorityCommandBuffer>(new wolkabout::PriorityCommandBuffer());
+    }
+
+    void TearDown() override { commandBuffer->stop(); }
+
+    std::unique_ptr<wolkabout::PriorityCommandBuffer> commandBuffer;
+};
+}    // namespace
+
+TEST_F(PriorityCommandBuffer, Given_QueuedTelemetry_When_ControlCommandIsPushed_Then_ControlCommandIsExecutedFirst)
+{
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future().share();
+
+    std::mutex lock;
+    std::vector<std::string> executed;
+
+    commandBuffer->pushCommand(
+      [&] {
+          blocked.set_value();
+          releaseFuture.wait();
+      },
+      wolkabout::CommandLane::TELEMETRY);
+    blocked.get_future().wait();
+
+    for (int i = 0; i < 3; ++i)
+    {
+        commandBuffer->pushCommand(
+          [&] {
+              std::lock_guard<std::mutex> lg{lock};
+              executed.push_back("TELEMETRY");
+          },
+          wolkabout::CommandLane::TELEMETRY);
+    }
+
+    std::promise<void> done;
+    commandBuffer->pushCommand(
+      [&] {
+          std::lock_guard<std::mutex> lg{lock};
+          executed.push_back("CONTROL");
+      },
+      wolkabout::CommandLane::CONTROL);
+    commandBuffer->pushCommand([&] { done.set_value(); }, wolkabout::CommandLane::TELEMETRY);
+
+    EXPECT_EQ(commandBuffer->getStatistics(wolkabout::CommandLane::TELEMETRY).depth, 4u);
+    EXPECT_EQ(commandBuffer->getStatistics(wolkabout::CommandLane::CONTROL).depth, 1u);
+
+    release.set_value();
+    done.get_future().wait();
+
+    std::lock_guard<std::mutex> lg{lock};
+    ASSERT_EQ(executed.size(), 4u);
+    EXPECT_EQ(executed.front(), "CONTROL");
+}
+
+TEST_F(PriorityCommandBuffer, Given_QueuedTelemetry_When_ControlCommandsKeepComing_Then_TelemetryIsNotStarved)
+{
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future().share();
+
+    std::mutex lock;
+    std::vector<std::string> executed;
+
+    commandBuffer->pushCommand(
+      [&] {
+          blocked.set_value();
+          releaseFuture.wait();
+      },
+      wolkabout::CommandLane::CONTROL);
+    blocked.get_future().wait();
+
+    commandBuffer->pushCommand(
+      [&] {
+          std::lock_guard<std::mutex> lg{lock};
+          executed.push_back("TELEMETRY");
+      },
+      wolkabout::CommandLane::TELEMETRY);
+
+    for (int i = 0; i < 40; ++i)
+    {
+        commandBuffer->pushCommand(
+          [&] {
+              std::lock_guard<std::mutex> lg{lock};
+              executed.push_back("CONTROL");
+          },
+          wolkabout::CommandLane::CONTROL);
+    }
+
+    std::promise<void> done;
+    commandBuffer->pushCommand([&] { done.set_value(); }, wolkabout::CommandLane::CONTROL);
+
+    release.set_value();
+    done.get_future().wait();
+
+    std::lock_guard<std::mutex> lg{lock};
+    ASSERT_EQ(executed.size(), 41u);
+    EXPECT_EQ(executed.at(16), "TELEMETRY");
+}
+
+TEST_F(PriorityCommandBuffer, Given_ExecutedCommands_When_StatisticsAreRequested_Then_ExecutedCountPerLaneIsReturned)
+{
+    std::promise<void> done;
+
+    commandBuffer->pushCommand([] {}, wolkabout::CommandLane::CONTROL);
+    commandBuffer->pushCommand([] {}, wolkabout::CommandLane::TELEMETRY);
+    commandBuffer->pushCommand([&] { done.set_value(); }, wolkabout::CommandLane::TELEMETRY);
+
+    done.get_future().wait();
+
+    const auto control = commandBuffer->getStatistics(wolkabout::CommandLane::CONTROL);
+    const auto telemetry = commandBuffer->getStatistics(wolkabout::CommandLane::TELEMETRY);
+
+    EXPECT_EQ(control.executed, 1u);
+    EXPECT_EQ(telemetry.executed, 2u);
+    EXPECT_EQ(telemetry.depth, 0u);
+    EXPECT_GE(telemetry.totalWaitMicroseconds, telemetry.maxWaitMicroseconds);
+}
+
+TEST_F(PriorityCommandBuffer, Given_FullLaneWithRejectPolicy_When_CommandIsPushed_Then_CommandIsRejected)
+{
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future().share();
+
+    commandBuffer->setCapacity(wolkabout::CommandLane::TELEMETRY, 1, wolkabout::AdmissionPolicy::REJECT);
+
+    bool saturated = false;
+    commandBuffer->setSaturationHandler([&](wolkabout::CommandLane, bool isSaturated) { saturated = isSaturated; });
+
+    commandBuffer->pushCommand(
+      [&] {
+          blocked.set_value();
+          releaseFuture.wait();
+      },
+      wolkabout::CommandLane::TELEMETRY);
+    blocked.get_future().wait();
+
+    EXPECT_TRUE(commandBuffer->pushCommand([] {}, wolkabout::CommandLane::TELEMETRY));
+    EXPECT_FALSE(commandBuffer->pushCommand([] {}, wolkabout::CommandLane::TELEMETRY));
+    EXPECT_TRUE(commandBuffer->pushCommand([] {}, wolkabout::CommandLane::CONTROL));
+
+    EXPECT_TRUE(saturated);
+    EXPECT_EQ(commandBuffer->getStatistics(wolkabout::CommandLane::TELEMETRY).rejected, 1u);
+
+    release.set_value();
+}
+
+TEST_F(PriorityCommandBuffer, Given_FullLaneWithDropOldestPolicy_When_CommandIsPushed_Then_OldestCommandIsDropped)
+{
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future().share();
+
+    commandBuffer->setCapacity(wolkabout::CommandLane::TELEMETRY, 2, wolkabout::AdmissionPolicy::DROP_OLDEST);
+
+    commandBuffer->pushCommand(
+      [&] {
+          blocked.set_value();
+          releaseFuture.wait();
+      },
+      wolkabout::CommandLane::TELEMETRY);
+    blocked.get_future().wait();
+
+    std::vector<int> executed;
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(commandBuffer->pushCommand([&, i] { executed.push_back(i); }, wolkabout::CommandLane::TELEMETRY));
+    }
+
+    std::promise<void> done;
+    commandBuffer->pushCommand([&] { done.set_value(); }, wolkabout::CommandLane::TELEMETRY, true);
+
+    release.set_value();
+    done.get_future().wait();
+
+    EXPECT_EQ(executed, std::vector<int>({1, 2}));
+    EXPECT_EQ(commandBuffer->getStatistics(wolkabout::CommandLane::TELEMETRY).dropped, 1u);
+}
+
+TEST_F(PriorityCommandBuffer, Given_FullLaneWithDropOldestPolicy_When_CommandIsPushed_Then_BypassCommandIsNotDropped)
+{
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future().share();
+
+    commandBuffer->setCapacity(wolkabout::CommandLane::TELEMETRY, 1, wolkabout::AdmissionPolicy::DROP_OLDEST);
+
+    commandBuffer->pushCommand(
+      [&] {
+          blocked.set_value();
+          releaseFuture.wait();
+      },
+      wolkabout::CommandLane::TELEMETRY);
+    blocked.get_future().wait();
+
+    std::vector<std::string> executed;
+    commandBuffer->pushCommand([&] { executed.push_back("drain"); }, wolkabout::CommandLane::TELEMETRY, true);
+    EXPECT_TRUE(commandBuffer->pushCommand([&] { executed.push_back("0"); }, wolkabout::CommandLane::TELEMETRY));
+    EXPECT_TRUE(commandBuffer->pushCommand([&] { executed.push_back("1"); }, wolkabout::CommandLane::TELEMETRY));
+
+    std::promise<void> done;
+    commandBuffer->pushCommand([&] { done.set_value(); }, wolkabout::CommandLane::TELEMETRY, true);
+
+    release.set_value();
+    done.get_future().wait();
+
+    EXPECT_EQ(executed, std::vector<std::string>({"drain", "1"}));
+    EXPECT_EQ(commandBuffer->getStatistics(wolkabout::CommandLane::TELEMETRY).dropped, 1u);
+}
+
+TEST_F(PriorityCommandBuffer, Given_FullLaneWithBlockPolicy_When_NoSpaceIsFreedInTime_Then_CommandIsRejected)
+{
+    std::promise<void> blocked;
+    std::promise<void> release;
+    auto releaseFuture = release.get_future().share();
+
+    commandBuffer->setCapacity(wolkabout::CommandLane::TELEMETRY, 1, wolkabout::AdmissionPolicy::BLOCK,
+                               std::chrono::milliseconds{20});
+
+    commandBuffer->pushCommand(
+      [&] {
+          blocked.set_value();
+          releaseFuture.wait();
+      },
+      wolkabout::CommandLane::TELEMETRY);
+    blocked.get_future().wait();
+
+    EXPECT_TRUE(commandBuffer->pushCommand([] {}, wolkabout::CommandLane::TELEMETRY));
+    EXPECT_FALSE(commandBuffer->pushCommand([] {}, wolkabout::CommandLane::TELEMETRY));
+
+    release.set_value();
+}
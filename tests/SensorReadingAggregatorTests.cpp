@@ -0,0 +1,221 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "service/SensorReadingAggregator.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+struct Aggregate
+{
+    std::string deviceKey;
+    std::string reference;
+    std::vector<std::string> values;
+    unsigned long long int rtc;
+};
+
+class SensorReadingAggregator : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        aggregator = std::unique_ptr<wolkabout::SensorReadingAggregator>(new wolkabout::SensorReadingAggregator(
+          [this](const std::string& deviceKey, const std::string& reference, const std::vector<std::string>& values,
+                 unsigned long long int rtc) {
+              std::lock_guard<std::mutex> lg{lock};
+              aggregates.push_back({deviceKey, reference, values, rtc});
+          }));
+    }
+
+    void TearDown() override { aggregator.reset(); }
+
+    std::vector<Aggregate> waitForAggregates(std::size_t count,
+                                             std::chrono::milliseconds timeout = std::chrono::milliseconds{1000})
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            {
+                std::lock_guard<std::mutex> lg{lock};
+                if (aggregates.size() >= count)
+                {
+                    return aggregates;
+                }
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds{5});
+        }
+
+        std::lock_guard<std::mutex> lg{lock};
+        return aggregates;
+    }
+
+    static const std::map<wolkabout::AggregationWindow::Function, std::string> ALL_OUTPUTS;
+
+    std::mutex lock;
+    std::vector<Aggregate> aggregates;
+
+    std::unique_ptr<wolkabout::SensorReadingAggregator> aggregator;
+};
+
+const std::map<wolkabout::AggregationWindow::Function, std::string> SensorReadingAggregator::ALL_OUTPUTS = {
+  {wolkabout::AggregationWindow::Function::MIN, "MIN"},
+  {wolkabout::AggregationWindow::Function::MAX, "MAX"},
+  {wolkabout::AggregationWindow::Function::MEAN, "MEAN"},
+  {wolkabout::AggregationWindow::Function::RMS, "RMS"}};
+
+const Aggregate* findOutput(const std::vector<Aggregate>& aggregates, const std::string& reference)
+{
+    for (const auto& aggregate : aggregates)
+    {
+        if (aggregate.reference == reference)
+        {
+            return &aggregate;
+        }
+    }
+
+    return nullptr;
+}
+}    // namespace
+
+TEST_F(SensorReadingAggregator, Given_Window_When_SampleCountIsReached_Then_FunctionsArePublished)
+{
+    // Given
+    aggregator->setWindow("REF", wolkabout::AggregationWindow{4, ALL_OUTPUTS});
+
+    // When
+    aggregator->addSample("KEY", "REF", {"1"}, 1000);
+    aggregator->addSample("KEY", "REF", {"-2"}, 2000);
+    aggregator->addSample("KEY", "REF", {"3"}, 3000);
+    aggregator->addSample("KEY", "REF", {"4"}, 4000);
+
+    // Then
+    const auto result = waitForAggregates(4);
+    ASSERT_EQ(result.size(), 4u);
+
+    const auto min = findOutput(result, "MIN");
+    const auto max = findOutput(result, "MAX");
+    const auto mean = findOutput(result, "MEAN");
+    const auto rms = findOutput(result, "RMS");
+    ASSERT_NE(min, nullptr);
+    ASSERT_NE(max, nullptr);
+    ASSERT_NE(mean, nullptr);
+    ASSERT_NE(rms, nullptr);
+
+    ASSERT_EQ(min->deviceKey, "KEY");
+    ASSERT_EQ(min->rtc, 4000u);
+    ASSERT_DOUBLE_EQ(std::stod(min->values.at(0)), -2);
+    ASSERT_DOUBLE_EQ(std::stod(max->values.at(0)), 4);
+    ASSERT_DOUBLE_EQ(std::stod(mean->values.at(0)), 1.5);
+    ASSERT_NEAR(std::stod(rms->values.at(0)), 2.738613, 1e-5);
+}
+
+TEST_F(SensorReadingAggregator, Given_Window_When_SampleCountIsNotReached_Then_NothingIsPublished)
+{
+    // Given
+    aggregator->setWindow("REF", wolkabout::AggregationWindow{3, ALL_OUTPUTS});
+
+    // When
+    aggregator->addSample("KEY", "REF", {"1"}, 1000);
+    aggregator->addSample("KEY", "REF", {"2"}, 2000);
+
+    // Then
+    ASSERT_TRUE(waitForAggregates(1, std::chrono::milliseconds{100}).empty());
+}
+
+TEST_F(SensorReadingAggregator, Given_WindowWithDuration_When_SamplesSpanDuration_Then_WindowIsClosed)
+{
+    // Given
+    aggregator->setWindow("REF", wolkabout::AggregationWindow{100,
+                                                              {{wolkabout::AggregationWindow::Function::MAX, "MAX"}},
+                                                              std::chrono::milliseconds{60000}});
+
+    // When
+    aggregator->addSample("KEY", "REF", {"1"}, 1000);
+    aggregator->addSample("KEY", "REF", {"5"}, 31000);
+    aggregator->addSample("KEY", "REF", {"3"}, 61000);
+
+    // Then
+    const auto result = waitForAggregates(1);
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result.at(0).reference, "MAX");
+    ASSERT_EQ(result.at(0).rtc, 61000u);
+    ASSERT_DOUBLE_EQ(std::stod(result.at(0).values.at(0)), 5);
+}
+
+TEST_F(SensorReadingAggregator, Given_WindowWithDuration_When_SamplesStop_Then_PartialWindowIsFlushedByTimer)
+{
+    // Given
+    aggregator->setWindow("REF", wolkabout::AggregationWindow{100,
+                                                              {{wolkabout::AggregationWindow::Function::MEAN, "MEAN"}},
+                                                              std::chrono::milliseconds{50}});
+
+    // When
+    aggregator->addSample("KEY", "REF", {"2"}, 1000);
+    aggregator->addSample("KEY", "REF", {"4"}, 1001);
+
+    // Then
+    const auto result = waitForAggregates(1);
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result.at(0).rtc, 1001u);
+    ASSERT_DOUBLE_EQ(std::stod(result.at(0).values.at(0)), 3);
+}
+
+TEST_F(SensorReadingAggregator, Given_MultiValueSensor_When_WindowIsClosed_Then_EachValueIsAggregatedSeparately)
+{
+    // Given
+    aggregator->setWindow("REF",
+                          wolkabout::AggregationWindow{2, {{wolkabout::AggregationWindow::Function::MIN, "MIN"}}});
+
+    // When
+    aggregator->addSample("KEY", "REF", {"1", "20"}, 1000);
+    aggregator->addSample("KEY", "REF", {"3", "10"}, 2000);
+
+    // Then
+    const auto result = waitForAggregates(1);
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result.at(0).values.size(), 2u);
+    ASSERT_DOUBLE_EQ(std::stod(result.at(0).values.at(0)), 1);
+    ASSERT_DOUBLE_EQ(std::stod(result.at(0).values.at(1)), 10);
+}
+
+TEST_F(SensorReadingAggregator, Given_OpenWindow_When_ValueCountChanges_Then_PreviousWindowIsFlushed)
+{
+    // Given
+    aggregator->setWindow("REF",
+                          wolkabout::AggregationWindow{3, {{wolkabout::AggregationWindow::Function::MAX, "MAX"}}});
+    aggregator->addSample("KEY", "REF", {"1", "2"}, 1000);
+
+    // When
+    aggregator->addSample("KEY", "REF", {"7"}, 2000);
+
+    // Then
+    const auto result = waitForAggregates(1);
+    ASSERT_EQ(result.size(), 1u);
+    ASSERT_EQ(result.at(0).rtc, 1000u);
+    ASSERT_EQ(result.at(0).values.size(), 2u);
+    ASSERT_DOUBLE_EQ(std::stod(result.at(0).values.at(1)), 2);
+}
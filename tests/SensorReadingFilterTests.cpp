@@ -0,0 +1,143 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "service/SensorReadingFilter.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+namespace
+{
+class SensorReadingFilter : public ::testing::Test
+{
+public:
+    void SetUp() override
+    {
+        filter = std::unique_ptr<wolkabout::SensorReadingFilter>(new wolkabout::SensorReadingFilter());
+    }
+
+    void TearDown() override {}
+
+    std::unique_ptr<wolkabout::SensorReadingFilter> filter;
+};
+}    // namespace
+
+TEST_F(SensorReadingFilter, Given_NoFilter_When_SameReadingIsAdded_Then_ReadingIsAccepted)
+{
+    // When
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 1000));
+
+    // Then
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 2000));
+}
+
+TEST_F(SensorReadingFilter, Given_ChangeOnlyFilter_When_SameReadingIsAdded_Then_ReadingIsSuppressed)
+{
+    // Given
+    filter->setFilter("REF", wolkabout::DeadbandFilter{});
+
+    // When
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"ON"}, 1000));
+
+    // Then
+    ASSERT_FALSE(filter->accept("KEY", "REF", {"ON"}, 2000));
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"OFF"}, 3000));
+    ASSERT_EQ(filter->getStatistics().accepted, 2u);
+    ASSERT_EQ(filter->getStatistics().suppressed, 1u);
+}
+
+TEST_F(SensorReadingFilter, Given_AbsoluteDeadband_When_ChangeIsWithinDeadband_Then_ReadingIsSuppressed)
+{
+    // Given
+    filter->setFilter("REF", wolkabout::DeadbandFilter{0.5});
+
+    // When
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"20.0"}, 1000));
+
+    // Then
+    ASSERT_FALSE(filter->accept("KEY", "REF", {"20.4"}, 2000));
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"20.6"}, 3000));
+}
+
+TEST_F(SensorReadingFilter, Given_PercentDeadband_When_ChangeIsWithinDeadband_Then_ReadingIsSuppressed)
+{
+    // Given
+    filter->setFilter("REF", wolkabout::DeadbandFilter{0, 10});
+
+    // When
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"100", "-50"}, 1000));
+
+    // Then
+    ASSERT_FALSE(filter->accept("KEY", "REF", {"109", "-54"}, 2000));
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"109", "-56"}, 3000));
+}
+
+TEST_F(SensorReadingFilter, Given_MaxSilence_When_SilenceIsExceeded_Then_UnchangedReadingIsAccepted)
+{
+    // Given
+    filter->setFilter("REF", wolkabout::DeadbandFilter{1, 0, std::chrono::milliseconds{5000}});
+
+    // When
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 1000));
+    ASSERT_FALSE(filter->accept("KEY", "REF", {"1"}, 5999));
+
+    // Then
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 6000));
+    ASSERT_FALSE(filter->accept("KEY", "REF", {"1"}, 7000));
+}
+
+TEST_F(SensorReadingFilter, Given_DeviceFilter_When_ReadingIsAdded_Then_DeviceFilterOverridesReferenceFilter)
+{
+    // Given
+    filter->setFilter("REF", wolkabout::DeadbandFilter{10});
+    filter->setFilter("KEY1", "REF", wolkabout::DeadbandFilter{1});
+
+    // When
+    ASSERT_TRUE(filter->accept("KEY1", "REF", {"0"}, 1000));
+    ASSERT_TRUE(filter->accept("KEY2", "REF", {"0"}, 1000));
+
+    // Then
+    ASSERT_TRUE(filter->accept("KEY1", "REF", {"5"}, 2000));
+    ASSERT_FALSE(filter->accept("KEY2", "REF", {"5"}, 2000));
+}
+
+TEST_F(SensorReadingFilter, Given_RemovedDevice_When_SameReadingIsAdded_Then_ReadingIsAccepted)
+{
+    // Given
+    filter->setFilter("REF", wolkabout::DeadbandFilter{});
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 1000));
+
+    // When
+    filter->removeDevice("KEY");
+
+    // Then
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 2000));
+}
+
+TEST_F(SensorReadingFilter, Given_RemovedDeviceWithDeviceFilter_When_DeviceIsAddedAgain_Then_DeviceFilterIsNotApplied)
+{
+    // Given
+    filter->setFilter("KEY", "REF", wolkabout::DeadbandFilter{});
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 1000));
+
+    // When
+    filter->removeDevice("KEY");
+
+    // Then
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 2000));
+    ASSERT_TRUE(filter->accept("KEY", "REF", {"1"}, 3000));
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/StringInterner.h"
+
+#include <gtest/gtest.h>
+
+TEST(StringInterner, Given_InternedString_When_InternedAgain_Then_SameIdIsReturned)
+{
+    wolkabout::StringInterner interner;
+
+    const auto first = interner.intern("DEVICE_KEY");
+    const auto second = interner.intern("REFERENCE");
+
+    EXPECT_NE(first, second);
+    EXPECT_EQ(interner.intern("DEVICE_KEY"), first);
+    EXPECT_EQ(interner.resolve(second), "REFERENCE");
+    EXPECT_EQ(interner.size(), 2u);
+}
+
+TEST(StringInterner, Given_StringNotInterned_When_Found_Then_FalseIsReturned)
+{
+    wolkabout::StringInterner interner;
+    interner.intern("DEVICE_KEY");
+
+    wolkabout::StringInterner::Id id;
+    EXPECT_FALSE(interner.find("OTHER", id));
+    EXPECT_TRUE(interner.find("DEVICE_KEY", id));
+    EXPECT_EQ(interner.resolve(id), "DEVICE_KEY");
+}
+
+TEST(StringInterner, Given_RetainedString_When_ReleasedAsManyTimesAsRetained_Then_StringIsFreed)
+{
+    wolkabout::StringInterner interner;
+    const auto id = interner.retain("DEVICE_KEY");
+    EXPECT_TRUE(interner.retain(id));
+
+    interner.release(id);
+    EXPECT_EQ(interner.resolve(id), "DEVICE_KEY");
+
+    interner.release(id);
+
+    wolkabout::StringInterner::Id found;
+    EXPECT_FALSE(interner.find("DEVICE_KEY", found));
+    EXPECT_EQ(interner.resolve(id), "");
+    EXPECT_FALSE(interner.retain(id));
+    EXPECT_EQ(interner.size(), 0u);
+}
+
+TEST(StringInterner, Given_FreedString_When_OtherStringIsInterned_Then_IdIsNotReused)
+{
+    wolkabout::StringInterner interner;
+    const auto freed = interner.retain("DEVICE_KEY");
+    interner.release(freed);
+
+    const auto id = interner.retain("OTHER_KEY");
+
+    EXPECT_NE(id, freed);
+    EXPECT_EQ(interner.resolve(freed), "");
+    EXPECT_FALSE(interner.retain(freed));
+}
+
+TEST(StringInterner, Given_InternedString_When_Released_Then_StringIsKept)
+{
+    wolkabout::StringInterner interner;
+    const auto id = interner.intern("REFERENCE");
+
+    interner.release(id);
+
+    EXPECT_EQ(interner.resolve(id), "REFERENCE");
+    EXPECT_EQ(interner.size(), 1u);
+}
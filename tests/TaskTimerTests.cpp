@@ -0,0 +1,172 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/TaskTimer.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace
+{
+class TaskTimer : public ::testing::Test
+{
+public:
+    void SetUp() override { timer = std::unique_ptr<wolkabout::TaskTimer>(new wolkabout::TaskTimer()); }
+
+    void TearDown() override
+    {
+        if (timer)
+        {
+            timer->stop();
+        }
+    }
+
+    std::unique_ptr<wolkabout::TaskTimer> timer;
+};
+}    // namespace
+
+TEST_F(TaskTimer, Given_Delay_When_TimerIsStarted_Then_CallbackIsCalledOnce)
+{
+    // Given
+    std::atomic<int> calls{0};
+    std::promise<std::thread::id> called;
+
+    // When
+    timer->start(std::chrono::milliseconds{10}, [&] {
+        if (++calls == 1)
+        {
+            called.set_value(std::this_thread::get_id());
+        }
+    });
+
+    // Then
+    auto future = called.get_future();
+    ASSERT_EQ(future.wait_for(std::chrono::seconds{1}), std::future_status::ready);
+    ASSERT_NE(future.get(), std::this_thread::get_id());
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    ASSERT_EQ(calls, 1);
+    ASSERT_FALSE(timer->isRunning());
+}
+
+TEST_F(TaskTimer, Given_Interval_When_TimerIsRun_Then_CallbackIsCalledRepeatedly)
+{
+    // Given
+    std::atomic<int> calls{0};
+    std::promise<void> called;
+
+    // When
+    timer->run(std::chrono::milliseconds{5}, [&] {
+        if (++calls == 3)
+        {
+            called.set_value();
+        }
+    });
+
+    // Then
+    ASSERT_EQ(called.get_future().wait_for(std::chrono::seconds{1}), std::future_status::ready);
+    ASSERT_TRUE(timer->isRunning());
+}
+
+TEST_F(TaskTimer, Given_StartedTimer_When_StartedAgain_Then_OnlyLastCallbackIsCalled)
+{
+    // Given
+    std::atomic<int> first{0};
+    std::atomic<int> second{0};
+    timer->start(std::chrono::milliseconds{20}, [&] { ++first; });
+
+    // When
+    timer->start(std::chrono::milliseconds{20}, [&] { ++second; });
+
+    // Then
+    std::this_thread::sleep_for(std::chrono::milliseconds{100});
+    ASSERT_EQ(first, 0);
+    ASSERT_EQ(second, 1);
+}
+
+TEST_F(TaskTimer, Given_StartedTimer_When_Stopped_Then_CallbackIsNotCalled)
+{
+    // Given
+    std::atomic<int> calls{0};
+    timer->start(std::chrono::milliseconds{20}, [&] { ++calls; });
+
+    // When
+    timer->stop();
+
+    // Then
+    std::this_thread::sleep_for(std::chrono::milliseconds{50});
+    ASSERT_EQ(calls, 0);
+    ASSERT_FALSE(timer->isRunning());
+}
+
+TEST_F(TaskTimer, Given_ExecutingCallback_When_Stopped_Then_StopWaitsForCallback)
+{
+    // Given
+    std::atomic<bool> finished{false};
+    std::promise<void> entered;
+    timer->start(std::chrono::milliseconds{0}, [&] {
+        entered.set_value();
+        std::this_thread::sleep_for(std::chrono::milliseconds{30});
+        finished = true;
+    });
+    entered.get_future().wait();
+
+    // When
+    timer->stop();
+
+    // Then
+    ASSERT_TRUE(finished);
+}
+
+TEST_F(TaskTimer, Given_Callback_When_ItRestartsTimer_Then_NewCallbackIsCalled)
+{
+    // Given
+    std::promise<void> restarted;
+
+    // When
+    timer->start(std::chrono::milliseconds{0},
+                 [&] { timer->start(std::chrono::milliseconds{0}, [&] { restarted.set_value(); }); });
+
+    // Then
+    ASSERT_EQ(restarted.get_future().wait_for(std::chrono::seconds{1}), std::future_status::ready);
+}
+
+TEST_F(TaskTimer, Given_ExecutingCallback_When_TimerIsDestroyed_Then_CallbackCannotRestartTimer)
+{
+    // Given
+    std::atomic<int> calls{0};
+    std::promise<void> entered;
+    auto rawTimer = timer.get();
+
+    timer->start(std::chrono::milliseconds{0}, [&, rawTimer] {
+        entered.set_value();
+        std::this_thread::sleep_for(std::chrono::milliseconds{30});
+        rawTimer->start(std::chrono::milliseconds{0}, [&] { ++calls; });
+    });
+    entered.get_future().wait();
+
+    // When
+    timer.reset();
+
+    // Then
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+    ASSERT_EQ(calls, 0);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+
+#include "utilities/TokenBucket.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+namespace
+{
+class TokenBucket : public ::testing::Test
+{
+public:
+    void SetUp() override { now = std::chrono::steady_clock::time_point{}; }
+
+    void TearDown() override {}
+
+    wolkabout::TokenBucketClock clock()
+    {
+        return [this] { return now; };
+    }
+
+    std::chrono::steady_clock::time_point now;
+};
+}    // namespace
+
+TEST_F(TokenBucket, Given_ZeroRate_When_TokensAreConsumed_Then_BucketIsUnlimited)
+{
+    // Given
+    wolkabout::TokenBucket bucket{0, 0, clock()};
+
+    // When
+    bucket.consume(1000);
+
+    // Then
+    ASSERT_FALSE(bucket.isLimited());
+    ASSERT_TRUE(bucket.tryConsume(1000));
+    ASSERT_EQ(bucket.timeUntilAvailable(1000).count(), 0);
+}
+
+TEST_F(TokenBucket, Given_FullBucket_When_CapacityIsConsumed_Then_FurtherConsumptionIsRejected)
+{
+    // Given
+    wolkabout::TokenBucket bucket{1, 3, clock()};
+
+    // When
+    ASSERT_TRUE(bucket.tryConsume(1));
+    ASSERT_TRUE(bucket.tryConsume(1));
+    ASSERT_TRUE(bucket.tryConsume(1));
+
+    // Then
+    ASSERT_FALSE(bucket.tryConsume(1));
+    ASSERT_EQ(bucket.timeUntilAvailable(1).count(), 1000);
+}
+
+TEST_F(TokenBucket, Given_EmptyBucket_When_TimePasses_Then_TokensAreRefilledUpToCapacity)
+{
+    // Given
+    wolkabout::TokenBucket bucket{10, 10, clock()};
+    ASSERT_TRUE(bucket.tryConsume(10));
+
+    // When
+    now += std::chrono::milliseconds{500};
+
+    // Then
+    ASSERT_TRUE(bucket.tryConsume(5));
+    ASSERT_FALSE(bucket.tryConsume(1));
+
+    now += std::chrono::seconds{60};
+    ASSERT_TRUE(bucket.tryConsume(10));
+    ASSERT_FALSE(bucket.tryConsume(1));
+}
+
+TEST_F(TokenBucket, Given_Debt_When_TimeUntilAvailableIsRequested_Then_DebtIsRepaidFirst)
+{
+    // Given
+    wolkabout::TokenBucket bucket{100, 100, clock()};
+
+    // When
+    bucket.consume(300);
+
+    // Then
+    ASSERT_EQ(bucket.timeUntilAvailable(0).count(), 2000);
+    ASSERT_EQ(bucket.timeUntilAvailable(100).count(), 3000);
+
+    now += std::chrono::seconds{2};
+    ASSERT_EQ(bucket.timeUntilAvailable(0).count(), 0);
+    ASSERT_FALSE(bucket.tryConsume(1));
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "utilities/Tracer.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+TEST(Tracer, Given_InboundMarks_When_TraceIsRecorded_Then_EveryStageIsCounted)
+{
+    wolkabout::Tracer tracer;
+
+    wolkabout::Tracer::markReceived(std::chrono::steady_clock::now() - std::chrono::milliseconds{5});
+    wolkabout::Tracer::markDispatched();
+
+    const auto trace = tracer.begin("DEVICE_KEY", "REF");
+    std::this_thread::sleep_for(std::chrono::milliseconds{2});
+    tracer.mark(trace, wolkabout::TraceStage::ACTUATION);
+    tracer.end(trace);
+    tracer.mark(trace, wolkabout::TraceStage::PUBLISH);
+
+    const auto inbound = tracer.getStatistics(wolkabout::TraceStage::INBOUND_QUEUE);
+    EXPECT_EQ(inbound.count, 1u);
+    EXPECT_GE(inbound.maxMicroseconds, 5000u);
+
+    const auto actuation = tracer.getStatistics(wolkabout::TraceStage::ACTUATION);
+    EXPECT_EQ(actuation.count, 1u);
+    EXPECT_GE(actuation.totalMicroseconds, 2000u);
+
+    std::uint64_t histogramCount = 0;
+    for (const auto count : actuation.histogram)
+    {
+        histogramCount += count;
+    }
+    EXPECT_EQ(histogramCount, 1u);
+
+    EXPECT_EQ(tracer.getStatistics(wolkabout::TraceStage::PUBLISH).count, 0u);
+
+    // marks are consumed by the first trace on the thread
+    tracer.end(tracer.begin("DEVICE_KEY", "REF"));
+    EXPECT_EQ(tracer.getStatistics(wolkabout::TraceStage::INBOUND_QUEUE).count, 1u);
+}
+
+TEST(Tracer, Given_ExportPath_When_StageIsRecorded_Then_ChromeTraceEventIsWritten)
+{
+    const std::string path = "tracer_test_trace.json";
+    {
+        wolkabout::Tracer tracer{path};
+
+        const auto trace = tracer.begin("DEVICE\"KEY", "REF");
+        tracer.mark(trace, wolkabout::TraceStage::COMMAND_QUEUE);
+        tracer.end(trace);
+    }
+
+    std::ifstream file{path};
+    std::stringstream content;
+    content << file.rdbuf();
+    std::remove(path.c_str());
+
+    EXPECT_EQ(content.str().find("[\n"), 0u);
+    EXPECT_NE(content.str().find("\"name\":\"COMMAND_QUEUE\""), std::string::npos);
+    EXPECT_NE(content.str().find("\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(content.str().find("\"deviceKey\":\"DEVICE\\\"KEY\""), std::string::npos);
+}
+
+TEST(Tracer, Given_TraceThatDoesNotEnd_When_MaxAgePasses_Then_TraceExpiresWithoutFurtherStages)
+{
+    wolkabout::Tracer tracer{"", std::chrono::milliseconds{20}};
+
+    const auto hanging = tracer.begin("DEVICE_KEY", "REF");
+    EXPECT_EQ(tracer.getActiveCount(), 1u);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{30});
+
+    const auto trace = tracer.begin("DEVICE_KEY", "REF");
+    EXPECT_EQ(tracer.getActiveCount(), 1u);
+    EXPECT_EQ(tracer.getExpiredCount(), 1u);
+
+    tracer.mark(hanging, wolkabout::TraceStage::ACTUATION);
+    EXPECT_EQ(tracer.getStatistics(wolkabout::TraceStage::ACTUATION).count, 0u);
+
+    tracer.mark(trace, wolkabout::TraceStage::ACTUATION);
+    tracer.end(trace);
+    EXPECT_EQ(tracer.getStatistics(wolkabout::TraceStage::ACTUATION).count, 1u);
+    EXPECT_EQ(tracer.getActiveCount(), 0u);
+    EXPECT_EQ(tracer.getExpiredCount(), 1u);
+}
+
+TEST(Tracer, Given_NoTracer_When_Checked_Then_TracingIsDisabledUntilTracerIsCreated)
+{
+    EXPECT_FALSE(wolkabout::Tracer::isEnabled());
+
+    {
+        wolkabout::Tracer tracer;
+        EXPECT_TRUE(wolkabout::Tracer::isEnabled());
+    }
+
+    EXPECT_FALSE(wolkabout::Tracer::isEnabled());
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2018 WolkAbout Technology s.r.o.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "Wolk.h"
+#include "core/model/ActuatorStatus.h"
+#include "core/model/ActuatorTemplate.h"
+#include "core/model/DeviceTemplate.h"
+#include "model/Device.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+class Wolk : public ::testing::Test
+{
+public:
+    void SetUp() override { released = release.get_future().share(); }
+
+    void TearDown() override
+    {
+        releaseHandlers();
+        wolk.reset();
+    }
+
+    void releaseHandlers()
+    {
+        if (!isReleased)
+        {
+            isReleased = true;
+            release.set_value();
+        }
+    }
+
+    /**
+     * Builds wolk whose actuator status provider does not return for given device until handlers are released
+     */
+    void buildWolk(const std::string& hangingDeviceKey)
+    {
+        wolk = wolkabout::Wolk::newBuilder()
+                 .actuationHandler([](const std::string&, const std::string&, const std::string&) {})
+                 .actuatorStatusProvider([=](const std::string& deviceKey, const std::string&) {
+                     record(deviceKey);
+                     if (deviceKey == hangingDeviceKey)
+                     {
+                         released.wait();
+                     }
+
+                     return wolkabout::ActuatorStatus{"0", wolkabout::ActuatorStatus::State::READY};
+                 })
+                 .deviceStatusProvider([](const std::string&) { return wolkabout::DeviceStatus::Status::CONNECTED; })
+                 .withActuationTimeout(std::chrono::milliseconds{50})
+                 .build();
+
+        for (const auto& deviceKey : {"DEVICE1", "DEVICE2"})
+        {
+            wolkabout::DeviceTemplate deviceTemplate{
+              {}, {}, {}, {wolkabout::ActuatorTemplate{"Switch", "SW", wolkabout::DataType::BOOLEAN, ""}}, ""};
+            wolk->addDevice(wolkabout::Device{deviceKey, deviceKey, deviceTemplate});
+        }
+    }
+
+    void record(const std::string& deviceKey)
+    {
+        std::lock_guard<std::mutex> lg{lock};
+        requestedDevices.push_back(deviceKey);
+        condition.notify_all();
+    }
+
+    /**
+     * Waits until actuator status of device was requested from provider
+     */
+    bool waitForRequest(const std::string& deviceKey)
+    {
+        std::unique_lock<std::mutex> requestsLock{lock};
+        return condition.wait_for(requestsLock, std::chrono::seconds{1}, [&] {
+            return std::find(requestedDevices.begin(), requestedDevices.end(), deviceKey) != requestedDevices.end();
+        });
+    }
+
+    std::promise<void> release;
+    std::shared_future<void> released;
+    bool isReleased = false;
+
+    std::mutex lock;
+    std::condition_variable condition;
+    std::vector<std::string> requestedDevices;
+
+    std::unique_ptr<wolkabout::Wolk> wolk;
+};
+}    // namespace
+
+TEST_F(Wolk, Given_HangingActuatorStatusProvider_When_OtherDeviceIsRequested_Then_OtherDeviceIsServed)
+{
+    // Given
+    buildWolk("DEVICE1");
+    wolk->publishActuatorStatus("DEVICE1", "SW");
+    ASSERT_TRUE(waitForRequest("DEVICE1"));
+
+    // When
+    wolk->publishActuatorStatus("DEVICE2", "SW");
+
+    // Then
+    ASSERT_TRUE(waitForRequest("DEVICE2"));
+}
+
+TEST_F(Wolk, Given_HangingActuatorStatusProvider_When_TimeoutPasses_Then_TimeoutIsHandledOnCommandThread)
+{
+    // Given
+    buildWolk("DEVICE1");
+    wolk->publishActuatorStatus("DEVICE1", "SW");
+    ASSERT_TRUE(waitForRequest("DEVICE1"));
+
+    // When
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds{1};
+    while (wolk->getHandlerWatchdogStatistics().timedOut == 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    // Then
+    ASSERT_EQ(wolk->getHandlerWatchdogStatistics().timedOut, 1u);
+
+    const auto executed = wolk->getCommandLaneStatistics(wolkabout::CommandLane::CONTROL).executed;
+    wolk->publishActuatorStatus("DEVICE2", "SW", "1");
+    while (wolk->getCommandLaneStatistics(wolkabout::CommandLane::CONTROL).executed == executed &&
+           std::chrono::steady_clock::now() < deadline + std::chrono::seconds{1})
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{5});
+    }
+
+    ASSERT_GT(wolk->getCommandLaneStatistics(wolkabout::CommandLane::CONTROL).executed, executed);
+}